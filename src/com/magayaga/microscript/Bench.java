@@ -0,0 +1,466 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * It was originally written in Java programming language.
+ */
+package com.magayaga.microscript;
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.io.PrintStream;
+import java.lang.management.ManagementFactory;
+import java.lang.management.ThreadMXBean;
+import java.net.InetSocketAddress;
+import java.net.Socket;
+import java.net.URI;
+import java.net.http.HttpClient;
+import java.net.http.HttpRequest;
+import java.net.http.HttpResponse;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.time.Duration;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.stream.Collectors;
+import java.util.stream.Stream;
+
+/**
+ * The bench command: runs the scripts of a benchmark suite (benchmarks/ by
+ * default) and prints one JSON report, so results can be compared across
+ * versions.
+ *
+ * A script benchmark operation is one full run of the preprocessed script
+ * in a fresh environment, with its console output discarded. A script that
+ * imports http is a load scenario instead: it is started on a background
+ * thread, must define the globals port and server, and each operation is
+ * one request from one of the concurrent clients.
+ *
+ * Warm-up runs the operation in short windows until two in a row agree on
+ * throughput, or the warm-up budget is spent; only the measurement that
+ * follows is reported as ops/sec, allocation rate and latency percentiles.
+ * Allocation counts each benchmark client thread, read by the thread itself
+ * just before it finishes, plus what every other thread still alive at the
+ * end allocated during the measurement (server workers, the HTTP client's
+ * own threads). Other threads that exit during the measurement are missed.
+ */
+public class Bench {
+    private static final String DEFAULT_DIRECTORY = "benchmarks";
+    private static final String WARMUP_OPTION = "--warmup=";
+    private static final String TIME_OPTION = "--time=";
+    private static final String CONCURRENCY_OPTION = "--concurrency=";
+    private static final String OUTPUT_OPTION = "--output=";
+
+    private static final long WINDOW_MILLIS = 250;
+    private static final double STABLE_TOLERANCE = 0.05;
+    private static final int MIN_OPERATIONS = 5;
+    private static final long SERVER_START_TIMEOUT_MILLIS = 10000;
+
+    private static final PrintStream DISCARD = new PrintStream(OutputStream.nullOutputStream());
+
+    private long warmupMillis = 3000;
+    private long timeMillis = 5000;
+    private int concurrency = 8;
+    private Path output;
+
+    private interface Operation {
+        void run() throws Exception;
+    }
+
+    private static final class Script {
+        final String name;
+        final Path path;
+
+        Script(String name, Path path) {
+            this.name = name;
+            this.path = path;
+        }
+    }
+
+    public static void main(String[] args) {
+        Bench bench = new Bench();
+        List<Path> roots = new ArrayList<>();
+        try {
+            for (String arg : args) {
+                if (arg.startsWith(WARMUP_OPTION)) {
+                    bench.warmupMillis = Long.parseLong(arg.substring(WARMUP_OPTION.length()));
+                } else if (arg.startsWith(TIME_OPTION)) {
+                    bench.timeMillis = Long.parseLong(arg.substring(TIME_OPTION.length()));
+                } else if (arg.startsWith(CONCURRENCY_OPTION)) {
+                    bench.concurrency = Math.max(1, Integer.parseInt(arg.substring(CONCURRENCY_OPTION.length())));
+                } else if (arg.startsWith(OUTPUT_OPTION)) {
+                    bench.output = Paths.get(arg.substring(OUTPUT_OPTION.length()));
+                } else if (arg.startsWith("--")) {
+                    System.err.println("Error: Unknown bench option '" + arg + "'");
+                    return;
+                } else {
+                    roots.add(Paths.get(arg));
+                }
+            }
+        } catch (NumberFormatException e) {
+            System.err.println("Error: Bench options take whole numbers: " + e.getMessage());
+            return;
+        }
+        if (roots.isEmpty()) {
+            roots.add(Paths.get(DEFAULT_DIRECTORY));
+        }
+
+        try {
+            List<Script> scripts = findScripts(roots);
+            if (scripts.isEmpty()) {
+                System.err.println("Error: No benchmark scripts found in " + roots);
+                return;
+            }
+
+            String report = bench.run(scripts);
+            if (bench.output != null) {
+                Files.write(bench.output, report.getBytes(StandardCharsets.UTF_8));
+                System.err.println("Benchmark report written to " + bench.output);
+            } else {
+                System.out.println(report);
+            }
+        } catch (IOException e) {
+            System.err.println("Error running benchmarks: " + e.getMessage());
+        }
+    }
+
+    // Directories are searched recursively; names are relative to the directory given
+    private static List<Script> findScripts(List<Path> roots) throws IOException {
+        List<Script> scripts = new ArrayList<>();
+        for (Path root : roots) {
+            if (!Files.isDirectory(root)) {
+                scripts.add(new Script(withoutExtension(root.getFileName().toString()), root));
+                continue;
+            }
+            try (Stream<Path> files = Files.walk(root)) {
+                List<Path> found = files
+                    .filter(Files::isRegularFile)
+                    .filter(path -> MicroScript.hasValidExtension(path.toString()))
+                    .sorted()
+                    .collect(Collectors.toList());
+                for (Path path : found) {
+                    String name = root.relativize(path).toString().replace('\\', '/');
+                    scripts.add(new Script(withoutExtension(name), path));
+                }
+            }
+        }
+        return scripts;
+    }
+
+    private static String withoutExtension(String name) {
+        int dot = name.lastIndexOf('.');
+        return dot > 0 ? name.substring(0, dot) : name;
+    }
+
+    private String run(List<Script> scripts) {
+        StringBuilder json = new StringBuilder();
+        json.append("{\n  \"version\": ").append(quote(Cli.VERSION))
+            .append(",\n  \"java\": ").append(quote(System.getProperty("java.version")))
+            .append(",\n  \"benchmarks\": [");
+
+        PrintStream stdout = System.out;
+        for (int i = 0; i < scripts.size(); i++) {
+            Script script = scripts.get(i);
+            System.err.println("Benchmarking " + script.name);
+            String result;
+            System.setOut(DISCARD);
+            try {
+                result = benchmark(script);
+            } catch (Exception e) {
+                result = "{\"name\": " + quote(script.name) + ", \"error\": " + quote(String.valueOf(e.getMessage())) + "}";
+            } finally {
+                System.setOut(stdout);
+            }
+            json.append(i == 0 ? "\n    " : ",\n    ").append(result);
+        }
+        return json.append("\n  ]\n}").toString();
+    }
+
+    private String benchmark(Script script) throws Exception {
+        List<String> lines = new Define().preprocess(new Scanner(script.path.toString()).readLines());
+        for (String line : lines) {
+            if (line.trim().startsWith("import http")) {
+                return benchmarkHttp(script, lines);
+            }
+        }
+        return measure(script.name, "script", 1, () -> new Parser(lines).parse());
+    }
+
+    private String benchmarkHttp(Script script, List<String> lines) throws Exception {
+        NativeHttp.checkLibrary();
+        Environment environment = new Environment();
+        Thread serverThread = new Thread(() -> new Parser(lines, environment).parse(), "microscript-bench-server");
+        serverThread.setDaemon(true);
+        serverThread.start();
+
+        try {
+            int port = awaitServer(environment, serverThread);
+            HttpClient client = HttpClient.newBuilder()
+                .version(HttpClient.Version.HTTP_1_1)
+                .connectTimeout(Duration.ofSeconds(5))
+                .build();
+            String base = "http://127.0.0.1:" + port;
+            // The routes of rest_api_server, requested in turn
+            HttpRequest[] requests = {
+                HttpRequest.newBuilder(URI.create(base + "/api/health")).GET().build(),
+                HttpRequest.newBuilder(URI.create(base + "/api/users")).GET().build(),
+                HttpRequest.newBuilder(URI.create(base + "/api/users"))
+                    .header("Content-Type", "application/json")
+                    .POST(HttpRequest.BodyPublishers.ofString("{\"name\": \"Linus\"}"))
+                    .build()
+            };
+            AtomicLong next = new AtomicLong();
+            return measure(script.name, "http", concurrency, () -> {
+                HttpRequest request = requests[(int) (next.getAndIncrement() % requests.length)];
+                HttpResponse<Void> response = client.send(request, HttpResponse.BodyHandlers.discarding());
+                if (response.statusCode() >= 400) {
+                    throw new IOException(request.method() + " " + request.uri().getPath() + " answered " + response.statusCode());
+                }
+            });
+        } finally {
+            Object server = environment.getVariable("server");
+            if (server instanceof Number) {
+                NativeHttp.stopServer(((Number) server).intValue());
+            }
+        }
+    }
+
+    // Wait for the script to publish its port and for that port to accept connections
+    private static int awaitServer(Environment environment, Thread serverThread) throws Exception {
+        long deadline = System.currentTimeMillis() + SERVER_START_TIMEOUT_MILLIS;
+        while (System.currentTimeMillis() < deadline) {
+            if (!serverThread.isAlive()) {
+                throw new IllegalStateException("server script exited before listening");
+            }
+            Object port = environment.getVariable("port");
+            if (port instanceof Number) {
+                try (Socket socket = new Socket()) {
+                    socket.connect(new InetSocketAddress("127.0.0.1", ((Number) port).intValue()), 200);
+                    return ((Number) port).intValue();
+                } catch (IOException e) {
+                    // Not listening yet
+                }
+            }
+            Thread.sleep(50);
+        }
+        throw new IllegalStateException("server did not start listening within " + SERVER_START_TIMEOUT_MILLIS + " ms");
+    }
+
+    private String measure(String name, String kind, int threads, Operation operation) throws Exception {
+        long warmupStart = System.nanoTime();
+        long warmupOperations = 0;
+        boolean stable = false;
+        double previousRate = -1;
+        while (System.nanoTime() - warmupStart < warmupMillis * 1_000_000L) {
+            Sample sample = window(operation, threads, WINDOW_MILLIS, 1);
+            warmupOperations += sample.operations;
+            double rate = sample.opsPerSec();
+            if (previousRate > 0 && Math.abs(rate - previousRate) <= STABLE_TOLERANCE * previousRate) {
+                stable = true;
+                break;
+            }
+            previousRate = rate;
+        }
+        long warmupNanos = System.nanoTime() - warmupStart;
+
+        Sample sample = window(operation, threads, timeMillis, MIN_OPERATIONS);
+        StringBuilder json = new StringBuilder();
+        json.append("{\"name\": ").append(quote(name))
+            .append(", \"kind\": ").append(quote(kind))
+            .append(", \"threads\": ").append(threads)
+            .append(", \"warmup\": {\"operations\": ").append(warmupOperations)
+            .append(", \"millis\": ").append(number(warmupNanos / 1e6))
+            .append(", \"stable\": ").append(stable).append('}')
+            .append(", \"operations\": ").append(sample.operations)
+            .append(", \"millis\": ").append(number(sample.elapsedNanos / 1e6))
+            .append(", \"opsPerSec\": ").append(number(sample.opsPerSec()));
+        if (sample.allocatedBytes >= 0) {
+            json.append(", \"allocatedBytesPerOp\": ").append(sample.allocatedBytes / Math.max(1, sample.operations))
+                .append(", \"allocationMBPerSec\": ").append(number(sample.allocatedBytes / 1e6 / (sample.elapsedNanos / 1e9)));
+        } else {
+            json.append(", \"allocatedBytesPerOp\": null, \"allocationMBPerSec\": null");
+        }
+        json.append(", \"latencyMillis\": {\"p50\": ").append(number(sample.percentile(0.50) / 1e6))
+            .append(", \"p99\": ").append(number(sample.percentile(0.99) / 1e6))
+            .append(", \"max\": ").append(number(sample.percentile(1.0) / 1e6))
+            .append("}}");
+        return json.toString();
+    }
+
+    private static final class Sample {
+        final long operations;
+        final long elapsedNanos;
+        final long allocatedBytes; // -1 when the JVM cannot count allocations
+        final long[] latencies;    // sorted
+
+        Sample(long elapsedNanos, long allocatedBytes, long[] latencies) {
+            this.operations = latencies.length;
+            this.elapsedNanos = elapsedNanos;
+            this.allocatedBytes = allocatedBytes;
+            this.latencies = latencies;
+        }
+
+        double opsPerSec() {
+            return operations * 1e9 / Math.max(1, elapsedNanos);
+        }
+
+        // Nearest-rank percentile
+        long percentile(double fraction) {
+            if (latencies.length == 0) {
+                return 0;
+            }
+            int rank = (int) Math.ceil(fraction * latencies.length);
+            return latencies[Math.min(latencies.length, Math.max(1, rank)) - 1];
+        }
+    }
+
+    private static final class Worker implements Runnable {
+        private final Operation operation;
+        private final long deadline;
+        private final int minOperations;
+        long[] latencies = new long[1024];
+        int count;
+        long allocatedBytes; // by this worker's thread, -1 when not tracked
+        Exception failure;
+
+        Worker(Operation operation, long deadline, int minOperations) {
+            this.operation = operation;
+            this.deadline = deadline;
+            this.minOperations = minOperations;
+        }
+
+        @Override
+        public void run() {
+            long allocatedBefore = threadAllocatedBytes();
+            try {
+                while (count < minOperations || System.nanoTime() < deadline) {
+                    long start = System.nanoTime();
+                    operation.run();
+                    if (count == latencies.length) {
+                        latencies = Arrays.copyOf(latencies, count * 2);
+                    }
+                    latencies[count++] = System.nanoTime() - start;
+                }
+            } catch (Exception e) {
+                failure = e;
+            } finally {
+                // Read here: once the thread ends its count is gone
+                long allocatedAfter = threadAllocatedBytes();
+                allocatedBytes = allocatedBefore >= 0 && allocatedAfter >= 0 ? allocatedAfter - allocatedBefore : -1;
+            }
+        }
+    }
+
+    // Run the operation on the given number of threads for about millis
+    private static Sample window(Operation operation, int threads, long millis, int minOperations) throws Exception {
+        long deadline = System.nanoTime() + millis * 1_000_000L;
+        Worker[] workers = new Worker[threads];
+        for (int i = 0; i < threads; i++) {
+            workers[i] = new Worker(operation, deadline, i == 0 ? minOperations : 0);
+        }
+
+        // The other threads; workers count their own allocations
+        long self = Thread.currentThread().getId();
+        Map<Long, Long> allocatedBefore = allocatedBytes(threads == 1 ? self : -1);
+        long start = System.nanoTime();
+        if (threads == 1) {
+            workers[0].run();
+        } else {
+            Thread[] running = new Thread[threads];
+            for (int i = 0; i < threads; i++) {
+                running[i] = new Thread(workers[i], "microscript-bench-" + i);
+                running[i].start();
+            }
+            for (Thread thread : running) {
+                thread.join();
+            }
+        }
+        long elapsed = System.nanoTime() - start;
+        Map<Long, Long> allocatedAfter = allocatedBytes(threads == 1 ? self : -1);
+
+        int total = 0;
+        long allocated = -1;
+        if (allocatedBefore != null && allocatedAfter != null) {
+            allocated = 0;
+            for (Map.Entry<Long, Long> thread : allocatedAfter.entrySet()) {
+                allocated += thread.getValue() - allocatedBefore.getOrDefault(thread.getKey(), 0L);
+            }
+        }
+        for (Worker worker : workers) {
+            if (worker.failure != null) {
+                throw worker.failure;
+            }
+            total += worker.count;
+            allocated = allocated >= 0 && worker.allocatedBytes >= 0 ? allocated + worker.allocatedBytes : -1;
+        }
+        long[] latencies = new long[total];
+        int offset = 0;
+        for (Worker worker : workers) {
+            System.arraycopy(worker.latencies, 0, latencies, offset, worker.count);
+            offset += worker.count;
+        }
+        Arrays.sort(latencies);
+
+        return new Sample(elapsed, allocated, latencies);
+    }
+
+    // Bytes allocated so far by each live thread except excluded, or null if the JVM does not track it
+    private static Map<Long, Long> allocatedBytes(long excluded) {
+        com.sun.management.ThreadMXBean counting = allocationCounter();
+        if (counting == null) {
+            return null;
+        }
+        long[] ids = counting.getAllThreadIds();
+        long[] allocated = counting.getThreadAllocatedBytes(ids);
+        Map<Long, Long> byThread = new HashMap<>(ids.length * 2);
+        for (int i = 0; i < ids.length; i++) {
+            if (ids[i] != excluded && allocated[i] >= 0) {
+                byThread.put(ids[i], allocated[i]);
+            }
+        }
+        return byThread;
+    }
+
+    private static long threadAllocatedBytes() {
+        com.sun.management.ThreadMXBean counting = allocationCounter();
+        return counting != null ? counting.getThreadAllocatedBytes(Thread.currentThread().getId()) : -1;
+    }
+
+    private static com.sun.management.ThreadMXBean allocationCounter() {
+        ThreadMXBean threads = ManagementFactory.getThreadMXBean();
+        if (!(threads instanceof com.sun.management.ThreadMXBean)) {
+            return null;
+        }
+        com.sun.management.ThreadMXBean counting = (com.sun.management.ThreadMXBean) threads;
+        if (!counting.isThreadAllocatedMemorySupported() || !counting.isThreadAllocatedMemoryEnabled()) {
+            return null;
+        }
+        return counting;
+    }
+
+    private static String number(double value) {
+        return String.format(Locale.ROOT, "%.3f", value);
+    }
+
+    private static String quote(String value) {
+        StringBuilder quoted = new StringBuilder(value.length() + 2).append('"');
+        for (int i = 0; i < value.length(); i++) {
+            char c = value.charAt(i);
+            if (c == '"' || c == '\\') {
+                quoted.append('\\').append(c);
+            } else if (c < 0x20) {
+                quoted.append(String.format("\\u%04x", (int) c));
+            } else {
+                quoted.append(c);
+            }
+        }
+        return quoted.append('"').toString();
+    }
+}
@@ -12,7 +12,7 @@ public class Cli {
     private static final String GREEN = "\u001B[32;1m"; // Bold green
     private static final String BLUE = "\u001B[34;1m";  // Bold blue
 
-    private static final String VERSION = "MicroScript v0.1.0";
+    static final String VERSION = "MicroScript v0.1.0";
     private static final String AUTHOR = "Cyril John Magayaga";
 
     public static void printUsage() {
@@ -22,7 +22,18 @@ public class Cli {
         System.out.println("  " + BLUE + "--version" + RESET + "     Show version information");
         System.out.println(GREEN + "Commands:" + RESET);
         System.out.println("  " + BLUE + "run" + RESET + "           Run a MicroScript source file");
+        System.out.println("  " + BLUE + "compile" + RESET + "       Cache the preprocessed form of a source file");
+        System.out.println("  " + BLUE + "bench" + RESET + "         Run the benchmark suite (default benchmarks/) and print JSON results");
         System.out.println("  " + BLUE + "about" + RESET + "         Show about information");
+        System.out.println(GREEN + "Run options:" + RESET);
+        System.out.println("  " + BLUE + "--io-buffer=<mode>" + RESET + "  Buffer io:: output: none (default), line or full");
+        System.out.println("  " + BLUE + "--cache" + RESET + "             Load the script from the cache, caching it on a miss");
+        System.out.println("  " + BLUE + "--profile[=<file>]" + RESET + "  Time each function and write folded stacks (default <script>.folded)");
+        System.out.println(GREEN + "Bench options:" + RESET);
+        System.out.println("  " + BLUE + "--warmup=<ms>" + RESET + "       Warm-up budget per benchmark (default 3000)");
+        System.out.println("  " + BLUE + "--time=<ms>" + RESET + "         Measurement time per benchmark (default 5000)");
+        System.out.println("  " + BLUE + "--concurrency=<n>" + RESET + "   Concurrent clients for HTTP scenarios (default 8)");
+        System.out.println("  " + BLUE + "--output=<file>" + RESET + "     Write the JSON report to a file instead of stdout");
     }
 
     public static void printHelp() {
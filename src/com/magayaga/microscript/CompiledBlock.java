@@ -0,0 +1,494 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * It was originally written in Java programming language.
+ */
+package com.magayaga.microscript;
+
+import java.util.List;
+import java.util.Objects;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.regex.Matcher;
+
+/**
+ * A loop body lowered once into per-line statement kinds. ForLoop and
+ * WhileLoop used to trim and re-classify every line on every iteration and
+ * send each statement through the regex chain in Executor.execute; a
+ * compiled block does that work when the loop is first entered and each
+ * iteration only dispatches on the stored kind.
+ *
+ * Classification uses the same tests, in the same order, as the code it
+ * replaces. Anything that depends on runtime state is checked at run time
+ * or left to Executor. Blocks are cached by the identity of their line list
+ * and verified line by line before reuse.
+ */
+public final class CompiledBlock {
+    private static final int SKIP = 0;
+    private static final int COMMENT = 1;
+    private static final int BREAK = 2;
+    private static final int CONTINUE = 3;
+    private static final int RETURN = 4;
+    private static final int IF = 5;
+    private static final int WHILE = 6;
+    private static final int FOR = 7;
+    private static final int STATEMENT = 8;
+
+    private static final int MAX_CACHED = 1024;
+    private static final ConcurrentHashMap<Key, CompiledBlock> CACHE = new ConcurrentHashMap<>();
+
+    /**
+     * How a kind of loop treats its body: whether bare closing braces are
+     * skipped, and the wording of the errors it reports
+     */
+    static final class Context {
+        final boolean skipClosingBraces;
+        final String ifError;
+        final String whileError;
+        final String forError;
+        final String statementError;
+
+        Context(boolean skipClosingBraces, String ifError, String whileError, String forError, String statementError) {
+            this.skipClosingBraces = skipClosingBraces;
+            this.ifError = ifError;
+            this.whileError = whileError;
+            this.forError = forError;
+            this.statementError = statementError;
+        }
+    }
+
+    static final Context FOR_LOOP = new Context(true,
+        "Error processing if statement in for loop: ",
+        "Error processing nested while loop in for loop: ",
+        "Error processing nested for loop: ",
+        "Error executing statement in for loop: '");
+
+    static final Context WHILE_LOOP = new Context(false,
+        "Error processing if statement in while loop: ",
+        "Error processing nested while loop: ",
+        "Error processing for loop in while loop: ",
+        "Error executing statement in while loop: '");
+
+    private final List<String> lines;
+    private final String[] source;
+    private final int startIndex;
+    private final int endIndex;
+    private final Context context;
+    private final int[] kinds;
+    private final int[] skipTo;
+    private final String[] text;
+    private final Statement[] statements;
+
+    private CompiledBlock(List<String> lines, int startIndex, int endIndex, Context context) {
+        this.lines = lines;
+        this.startIndex = startIndex;
+        this.endIndex = endIndex;
+        this.context = context;
+
+        int length = Math.max(0, endIndex - startIndex);
+        source = new String[length];
+        kinds = new int[length];
+        skipTo = new int[length];
+        text = new String[length];
+        statements = new Statement[length];
+
+        for (int i = startIndex; i < endIndex; i++) {
+            int k = i - startIndex;
+            String raw = lines.get(i);
+            String line = raw.trim();
+            source[k] = raw;
+            text[k] = line;
+
+            if (line.isEmpty() || line.startsWith("//")) {
+                kinds[k] = SKIP;
+            } else if (context.skipClosingBraces && line.equals("}")) {
+                kinds[k] = SKIP;
+            } else if (line.startsWith("/*")) {
+                // Resume after the line that closes the comment
+                int j = i;
+                while (j < endIndex && !lines.get(j).contains("*/")) {
+                    j++;
+                }
+                kinds[k] = COMMENT;
+                skipTo[k] = j;
+            } else if (line.equals("break") || line.equals("break;")) {
+                kinds[k] = BREAK;
+            } else if (line.equals("continue") || line.equals("continue;")) {
+                kinds[k] = CONTINUE;
+            } else if (line.startsWith("return")) {
+                kinds[k] = RETURN;
+            } else if (line.startsWith("if")) {
+                kinds[k] = IF;
+            } else if (line.startsWith("while")) {
+                kinds[k] = WHILE;
+            } else if (line.startsWith("for")) {
+                kinds[k] = FOR;
+            } else {
+                kinds[k] = STATEMENT;
+                statements[k] = Statement.of(line);
+            }
+        }
+    }
+
+    /**
+     * The compiled form of lines[startIndex, endIndex), reused while the
+     * list still holds the same line strings
+     */
+    static CompiledBlock of(List<String> lines, int startIndex, int endIndex, Context context) {
+        Key key = new Key(lines, startIndex, endIndex, context);
+        CompiledBlock block = CACHE.get(key);
+        if (block != null && block.matches(lines)) {
+            return block;
+        }
+
+        block = new CompiledBlock(lines, startIndex, endIndex, context);
+        if (CACHE.size() >= MAX_CACHED) {
+            CACHE.clear();
+        }
+        CACHE.put(key, block);
+        return block;
+    }
+
+    private boolean matches(List<String> current) {
+        if (current.size() < endIndex) {
+            return false;
+        }
+        for (int i = startIndex; i < endIndex; i++) {
+            if (current.get(i) != source[i - startIndex]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Run the block once, as one loop iteration
+     * @throws Statements.BreakException on break or return
+     * @throws Statements.ContinueException on continue
+     */
+    void execute(Executor executor) throws Statements.BreakException, Statements.ContinueException {
+        for (int i = startIndex; i < endIndex; i++) {
+            int k = i - startIndex;
+            switch (kinds[k]) {
+                case SKIP:
+                    break;
+                case COMMENT:
+                    i = skipTo[k];
+                    break;
+                case BREAK:
+                    throw new Statements.BreakException();
+                case CONTINUE:
+                    throw new Statements.ContinueException();
+                case RETURN:
+                    executor.execute(text[k]); // throws ReturnException inside a function body
+                    throw new Statements.BreakException(); // Treat return as break for loop purposes
+                case IF:
+                    try {
+                        int newIndex = Statements.processConditionalStatement(lines, i, executor);
+                        if (newIndex > i) {
+                            i = newIndex - 1;
+                        }
+                    } catch (Statements.BreakException | Statements.ContinueException | Statements.ReturnException e) {
+                        throw e;
+                    } catch (Exception e) {
+                        throw new RuntimeException(context.ifError + e.getMessage());
+                    }
+                    break;
+                case WHILE:
+                    try {
+                        int newIndex = WhileLoop.processWhileLoop(lines, i, executor);
+                        if (newIndex > i) {
+                            i = newIndex - 1;
+                        }
+                    } catch (Statements.ReturnException e) {
+                        throw e;
+                    } catch (Exception e) {
+                        throw new RuntimeException(context.whileError + e.getMessage());
+                    }
+                    break;
+                case FOR:
+                    try {
+                        int newIndex = ForLoop.processForLoop(lines, i, executor);
+                        if (newIndex > i) {
+                            i = newIndex - 1;
+                        }
+                    } catch (Statements.ReturnException e) {
+                        throw e;
+                    } catch (Exception e) {
+                        throw new RuntimeException(context.forError + e.getMessage());
+                    }
+                    break;
+                default:
+                    try {
+                        statements[k].run(executor);
+                    } catch (Statements.ReturnException e) {
+                        throw e;
+                    } catch (Exception e) {
+                        throw new RuntimeException(context.statementError + text[k] + "' - " + e.getMessage());
+                    }
+                    break;
+            }
+        }
+    }
+
+    private static final class Key {
+        private final List<String> lines;
+        private final int startIndex;
+        private final int endIndex;
+        private final Context context;
+
+        Key(List<String> lines, int startIndex, int endIndex, Context context) {
+            this.lines = lines;
+            this.startIndex = startIndex;
+            this.endIndex = endIndex;
+            this.context = context;
+        }
+
+        @Override
+        public boolean equals(Object other) {
+            if (!(other instanceof Key)) {
+                return false;
+            }
+            Key key = (Key) other;
+            return lines == key.lines && startIndex == key.startIndex
+                && endIndex == key.endIndex && context == key.context;
+        }
+
+        @Override
+        public int hashCode() {
+            return Objects.hash(System.identityHashCode(lines), startIndex, endIndex, System.identityHashCode(context));
+        }
+    }
+
+    /**
+     * A statement classified once by the tests Executor.execute applies to
+     * it. Increments and plain expressions run directly; everything else is
+     * handed back to Executor.execute.
+     */
+    static final class Statement {
+        private static final int GENERIC = 0;
+        private static final int NOOP = 1;
+        private static final int STEP = 2;
+        private static final int EXPRESSION = 3;
+
+        private static final ConcurrentHashMap<String, Statement> STATEMENTS = new ConcurrentHashMap<>();
+
+        private final String text;
+        private final int kind;
+        private final String variable;
+        private final boolean increment;
+        private final Evaluation evaluation;
+
+        private Statement(String text, int kind, String variable, boolean increment, Evaluation evaluation) {
+            this.text = text;
+            this.kind = kind;
+            this.variable = variable;
+            this.increment = increment;
+            this.evaluation = evaluation;
+        }
+
+        static Statement of(String expression) {
+            Statement statement = STATEMENTS.get(expression);
+            if (statement == null) {
+                statement = compile(expression);
+                if (STATEMENTS.size() >= MAX_CACHED) {
+                    STATEMENTS.clear();
+                }
+                STATEMENTS.put(expression, statement);
+            }
+            return statement;
+        }
+
+        private static Statement compile(String expression) {
+            if (expression.startsWith("//")) {
+                return new Statement(expression, NOOP, null, false, null);
+            }
+
+            String trimmed = expression.trim();
+            if (trimmed.equals("break;") || trimmed.equals("break") ||
+                trimmed.equals("continue;") || trimmed.equals("continue")) {
+                return new Statement(expression, GENERIC, null, false, null);
+            }
+
+            String step = Executor.matchIncrementDecrement(trimmed);
+            if (step != null) {
+                return new Statement(expression, STEP, step.substring(1), step.charAt(0) == '+', null);
+            }
+
+            if (expression.startsWith("if") || expression.startsWith("for") || expression.startsWith("while") ||
+                expression.startsWith("console.write") || expression.startsWith("console.system") ||
+                expression.startsWith("var ") || expression.startsWith("bool ") ||
+                expression.startsWith("letexpr ") || expression.startsWith("list ") ||
+                trimmed.startsWith("switch") || expression.startsWith("return")) {
+                return new Statement(expression, GENERIC, null, false, null);
+            }
+
+            return new Statement(expression, EXPRESSION, null, false, Evaluation.of(expression));
+        }
+
+        void run(Executor executor) {
+            if (kind == GENERIC) {
+                executor.execute(text);
+                return;
+            }
+            if (kind == NOOP) {
+                return;
+            }
+
+            // Same error handling as Executor.execute
+            try {
+                if (kind == STEP) {
+                    executor.stepVariable(variable, increment);
+                } else {
+                    evaluation.evaluate(executor);
+                }
+            } catch (Statements.BreakException | Statements.ContinueException e) {
+                throw e;
+            } catch (Exception e) {
+                System.out.println("Evaluation error: " + e.getMessage());
+            }
+        }
+    }
+
+    /**
+     * An expression classified once by the tests Executor.evaluate applies
+     * to it. Variable and struct lookups that evaluate performs before
+     * arithmetic still happen at run time, since they depend on scope.
+     */
+    static final class Evaluation {
+        private static final int GENERIC = 0;
+        private static final int EMPTY = 1;
+        private static final int LITERAL = 2;
+        private static final int CALL = 3;
+        private static final int BOOLEAN = 4;
+        private static final int COMPILED = 5;
+
+        private static final ConcurrentHashMap<String, Evaluation> EVALUATIONS = new ConcurrentHashMap<>();
+
+        private final String text;
+        private final int kind;
+        private final Object value;
+        private final String functionName;
+        private final String[] arguments;
+        private final String memberVariable;
+        private final String memberField;
+        private final ExpressionCompiler.Node node;
+
+        private Evaluation(String text, int kind, Object value, String functionName, String[] arguments,
+                           String memberVariable, String memberField, ExpressionCompiler.Node node) {
+            this.text = text;
+            this.kind = kind;
+            this.value = value;
+            this.functionName = functionName;
+            this.arguments = arguments;
+            this.memberVariable = memberVariable;
+            this.memberField = memberField;
+            this.node = node;
+        }
+
+        static Evaluation of(String expression) {
+            Evaluation evaluation = EVALUATIONS.get(expression);
+            if (evaluation == null) {
+                evaluation = compile(expression);
+                if (EVALUATIONS.size() >= MAX_CACHED) {
+                    EVALUATIONS.clear();
+                }
+                EVALUATIONS.put(expression, evaluation);
+            }
+            return evaluation;
+        }
+
+        private static Evaluation generic(String expression) {
+            return new Evaluation(expression, GENERIC, null, null, null, null, null, null);
+        }
+
+        private static Evaluation compile(String expression) {
+            if (expression.trim().isEmpty()) {
+                return new Evaluation(expression, EMPTY, null, null, null, null, null, null);
+            }
+
+            if (expression.startsWith("\"") && expression.endsWith("\"")) {
+                if (expression.length() < 2) {
+                    return generic(expression);
+                }
+                return new Evaluation(expression, LITERAL, expression.substring(1, expression.length() - 1), null, null, null, null, null);
+            }
+
+            if (expression.startsWith("'") && expression.endsWith("'") && expression.length() == 3) {
+                return new Evaluation(expression, LITERAL, expression.charAt(1), null, null, null, null, null);
+            }
+
+            Matcher matcher = Executor.FUNCTION_CALL_PATTERN.matcher(expression);
+            if (Executor.isSingleCall(matcher, expression)) {
+                String args = matcher.group(2).trim();
+                String[] arguments = args.isEmpty() ? new String[0] : Executor.splitByCommaWithTrim(args).toArray(new String[0]);
+                return new Evaluation(expression, CALL, null, matcher.group(1), arguments, null, null, null);
+            }
+
+            if (Executor.INPUT_PATTERN.matcher(expression).matches() || expression.startsWith("math::sqrt(")) {
+                return generic(expression);
+            }
+
+            // Struct field access is decided at run time by what the variable holds
+            String memberVariable = null;
+            String memberField = null;
+            if (expression.contains(".") && !expression.startsWith("console.") && !expression.startsWith("io::") && !expression.startsWith("math::")) {
+                String[] parts = expression.split("\\.", 2);
+                if (parts.length == 2) {
+                    memberVariable = parts[0].trim();
+                    memberField = parts[1].trim();
+                }
+            }
+
+            if (expression.equals("true") || expression.equals("false")) {
+                return new Evaluation(expression, BOOLEAN, Boolean.valueOf(expression), null, null, null, null, null);
+            }
+
+            if (expression.startsWith("not ") || expression.startsWith("!")) {
+                return generic(expression);
+            }
+
+            int questionPos = expression.indexOf('?');
+            if (questionPos > 0 && expression.indexOf(':', questionPos) > questionPos) {
+                return generic(expression);
+            }
+
+            return new Evaluation(expression, COMPILED, null, null, null, memberVariable, memberField,
+                                  ExpressionCompiler.compile(expression));
+        }
+
+        Object evaluate(Executor executor) {
+            Environment environment = executor.getEnvironment();
+            switch (kind) {
+                case EMPTY:
+                    return null;
+                case LITERAL:
+                    return value;
+                case CALL:
+                    return executor.executeFunction(functionName, arguments);
+                case BOOLEAN: {
+                    Object variableValue = environment.getVariable(text);
+                    return variableValue != null ? variableValue : value;
+                }
+                case COMPILED: {
+                    if (memberVariable != null) {
+                        Object obj = environment.getVariable(memberVariable);
+                        if (obj instanceof Struct) {
+                            return ((Struct) obj).getField(memberField);
+                        }
+                    }
+                    Object variableValue = environment.getVariable(text);
+                    if (variableValue != null) {
+                        return variableValue;
+                    }
+                    if (node == null) {
+                        return new ExpressionEvaluator(text, environment).parse();
+                    }
+                    return node.evaluate(environment);
+                }
+                default:
+                    return executor.evaluate(text);
+            }
+        }
+    }
+}
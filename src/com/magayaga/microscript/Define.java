@@ -10,18 +10,73 @@ import java.util.*;
 import java.util.regex.*;
 
 public class Define {
+    /**
+     * Version of the expansion rules. ScriptCache keys entries on it, so any
+     * change to what preprocess produces must bump it.
+     */
+    public static final int VERSION = 2; // 2: single-pass expansion with nested macro calls
+
+    private static final Pattern DEFINE_FUNCTION_PATTERN =
+        Pattern.compile("#define\\s+([A-Z_][A-Z0-9_]*)\\s*\\(([^)]*)\\)\\s*(.*)");
+    private static final Pattern DEFINE_OBJECT_PATTERN =
+        Pattern.compile("#define\\s+([A-Z_][A-Z0-9_]*)(?:\\s+(.*))?");
+    private static final Pattern UNDEF_PATTERN = Pattern.compile("#undef\\s+([A-Z_][A-Z0-9_]*)");
+
+    // Bounds re-expansion of macro results, e.g. for a macro that names itself
+    private static final int MAX_EXPANSION_DEPTH = 10;
+
     // Stores object-like macros: NAME -> value
     private final Map<String, String> objectMacros = new HashMap<>();
     // Stores function-like macros: NAME -> MacroDef
     private final Map<String, MacroDef> functionMacros = new HashMap<>();
 
-    // Represents a function-like macro (name, parameter list, body)
+    /**
+     * Represents a function-like macro (name, parameter list, body). The body
+     * is split once into literal text and parameter references, so a call
+     * only joins the pieces with its arguments.
+     */
     private static class MacroDef {
         final List<String> params;
         final String body;
+        private final List<String> pieces = new ArrayList<>(); // text before each reference, plus the tail
+        private final List<Integer> references = new ArrayList<>(); // parameter index of each reference
+
         MacroDef(List<String> params, String body) {
             this.params = params;
             this.body = body;
+
+            Map<String, Integer> indexes = new HashMap<>();
+            for (int i = 0; i < params.size(); i++) {
+                indexes.putIfAbsent(params.get(i).trim(), i);
+            }
+
+            int copied = 0;
+            int i = 0;
+            while (i < body.length()) {
+                if (!isWordChar(body.charAt(i))) {
+                    i++;
+                    continue;
+                }
+                int start = i;
+                while (i < body.length() && isWordChar(body.charAt(i))) {
+                    i++;
+                }
+                Integer index = indexes.get(body.substring(start, i));
+                if (index != null) {
+                    pieces.add(body.substring(copied, start));
+                    references.add(index);
+                    copied = i;
+                }
+            }
+            pieces.add(body.substring(copied));
+        }
+
+        String apply(List<String> args) {
+            StringBuilder result = new StringBuilder(body.length() + 16);
+            for (int i = 0; i < references.size(); i++) {
+                result.append(pieces.get(i)).append(args.get(references.get(i)).trim());
+            }
+            return result.append(pieces.get(references.size())).toString();
         }
     }
 
@@ -29,7 +84,7 @@ public class Define {
      * Processes lines for #define macros and expands macros in code.
      */
     public List<String> preprocess(List<String> lines) {
-        List<String> output = new ArrayList<>();
+        List<String> output = new ArrayList<>(lines.size());
         for (String line : lines) {
             String trimmed = line.trim();
             if (trimmed.startsWith("#define")) {
@@ -50,8 +105,7 @@ public class Define {
      */
     private void parseDefine(String line) {
         // Function-like macro: #define NAME(PARAMS) body (NAME is ALL UPPERCASE)
-        Pattern funcPat = Pattern.compile("#define\\s+([A-Z_][A-Z0-9_]*)\\s*\\(([^)]*)\\)\\s*(.*)");
-        Matcher mFunc = funcPat.matcher(line);
+        Matcher mFunc = DEFINE_FUNCTION_PATTERN.matcher(line);
         if (mFunc.matches()) {
             String name = mFunc.group(1);
             String paramList = mFunc.group(2).trim();
@@ -63,8 +117,7 @@ public class Define {
             return;
         }
         // Object-like macro: #define NAME value (NAME is ALL UPPERCASE)
-        Pattern objPat = Pattern.compile("#define\\s+([A-Z_][A-Z0-9_]*)(?:\\s+(.*))?");
-        Matcher mObj = objPat.matcher(line);
+        Matcher mObj = DEFINE_OBJECT_PATTERN.matcher(line);
         if (mObj.matches()) {
             String name = mObj.group(1);
             String value = mObj.group(2);
@@ -77,8 +130,7 @@ public class Define {
      * Parses a #undef directive to remove macro definitions.
      */
     private void parseUndef(String line) {
-        Pattern undefPat = Pattern.compile("#undef\\s+([A-Z_][A-Z0-9_]*)");
-        Matcher mUndef = undefPat.matcher(line);
+        Matcher mUndef = UNDEF_PATTERN.matcher(line);
         if (mUndef.matches()) {
             String name = mUndef.group(1);
             objectMacros.remove(name);
@@ -87,100 +139,118 @@ public class Define {
     }
 
     /**
-     * Expands macros in a single line.
+     * Expands macros in a single line, in one scan over its words. Names
+     * are looked up in the macro tables, so the cost does not grow with
+     * the number of macros defined. Like the word-boundary matching this
+     * replaces, names inside string literals are expanded too, which is
+     * what lets "{PI}" templates see macro values.
      * If a function-like macro is called with the wrong number of arguments,
      * replaces the macro call with a runtime error marker.
      */
     public String expandMacros(String line) {
-        String result = line;
-
-        // Multiple passes to handle nested macro expansions
-        for (int pass = 0; pass < 10; pass++) { // Limit passes to prevent infinite loops
-            String beforeExpansion = result;
-
-            // Expand function-like macros first
-            result = expandFunctionMacros(result);
-
-            // Expand object-like macros
-            result = expandObjectMacros(result);
-
-            // If no changes were made, we're done
-            if (result.equals(beforeExpansion)) {
-                break;
-            }
+        if (objectMacros.isEmpty() && functionMacros.isEmpty()) {
+            return line;
         }
-
-        return result;
+        return expand(line, 0);
     }
 
-    /**
-     * Expands function-like macros in a line.
-     */
-    private String expandFunctionMacros(String line) {
-        String result = line;
-        boolean replaced;
+    private String expand(String text, int depth) {
+        StringBuilder result = null;
+        int copied = 0;
+        int i = 0;
+        int length = text.length();
 
-        do {
-            replaced = false;
-            for (Map.Entry<String, MacroDef> entry : functionMacros.entrySet()) {
-                String name = entry.getKey();
-                MacroDef macro = entry.getValue();
+        while (i < length) {
+            if (!isWordChar(text.charAt(i))) {
+                i++;
+                continue;
+            }
+            int start = i;
+            while (i < length && isWordChar(text.charAt(i))) {
+                i++;
+            }
 
-                // Regex to match macro call: NAME(arg1, arg2, ...)
-                // Use word boundary to avoid partial matches
-                Pattern callPat = Pattern.compile("\\b" + Pattern.quote(name) + "\\s*\\(([^()]*(?:\\([^()]*\\)[^()]*)*)\\)");
-                Matcher mCall = callPat.matcher(result);
+            // Macro names start with an uppercase letter or underscore
+            char first = text.charAt(start);
+            if (!((first >= 'A' && first <= 'Z') || first == '_')) {
+                continue;
+            }
 
-                if (mCall.find()) {
-                    String argStr = mCall.group(1);
-                    List<String> args = splitArgs(argStr);
+            String name = text.substring(start, i);
+            String replacement = null;
+            int end = i;
 
+            MacroDef macro = functionMacros.get(name);
+            if (macro != null) {
+                int open = i;
+                while (open < length && Character.isWhitespace(text.charAt(open))) {
+                    open++;
+                }
+                int close = open < length && text.charAt(open) == '(' ? matchingParenthesis(text, open) : -1;
+                if (close != -1) {
+                    List<String> args = splitArgs(text.substring(open + 1, close));
+                    end = close + 1;
                     if (args.size() != macro.params.size()) {
                         // Wrong number of arguments, mark as error
-                        result = mCall.replaceFirst("/*MACRO_ARG_ERROR:" + name + "*/");
+                        replacement = "/*MACRO_ARG_ERROR:" + name + "*/";
                     } else {
-                        String body = macro.body;
-
-                        // Replace parameters with arguments
-                        for (int i = 0; i < macro.params.size(); i++) {
-                            String param = macro.params.get(i).trim();
-                            String arg = args.get(i).trim();
-                            // Use word boundary to replace only complete parameter names
-                            body = body.replaceAll("\\b" + Pattern.quote(param) + "\\b",
-                                                 Matcher.quoteReplacement(arg));
-                        }
-
+                        String body = macro.apply(args);
                         // Only wrap in parentheses if the body contains operators and isn't already wrapped
                         if (needsParentheses(body)) {
                             body = "(" + body + ")";
                         }
-
-                        result = mCall.replaceFirst(Matcher.quoteReplacement(body));
+                        replacement = depth < MAX_EXPANSION_DEPTH ? expand(body, depth + 1) : body;
                     }
-                    replaced = true;
-                    break;
                 }
             }
-        } while (replaced);
 
-        return result;
-    }
+            if (replacement == null) {
+                String value = objectMacros.get(name);
+                if (value == null) {
+                    continue;
+                }
+                replacement = depth < MAX_EXPANSION_DEPTH ? expand(value, depth + 1) : value;
+            }
 
-    /**
-     * Expands object-like macros in a line.
-     */
-    private String expandObjectMacros(String line) {
-        String result = line;
-
-        for (Map.Entry<String, String> entry : objectMacros.entrySet()) {
-            String name = entry.getKey();
-            String value = entry.getValue();
-            // Use word boundary to replace only complete macro names
-            result = result.replaceAll("\\b" + Pattern.quote(name) + "\\b",
-                                     Matcher.quoteReplacement(value));
+            if (result == null) {
+                result = new StringBuilder(length + 32);
+            }
+            result.append(text, copied, start).append(replacement);
+            copied = end;
+            i = end;
+        }
+
+        if (result == null) {
+            return text;
         }
+        return result.append(text, copied, length).toString();
+    }
+
+    private static boolean isWordChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
 
-        return result;
+    // Index of the parenthesis closing the one at open, skipping literals; -1 if unclosed
+    private static int matchingParenthesis(String text, int open) {
+        int depth = 0;
+        boolean inQuote = false;
+        boolean inChar = false;
+        for (int i = open; i < text.length(); i++) {
+            char c = text.charAt(i);
+            boolean escaped = i > 0 && text.charAt(i - 1) == '\\';
+            if (c == '"' && !inChar && !escaped) {
+                inQuote = !inQuote;
+            } else if (c == '\'' && !inQuote && !escaped) {
+                inChar = !inChar;
+            } else if (!inQuote && !inChar) {
+                if (c == '(') {
+                    depth++;
+                } else if (c == ')' && --depth == 0) {
+                    return i;
+                }
+            }
+        }
+        return -1;
     }
 
     /**
@@ -191,7 +261,12 @@ public class Define {
         if (body.startsWith("(") && body.endsWith(")")) return false;
 
         // Check if body contains operators that might need precedence protection
-        return body.matches(".*[+\\-*/&|^%<>=!].*");
+        for (int i = 0; i < body.length(); i++) {
+            if ("+-*/&|^%<>=!".indexOf(body.charAt(i)) >= 0) {
+                return true;
+            }
+        }
+        return false;
     }
 
     /**
@@ -1,50 +1,139 @@
 /**
  * MicroScript — The programming language
- * Copyright (c) 2024-2025 Cyril John Magayaga
+ * Copyright (c) 2024-2026 Cyril John Magayaga
  * 
  * It was originally written in Java programming language.
  */
 package com.magayaga.microscript;
 
+import java.util.Arrays;
 import java.util.HashMap;
 import java.util.Map;
 import java.util.Set;
 import java.util.HashSet;
 
 public class Environment {
-    private final Map<String, Object> variables;
-    private final Map<String, Function> functions;
-    private final Map<String, Struct> structs;
-    private final Set<String> immutableVariables;
+    // Small frames keep variables in parallel slot arrays and only switch to
+    // a HashMap once they outgrow MAX_SLOTS. Function frames start from the
+    // function's parameter layout, so binding arguments is an array store.
+    private static final int MAX_SLOTS = 8;
+    private static final String[] NO_LAYOUT = new String[0];
+
+    private final String[] layout;
+    private String[] slotNames;
+    private Object[] slotValues;
+    private int slotCount;
+    private Map<String, Object> variables;
+
+    // Allocated on first use; most frames never define functions or structs
+    private Map<String, Function> functions;
+    private Map<String, Struct> structs;
+    private Set<String> immutableVariables;
     private final Environment parent;
 
     public Environment() {
-        this.variables = new HashMap<>();
-        this.functions = new HashMap<>();
-        this.structs = new HashMap<>();
-        this.immutableVariables = new HashSet<>();
-        this.parent = null;
+        this(null, NO_LAYOUT);
     }
 
     public Environment(Environment parent) {
-        this.variables = new HashMap<>();
-        this.functions = new HashMap<>();
-        this.structs = new HashMap<>();
-        this.immutableVariables = new HashSet<>();
+        this(parent, NO_LAYOUT);
+    }
+
+    /**
+     * A frame whose first slots are the given names, in order. The array is
+     * shared, not copied, so every call of a function reuses its layout.
+     */
+    public Environment(Environment parent, String[] layout) {
         this.parent = parent;
+        this.layout = layout;
+        this.slotNames = layout;
+        this.slotValues = new Object[Math.max(layout.length, 2)];
+        this.slotCount = layout.length;
+    }
+
+    public String[] getLayout() {
+        return layout;
+    }
+
+    /**
+     * Store into a layout slot without a name lookup
+     */
+    public void setSlot(int index, Object value) {
+        if (variables != null) {
+            variables.put(layout[index], value);
+        } else {
+            slotValues[index] = value;
+        }
+    }
+
+    /**
+     * The value in a layout slot of this frame, or null if it is unset
+     */
+    public Object getSlot(int index) {
+        return variables != null ? variables.get(layout[index]) : slotValues[index];
+    }
+
+    private int slotOf(String name) {
+        String[] names = slotNames;
+        for (int i = 0; i < slotCount; i++) {
+            if (names[i] == name) {
+                return i;
+            }
+        }
+        for (int i = 0; i < slotCount; i++) {
+            if (names[i].equals(name)) {
+                return i;
+            }
+        }
+        return -1;
     }
 
     public void setVariable(String name, Object value) {
-        variables.put(name, value);
+        if (variables != null) {
+            variables.put(name, value);
+            return;
+        }
+
+        int slot = slotOf(name);
+        if (slot >= 0) {
+            slotValues[slot] = value;
+            return;
+        }
+
+        if (slotCount >= MAX_SLOTS) {
+            variables = new HashMap<>();
+            for (int i = 0; i < slotCount; i++) {
+                variables.put(slotNames[i], slotValues[i]);
+            }
+            variables.put(name, value);
+            slotNames = null;
+            slotValues = null;
+            slotCount = 0;
+            return;
+        }
+
+        // The layout array is shared between frames; copy before appending
+        if (slotNames == layout || slotCount == slotNames.length) {
+            slotNames = Arrays.copyOf(slotNames, Math.min(MAX_SLOTS, Math.max(slotCount * 2, 4)));
+        }
+        if (slotCount == slotValues.length) {
+            slotValues = Arrays.copyOf(slotValues, slotNames.length);
+        }
+        slotNames[slotCount] = name;
+        slotValues[slotCount] = value;
+        slotCount++;
     }
 
     public void setImmutableVariable(String name, Object value) {
-        variables.put(name, value);
+        setVariable(name, value);
+        if (immutableVariables == null) {
+            immutableVariables = new HashSet<>();
+        }
         immutableVariables.add(name);
     }
 
     public boolean isImmutable(String name) {
-        if (immutableVariables.contains(name)) {
+        if (immutableVariables != null && immutableVariables.contains(name)) {
             return true;
         }
         if (parent != null) {
@@ -54,7 +143,13 @@ public class Environment {
     }
 
     public Object getVariable(String name) {
-        Object value = variables.get(name);
+        Object value;
+        if (variables != null) {
+            value = variables.get(name);
+        } else {
+            int slot = slotOf(name);
+            value = slot >= 0 ? slotValues[slot] : null;
+        }
         if (value != null) {
             return value;
         }
@@ -65,11 +160,14 @@ public class Environment {
     }
 
     public void defineFunction(Function function) {
+        if (functions == null) {
+            functions = new HashMap<>();
+        }
         functions.put(function.getName(), function);
     }
 
     public Function getFunction(String name) {
-        Function function = functions.get(name);
+        Function function = functions != null ? functions.get(name) : null;
         if (function != null) {
             return function;
         }
@@ -87,11 +185,14 @@ public class Environment {
     }
 
     public void defineStruct(Struct struct) {
+        if (structs == null) {
+            structs = new HashMap<>();
+        }
         structs.put(struct.getName(), struct);
     }
 
     public Struct getStruct(String name) {
-        Struct struct = structs.get(name);
+        Struct struct = structs != null ? structs.get(name) : null;
         if (struct != null) {
             return struct;
         }
@@ -21,17 +21,21 @@ public class Executor {
     // Flag to track if we're inside a loop context
     private boolean inLoopContext = false;
 
+    // Set for executors running a function body, where a nested return unwinds to the call
+    private boolean inFunctionContext = false;
+
+    // The function whose body this executor runs, for tail-call detection
+    private Function currentFunction = null;
+
     private static final Scanner scanner = new Scanner(System.in);
 
     // Pre-compiled regex patterns
     private static final Pattern CONSOLE_WRITE_PATTERN = Pattern.compile("console\\.write\\((.*)\\);");
     private static final Pattern CONSOLE_SYSTEM_PATTERN = Pattern.compile("console\\.system\\((.*)\\);");
-    private static final Pattern FUNCTION_CALL_PATTERN = Pattern.compile("(\\w+)\\((.*)\\)");
+    static final Pattern FUNCTION_CALL_PATTERN = Pattern.compile("(\\w+)\\((.*)\\)");
     private static final Pattern STRING_TEMPLATE_EXPR_PATTERN = Pattern.compile("\\{([^{}]+)\\}");
     private static final Pattern STRING_TEMPLATE_POSITIONAL_PATTERN = Pattern.compile("\\{\\}");
     private static final Pattern SWITCH_DETECT_PATTERN = Pattern.compile("^\\s*switch\\s*\\(.*\\)\\s*\\{?\\s*$");
-    private static final Pattern DEFINE_FUNC_MACRO_PATTERN =
-        Pattern.compile("#define\\s+([A-Z_][A-Z0-9_]*)\\s*\\(([^)]*)\\)\\s+(.+)");
     private static final Pattern CONSOLE_WRITEF_PATTERN = Pattern.compile("console\\.writef\\((.*)\\);");
     
     // Patterns for increment/decrement operations
@@ -41,7 +45,7 @@ public class Executor {
     private static final Pattern POST_DECREMENT_PATTERN = Pattern.compile("([a-zA-Z_][a-zA-Z0-9_]*)--\\s*;?");
     
     // Pattern for input operation
-    private static final Pattern INPUT_PATTERN = Pattern.compile("input\\((.*)\\)");
+    static final Pattern INPUT_PATTERN = Pattern.compile("input\\((.*)\\)");
 
     public Executor(Environment environment) {
         this.environment = environment;
@@ -52,6 +56,13 @@ public class Executor {
         this.inLoopContext = inLoopContext;
     }
 
+    Executor(Environment environment, boolean inLoopContext, Function currentFunction) {
+        this.environment = environment;
+        this.inLoopContext = inLoopContext;
+        this.inFunctionContext = true;
+        this.currentFunction = currentFunction;
+    }
+
     public Environment getEnvironment() {
         return environment;
     }
@@ -417,8 +428,11 @@ public class Executor {
             }
             
             else if (expression.startsWith("return")) {
-                // Handle return statements
-                // This will be processed in executeFunction
+                // Returns at the top of a function body are processed in invokeFunction;
+                // one nested in a block of the body unwinds to it from here
+                if (inFunctionContext) {
+                    throw new Statements.ReturnException(returnResult(expression));
+                }
                 return;
             }
             
@@ -428,8 +442,8 @@ public class Executor {
             }
         }
         
-        catch (Statements.BreakException | Statements.ContinueException e) {
-            // Re-throw these exceptions to be caught by the appropriate loop handler
+        catch (Statements.BreakException | Statements.ContinueException | Statements.ReturnException e) {
+            // Re-throw these exceptions to be caught by the appropriate loop or function
             throw e;
         }
         
@@ -460,113 +474,61 @@ public class Executor {
      * @return true if the expression was an increment/decrement operation and was handled
      */
     private boolean handleIncrementDecrement(String expression) {
-        String trimmed = expression.trim();
-        
-        // Handle pre-increment (++var)
+        String step = matchIncrementDecrement(expression.trim());
+        if (step == null) {
+            return false; // Not an increment/decrement operation
+        }
+        stepVariable(step.substring(1), step.charAt(0) == '+');
+        return true;
+    }
+
+    /**
+     * Match ++var, --var, var++ or var-- against a trimmed statement
+     * @return the variable name prefixed with '+' or '-', or null if the statement is not one
+     */
+    static String matchIncrementDecrement(String trimmed) {
         Matcher preIncMatcher = PRE_INCREMENT_PATTERN.matcher(trimmed);
         if (preIncMatcher.matches()) {
-            String varName = preIncMatcher.group(1);
-            Object currentValue = environment.getVariable(varName);
-            
-            if (currentValue == null) {
-                throw new RuntimeException("Undefined variable: " + varName);
-            }
-            
-            if (!(currentValue instanceof Number)) {
-                throw new RuntimeException("Cannot increment non-numeric variable: " + varName);
-            }
-            
-            double currentNum = ((Number) currentValue).doubleValue();
-            double newValue = currentNum + 1;
-            
-            // Store the new value
-            if (currentValue instanceof Integer) {
-                environment.setVariable(varName, (int) newValue);
-            } else {
-                environment.setVariable(varName, newValue);
-            }
-            return true;
+            return "+" + preIncMatcher.group(1);
         }
-        
-        // Handle pre-decrement (--var)
         Matcher preDecMatcher = PRE_DECREMENT_PATTERN.matcher(trimmed);
         if (preDecMatcher.matches()) {
-            String varName = preDecMatcher.group(1);
-            Object currentValue = environment.getVariable(varName);
-            
-            if (currentValue == null) {
-                throw new RuntimeException("Undefined variable: " + varName);
-            }
-            
-            if (!(currentValue instanceof Number)) {
-                throw new RuntimeException("Cannot decrement non-numeric variable: " + varName);
-            }
-            
-            double currentNum = ((Number) currentValue).doubleValue();
-            double newValue = currentNum - 1;
-            
-            // Store the new value
-            if (currentValue instanceof Integer) {
-                environment.setVariable(varName, (int) newValue);
-            } else {
-                environment.setVariable(varName, newValue);
-            }
-            return true;
+            return "-" + preDecMatcher.group(1);
         }
-        
-        // Handle post-increment (var++)
         Matcher postIncMatcher = POST_INCREMENT_PATTERN.matcher(trimmed);
         if (postIncMatcher.matches()) {
-            String varName = postIncMatcher.group(1);
-            Object currentValue = environment.getVariable(varName);
-            
-            if (currentValue == null) {
-                throw new RuntimeException("Undefined variable: " + varName);
-            }
-            
-            if (!(currentValue instanceof Number)) {
-                throw new RuntimeException("Cannot increment non-numeric variable: " + varName);
-            }
-            
-            double currentNum = ((Number) currentValue).doubleValue();
-            double newValue = currentNum + 1;
-            
-            // Store the new value
-            if (currentValue instanceof Integer) {
-                environment.setVariable(varName, (int) newValue);
-            } else {
-                environment.setVariable(varName, newValue);
-            }
-            return true;
+            return "+" + postIncMatcher.group(1);
         }
-        
-        // Handle post-decrement (var--)
         Matcher postDecMatcher = POST_DECREMENT_PATTERN.matcher(trimmed);
         if (postDecMatcher.matches()) {
-            String varName = postDecMatcher.group(1);
-            Object currentValue = environment.getVariable(varName);
-            
-            if (currentValue == null) {
-                throw new RuntimeException("Undefined variable: " + varName);
-            }
-            
-            if (!(currentValue instanceof Number)) {
-                throw new RuntimeException("Cannot decrement non-numeric variable: " + varName);
-            }
-            
-            double currentNum = ((Number) currentValue).doubleValue();
-            double newValue = currentNum - 1;
-            
-            // Store the new value
-            if (currentValue instanceof Integer) {
-                environment.setVariable(varName, (int) newValue);
-            } else {
-                environment.setVariable(varName, newValue);
-            }
-            return true;
+            return "-" + postDecMatcher.group(1);
+        }
+        return null;
+    }
+
+    /**
+     * Add or subtract one from a numeric variable, keeping Int32 values integral
+     */
+    void stepVariable(String varName, boolean increment) {
+        Object currentValue = environment.getVariable(varName);
+        
+        if (currentValue == null) {
+            throw new RuntimeException("Undefined variable: " + varName);
         }
         
-        return false; // Not an increment/decrement operation
+        if (!(currentValue instanceof Number)) {
+            throw new RuntimeException("Cannot " + (increment ? "increment" : "decrement") + " non-numeric variable: " + varName);
+        }
+        
+        double currentNum = ((Number) currentValue).doubleValue();
+        double newValue = increment ? currentNum + 1 : currentNum - 1;
+        
+        // Store the new value
+        if (currentValue instanceof Integer) {
+            environment.setVariable(varName, (int) newValue);
+        } else {
+            environment.setVariable(varName, newValue);
+        }
     }
     
     /**
@@ -652,169 +614,11 @@ public class Executor {
                 throw new RuntimeException("Argument count mismatch for function: " + functionName);
             }
 
-            Environment localEnv = new Environment(environment);
+            Object[] values = new Object[args.length];
             for (int i = 0; i < args.length; i++) {
-                Object value = evaluate(args[i]);
-                String expectedType = parameters.get(i).getType();
-                // Ensure the value matches the expected type
-                switch (expectedType) {
-                    case "String":
-                    case "Int32":
-                    case "Int64":
-                    case "Float32":
-                    case "Float64":
-                        value = coerceTypedValue(expectedType, value, "Argument " + args[i]);
-                        break;
-                    case "Char":
-                        if (!(value instanceof Character)) {
-                            throw new RuntimeException("Type error: Argument " + args[i] + " is not a Character.");
-                        }
-                        break;
-                    default:
-                        throw new RuntimeException("Unknown type annotation: " + expectedType);
-                }
-                localEnv.setVariable(parameters.get(i).getName(), value);
-            }
-
-            Object returnValue = null;
-            List<String> body = function.getBody();
-            // Process function body, handling control flow structures like if/else
-            for (int i = 0; i < body.size(); i++) {
-                String line = body.get(i).trim();
-                try {
-                    // Skip empty lines and comments
-                    if (line.isEmpty() || line.startsWith("//")) {
-                        continue;
-                    }
-
-                    // Handle break/continue - they should never bubble up to function level
-                    if (line.equals("break;") || line.equals("break") ||
-                        line.equals("continue;") || line.equals("continue")) {
-                        throw new RuntimeException("Break/continue statements are only allowed inside loops");
-                    }
-                    
-                    // Handle if statements
-                    if (line.startsWith("if")) {
-                        try {
-                            // Use the Statements class to process the conditional
-                            int newIndex = Statements.processConditionalStatement(body, i, new Executor(localEnv, false));
-                            i = newIndex - 1; // -1 because the loop will increment i
-                            continue;
-                        } catch (Statements.BreakException | Statements.ContinueException e) {
-                            throw new RuntimeException("Break/continue statements are only allowed inside loops");
-                        }
-                    }
-                    
-                    // Handle for loops
-                    if (line.startsWith("for")) {
-                        int newIndex = ForLoop.processForLoop(body, i, new Executor(localEnv, true));
-                        i = newIndex - 1;
-                        continue;
-                    }
-                    
-                    // Handle while loops
-                    if (line.startsWith("while")) {
-                        int newIndex = Loop.processLoop(body, i, new Executor(localEnv, true));
-                        i = newIndex - 1;
-                        continue;
-                    }
-
-                    // Handle @map statements
-                    if (line.startsWith("@map")) {
-                        // Use the Parser to handle the @map operation
-                        Parser parser = new Parser(new ArrayList<>(), localEnv);
-                        parser.parseMapOperation(line, new Executor(localEnv));
-                        i++;
-                        continue;
-                    }
-
-                    // Handle @__globalfn__ blocks
-                    if (line.startsWith("@__globalfn__")) {
-                        // Find the closing brace for the @__globalfn__ block
-                        int endIndex = i + 1;
-                        int braceLevel = 1;
-                        
-                        while (endIndex < body.size() && braceLevel > 0) {
-                            String bodyLine = body.get(endIndex).trim();
-                            if (bodyLine.equals("{")) {
-                                braceLevel++;
-                            } else if (bodyLine.equals("}")) {
-                                braceLevel--;
-                                if (braceLevel == 0) {
-                                    break;
-                                }
-                            } else if (bodyLine.contains("{")) {
-                                braceLevel += bodyLine.chars().filter(ch -> ch == '{').count();
-                            }
-                            if (bodyLine.contains("}") && !bodyLine.equals("}")) {
-                                braceLevel -= bodyLine.chars().filter(ch -> ch == '}').count();
-                            }
-                            endIndex++;
-                        }
-                        
-                        // Process the @__globalfn__ block
-                        List<String> globalFnBlock = new ArrayList<>();
-                        for (int j = i + 1; j < endIndex; j++) {
-                            String blockLine = body.get(j).trim();
-                            if (!blockLine.equals("}") && !blockLine.isEmpty()) {
-                                globalFnBlock.add(blockLine);
-                            }
-                        }
-                        
-                        // Create a parser to handle the @__globalfn__ block with local environment
-                        Parser parser = new Parser(globalFnBlock, localEnv);
-                        parser.parseGlobalFunctionBlock(0, globalFnBlock.size());
-                        
-                        i = endIndex; // Skip to after the block
-                        continue;
-                    }
-
-                    // Handle switch statements
-                    if (line.startsWith("switch")) {
-                        // Process the switch statement
-                        int newIndex = Switch.processSwitchStatement(body, i, new Executor(localEnv, false));
-                        
-                        // Ensure we're making progress
-                        if (newIndex <= i) {
-                            throw new RuntimeException("Error processing switch statement at line: " + line);
-                        }
-                        
-                        i = newIndex - 1; // -1 because the loop will increment i
-                        continue;
-                    }
-                    
-                    // Handle return statements
-                    if (line.startsWith("return")) {
-                        String returnExpression = line.substring(line.indexOf("return") + 6).trim().replace(";", "");
-                        // Evaluate complex expressions in return statements
-                        returnValue = new Executor(localEnv).evaluate(returnExpression);
-                        // Ensure the return value matches the expected return type
-                        String expectedReturnType = function.getReturnType();
-                        switch (expectedReturnType) {
-                            case "String":
-                            case "Int32":
-                            case "Int64":
-                            case "Float32":
-                            case "Float64":
-                                returnValue = coerceTypedValue(expectedReturnType, returnValue, "Return value " + returnValue);
-                                break;
-                            case "Char":
-                                if (!(returnValue instanceof Character)) {
-                                    throw new RuntimeException("Type error: Return value " + returnValue + " is not a Character.");
-                                }
-                                break;
-                            default:
-                                throw new RuntimeException("Unknown return type annotation: " + expectedReturnType);
-                        }
-                        return returnValue; // Exit the function immediately after return
-                    }
-                    // Use a local executor to ensure variable modifications are retained
-                    new Executor(localEnv, false).execute(line); // Pass the already trimmed line
-                } catch (Statements.BreakException | Statements.ContinueException e) {
-                    throw new RuntimeException("Break/continue statements are only allowed inside loops");
-                }
+                values[i] = evaluate(args[i]);
             }
-            return returnValue;
+            return invokeFunction(function, values, args);
         }
         // Support for native functions (Import.FunctionInterface)
         Object nativeFunc = environment.getVariable(functionName);
@@ -823,7 +627,7 @@ public class Executor {
             for (int i = 0; i < evaluatedArgs.length; i++) {
                 evaluatedArgs[i] = evaluate(args[i]);
             }
-            return ((Import.FunctionInterface) nativeFunc).call(evaluatedArgs);
+            return Profiler.callNative(functionName, (Import.FunctionInterface) nativeFunc, evaluatedArgs);
         }
         // Support for higher-order functions: map, filter, foldlt, foldrt
         if (functionName.equals("map")) {
@@ -835,6 +639,13 @@ public class Executor {
             for (String s : listStr.replace("[","").replace("]","").split(",")) {
                 list.add(evaluate(s.trim()));
             }
+            // Math builtins skip the per-element lambda when the math module is imported
+            if (environment.getVariable("math::sqrt") instanceof Import.FunctionInterface) {
+                List<Object> mapped = FunctionHigherOrder.mapMath(lambda, list);
+                if (mapped != null) {
+                    return mapped;
+                }
+            }
             java.util.function.Function<Object, Object> fn = new Parser(new ArrayList<>()).makeUnaryLambda(lambda, this);
             return FunctionHigherOrder.map(fn, list);
         } else if (functionName.equals("filter")) {
@@ -870,9 +681,432 @@ public class Executor {
             java.util.function.BiFunction<Object, Object, Object> bifn = new Parser(new ArrayList<>()).makeBinaryLambda(lambda, this);
             return FunctionHigherOrder.foldrt(bifn, initial, list);
         }
+        // Parallel variants take a list variable or literal and split it across the pool
+        else if (functionName.equals("pmap")) {
+            if (args.length < 2) throw new RuntimeException("pmap expects 2 arguments: lambda, list");
+            String lambda = args[0];
+            List<Object> list = higherOrderList(functionName, args, 1);
+            if (environment.getVariable("math::sqrt") instanceof Import.FunctionInterface) {
+                List<Object> mapped = FunctionHigherOrder.mapMath(lambda, list);
+                if (mapped != null) {
+                    return mapped;
+                }
+            }
+            return FunctionHigherOrder.pmap(new Parser(new ArrayList<>()).makeUnaryLambdaWorkers(lambda, this), list);
+        } else if (functionName.equals("pfilter")) {
+            if (args.length < 2) throw new RuntimeException("pfilter expects 2 arguments: lambda, list");
+            String lambda = args[0];
+            List<Object> list = higherOrderList(functionName, args, 1);
+            return FunctionHigherOrder.pfilter(new Parser(new ArrayList<>()).makePredicateLambdaWorkers(lambda, this), list);
+        } else if (functionName.equals("preduce")) {
+            if (args.length < 3) throw new RuntimeException("preduce expects 3 arguments: lambda, initial, list");
+            String lambda = args[0];
+            Object initial = evaluate(args[1]);
+            List<Object> list = higherOrderList(functionName, args, 2);
+            return FunctionHigherOrder.preduce(new Parser(new ArrayList<>()).makeBinaryLambdaWorkers(lambda, this), initial, list);
+        }
+        throw new RuntimeException("Function not found: " + functionName);
+    }
+
+    /**
+     * The list argument of a higher-order call, starting at args[from]: a
+     * [a, b, c] literal (whose commas split it across args) or an
+     * expression that evaluates to a list
+     */
+    @SuppressWarnings("unchecked")
+    private List<Object> higherOrderList(String functionName, String[] args, int from) {
+        String listStr = String.join(", ", Arrays.copyOfRange(args, from, args.length)).trim();
+        if (listStr.startsWith("[")) {
+            List<Object> list = new ArrayList<>();
+            for (String s : listStr.replace("[","").replace("]","").split(",")) {
+                list.add(evaluate(s.trim()));
+            }
+            return list;
+        }
+        Object value = evaluate(listStr);
+        if (value instanceof List) {
+            return (List<Object>) value;
+        }
+        throw new RuntimeException(functionName + " expects a list: " + listStr);
+    }
+
+    /**
+     * Call a function with argument values that are already evaluated, as
+     * native callbacks (HTTP handlers, WebSocket messages) need to do
+     */
+    public Object callFunction(String functionName, Object... values) {
+        Function function = environment.getFunction(functionName);
+        if (function != null) {
+            if (function.getParameters().size() != values.length) {
+                throw new RuntimeException("Argument count mismatch for function: " + functionName);
+            }
+            String[] labels = new String[values.length];
+            for (int i = 0; i < values.length; i++) {
+                labels[i] = String.valueOf(values[i]);
+            }
+            return invokeFunction(function, values, labels);
+        }
+        Object nativeFunc = environment.getVariable(functionName);
+        if (nativeFunc instanceof Import.FunctionInterface) {
+            return Profiler.callNative(functionName, (Import.FunctionInterface) nativeFunc, values);
+        }
         throw new RuntimeException("Function not found: " + functionName);
     }
 
+    /**
+     * Call a user function with numeric values whose text form would
+     * evaluate back to the same numbers, skipping the format-and-reparse
+     * round trip of executeFunction
+     */
+    Object callFunctionWithValues(String functionName, Object[] values) {
+        Function function = environment.getFunction(functionName);
+        if (function == null) {
+            throw new RuntimeException("Function not found: " + functionName);
+        }
+        if (function.getParameters().size() != values.length) {
+            throw new RuntimeException("Argument count mismatch for function: " + functionName);
+        }
+        return invokeFunction(function, values, null);
+    }
+
+    /**
+     * A function's call to itself made by a return statement, left for the
+     * caller to run so tail recursion does not grow the Java stack. Scoping
+     * is dynamic and the replaced frames are gone, so only self-calls of a
+     * body that reads nothing but its own names qualify; a body that could
+     * see an earlier call's locals recurses as usual.
+     */
+    private static final class TailCall {
+        final Object[] values;
+        final String[] labels;
+
+        TailCall(Object[] values, String[] labels) {
+            this.values = values;
+            this.labels = labels;
+        }
+    }
+
+    /**
+     * Call a function: serve @memo functions from their cache, and run any
+     * self tail calls the body returns in a loop rather than by recursion.
+     * labels name each argument in type errors; when null, the labels are
+     * the text executeFunction would have been given.
+     */
+    private Object invokeFunction(Function function, Object[] values, String[] labels) {
+        List<Object> memoKey = null;
+        if (function.isMemoized()) {
+            // Key on the arguments as the body will see them, so f(2) and f(2.0) share an entry
+            Object[] coerced = new Object[values.length];
+            for (int i = 0; i < values.length; i++) {
+                coerced[i] = coerceArgument(function, values, labels, i);
+            }
+            memoKey = Arrays.asList(coerced);
+            Object cached = function.memoLookup(memoKey);
+            if (cached != null) {
+                if (Profiler.isEnabled()) {
+                    Profiler.memoHit(function.getName());
+                }
+                return cached;
+            }
+            values = coerced;
+        }
+
+        Object result = runFunction(function, values, labels);
+        if (result instanceof TailCall) {
+            result = runTailCalls(function, (TailCall) result);
+        }
+
+        if (memoKey != null && result != null) {
+            function.memoStore(memoKey, result);
+        }
+        return result;
+    }
+
+    // Each call's result is already converted by its own frame, the last one included
+    private Object runTailCalls(Function function, TailCall call) {
+        Object result = call;
+        while (result instanceof TailCall) {
+            TailCall next = (TailCall) result;
+            result = runFunction(function, next.values, next.labels);
+        }
+        return result;
+    }
+
+    /**
+     * Bind evaluated arguments to a function's parameters and run its body
+     * once. Returns the converted return value, or a TailCall when the body
+     * ended by returning a call to itself.
+     */
+    private Object runFunction(Function function, Object[] values, String[] labels) {
+        if (!Profiler.isEnabled()) {
+            return runFunctionBody(function, values, labels);
+        }
+        // Each tail call is a frame of its own, beside the call it replaced rather than inside it
+        Profiler.enter(function.getName());
+        try {
+            return runFunctionBody(function, values, labels);
+        } finally {
+            Profiler.exit();
+        }
+    }
+
+    private Object runFunctionBody(Function function, Object[] values, String[] labels) {
+        List<Parameter> parameters = function.getParameters();
+        String[] layout = function.getSlotLayout();
+        Environment localEnv = layout != null ? new Environment(environment, layout) : new Environment(environment);
+        for (int i = 0; i < values.length; i++) {
+            Object value = coerceArgument(function, values, labels, i);
+            if (layout != null) {
+                localEnv.setSlot(i, value);
+            } else {
+                localEnv.setVariable(parameters.get(i).getName(), value);
+            }
+        }
+
+        Object returnValue = null;
+        List<String> body = function.getBody();
+        // One executor per context for the whole call; they carry no per-statement state
+        Executor blockExecutor = new Executor(localEnv, false, function);
+        Executor loopExecutor = null;
+        // Process function body, handling control flow structures like if/else
+        for (int i = 0; i < body.size(); i++) {
+            String line = body.get(i).trim();
+            try {
+                // Skip empty lines and comments
+                if (line.isEmpty() || line.startsWith("//")) {
+                    continue;
+                }
+
+                // Handle break/continue - they should never bubble up to function level
+                if (line.equals("break;") || line.equals("break") ||
+                    line.equals("continue;") || line.equals("continue")) {
+                    throw new RuntimeException("Break/continue statements are only allowed inside loops");
+                }
+                
+                // Handle if statements
+                if (line.startsWith("if")) {
+                    try {
+                        // Use the Statements class to process the conditional
+                        int newIndex = Statements.processConditionalStatement(body, i, blockExecutor);
+                        i = newIndex - 1; // -1 because the loop will increment i
+                        continue;
+                    } catch (Statements.BreakException | Statements.ContinueException e) {
+                        throw new RuntimeException("Break/continue statements are only allowed inside loops");
+                    }
+                }
+                
+                // Handle for loops
+                if (line.startsWith("for")) {
+                    if (loopExecutor == null) {
+                        loopExecutor = new Executor(localEnv, true, function);
+                    }
+                    int newIndex = ForLoop.processForLoop(body, i, loopExecutor);
+                    i = newIndex - 1;
+                    continue;
+                }
+                
+                // Handle while loops
+                if (line.startsWith("while")) {
+                    if (loopExecutor == null) {
+                        loopExecutor = new Executor(localEnv, true, function);
+                    }
+                    int newIndex = Loop.processLoop(body, i, loopExecutor);
+                    i = newIndex - 1;
+                    continue;
+                }
+
+                // Handle @map and @pmap statements
+                if (line.startsWith("@map") || line.startsWith("@pmap")) {
+                    // Use the Parser to handle the @map operation
+                    Parser parser = new Parser(new ArrayList<>(), localEnv);
+                    parser.parseMapOperation(line, blockExecutor);
+                    i++;
+                    continue;
+                }
+
+                // Handle @__globalfn__ blocks
+                if (line.startsWith("@__globalfn__")) {
+                    // Find the closing brace for the @__globalfn__ block
+                    int endIndex = i + 1;
+                    int braceLevel = 1;
+                    
+                    while (endIndex < body.size() && braceLevel > 0) {
+                        String bodyLine = body.get(endIndex).trim();
+                        if (bodyLine.equals("{")) {
+                            braceLevel++;
+                        } else if (bodyLine.equals("}")) {
+                            braceLevel--;
+                            if (braceLevel == 0) {
+                                break;
+                            }
+                        } else if (bodyLine.contains("{")) {
+                            braceLevel += bodyLine.chars().filter(ch -> ch == '{').count();
+                        }
+                        if (bodyLine.contains("}") && !bodyLine.equals("}")) {
+                            braceLevel -= bodyLine.chars().filter(ch -> ch == '}').count();
+                        }
+                        endIndex++;
+                    }
+                    
+                    // Process the @__globalfn__ block
+                    List<String> globalFnBlock = new ArrayList<>();
+                    for (int j = i + 1; j < endIndex; j++) {
+                        String blockLine = body.get(j).trim();
+                        if (!blockLine.equals("}") && !blockLine.isEmpty()) {
+                            globalFnBlock.add(blockLine);
+                        }
+                    }
+                    
+                    // Create a parser to handle the @__globalfn__ block with local environment
+                    Parser parser = new Parser(globalFnBlock, localEnv);
+                    parser.parseGlobalFunctionBlock(0, globalFnBlock.size());
+                    
+                    i = endIndex; // Skip to after the block
+                    continue;
+                }
+
+                // Handle switch statements
+                if (line.startsWith("switch")) {
+                    // Process the switch statement
+                    int newIndex = Switch.processSwitchStatement(body, i, blockExecutor);
+                    
+                    // Ensure we're making progress
+                    if (newIndex <= i) {
+                        throw new RuntimeException("Error processing switch statement at line: " + line);
+                    }
+                    
+                    i = newIndex - 1; // -1 because the loop will increment i
+                    continue;
+                }
+                
+                // Handle return statements
+                if (line.startsWith("return")) {
+                    // Evaluate complex expressions in return statements
+                    returnValue = blockExecutor.returnResult(line);
+                    if (returnValue instanceof TailCall) {
+                        return returnValue;
+                    }
+                    return coerceReturn(function, returnValue); // Exit the function immediately after return
+                }
+                // Use a local executor to ensure variable modifications are retained
+                blockExecutor.execute(line); // Pass the already trimmed line
+            } catch (Statements.ReturnException e) {
+                // A return inside an if, loop or switch of the body
+                Object value = e.getValue();
+                return value instanceof TailCall ? value : coerceReturn(function, value);
+            } catch (Statements.BreakException | Statements.ContinueException e) {
+                throw new RuntimeException("Break/continue statements are only allowed inside loops");
+            }
+        }
+        return returnValue;
+    }
+
+    // Ensure argument i matches its parameter's type annotation
+    private Object coerceArgument(Function function, Object[] values, String[] labels, int i) {
+        Object value = values[i];
+        String expectedType = function.getParameters().get(i).getType();
+        switch (expectedType) {
+            case "String":
+            case "Int32":
+            case "Int64":
+            case "Float32":
+            case "Float64":
+                Object exact = coerceExact(expectedType, value);
+                return exact != null ? exact : coerceTypedValue(expectedType, value, "Argument " + argumentLabel(values, labels, i));
+            case "Char":
+                if (!(value instanceof Character)) {
+                    throw new RuntimeException("Type error: Argument " + argumentLabel(values, labels, i) + " is not a Character.");
+                }
+                return value;
+            default:
+                throw new RuntimeException("Unknown type annotation: " + expectedType);
+        }
+    }
+
+    // Ensure the return value matches the expected return type
+    private Object coerceReturn(Function function, Object returnValue) {
+        String expectedReturnType = function.getReturnType();
+        switch (expectedReturnType) {
+            case "String":
+            case "Int32":
+            case "Int64":
+            case "Float32":
+            case "Float64":
+                Object exact = coerceExact(expectedReturnType, returnValue);
+                return exact != null ? exact : coerceTypedValue(expectedReturnType, returnValue, "Return value " + returnValue);
+            case "Char":
+                if (!(returnValue instanceof Character)) {
+                    throw new RuntimeException("Type error: Return value " + returnValue + " is not a Character.");
+                }
+                return returnValue;
+            case "void":
+                // Untyped functions return their value unconverted
+                return returnValue;
+            default:
+                throw new RuntimeException("Unknown return type annotation: " + expectedReturnType);
+        }
+    }
+
+    /**
+     * The result of a return statement: the value of its expression, or a
+     * TailCall when the expression is exactly one call to the non-memoized
+     * function this executor is running, and that function's body reads only
+     * its own names. The call's arguments are evaluated here, as
+     * executeFunction would, so only the body runs later.
+     */
+    private Object returnResult(String line) {
+        String returnExpression = line.substring(line.indexOf("return") + 6).trim().replace(";", "");
+        TailCall call = tailCall(returnExpression);
+        return call != null ? call : evaluate(returnExpression);
+    }
+
+    private TailCall tailCall(String expression) {
+        Matcher matcher = FUNCTION_CALL_PATTERN.matcher(expression);
+        if (!isSingleCall(matcher, expression)) {
+            return null;
+        }
+        Function function = currentFunction;
+        if (function == null || function.isMemoized() || !function.readsOwnNamesOnly()
+                || environment.getFunction(matcher.group(1)) != function) {
+            return null;
+        }
+        String args = matcher.group(2).trim();
+        String[] arguments = args.isEmpty() ? new String[0] : splitByCommaWithTrim(args).toArray(new String[0]);
+        if (function.getParameters().size() != arguments.length) {
+            return null; // let executeFunction report the mismatch
+        }
+        Object[] values = new Object[arguments.length];
+        for (int i = 0; i < arguments.length; i++) {
+            values[i] = evaluate(arguments[i]);
+        }
+        return new TailCall(values, arguments);
+    }
+
+    /**
+     * Whether the expression is one call, name(args). FUNCTION_CALL_PATTERN
+     * alone also matches f(a) + f(b), reading "a) + f(b" as the arguments.
+     */
+    static boolean isSingleCall(Matcher matcher, String expression) {
+        return matcher.matches() && closingParenthesis(expression, matcher.end(1)) == expression.length() - 1;
+    }
+
+    // Index of the parenthesis closing the one at open, or -1
+    private static int closingParenthesis(String text, int open) {
+        int depth = 0;
+        boolean inString = false;
+        for (int i = open; i < text.length(); i++) {
+            char c = text.charAt(i);
+            if (c == '"') {
+                inString = !inString;
+            } else if (!inString && c == '(') {
+                depth++;
+            } else if (!inString && c == ')' && --depth == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
     public Object evaluate(String expression) {
         // Skip empty expressions
         if (expression == null || expression.trim().isEmpty()) {
@@ -891,7 +1125,7 @@ public class Executor {
 
         // Check if the expression is a function call
         Matcher matcher = FUNCTION_CALL_PATTERN.matcher(expression);
-        if (matcher.matches()) {
+        if (isSingleCall(matcher, expression)) {
             String functionName = matcher.group(1);
             String args = matcher.group(2).trim();
             String[] arguments = args.isEmpty() ? new String[0] : splitByCommaWithTrim(args).toArray(new String[0]);
@@ -918,7 +1152,7 @@ public class Executor {
             String argStr = expression.substring("math::sqrt(".length(), expression.length() - 1);
             double arg = Double.parseDouble(argStr);
             Import.FunctionInterface sqrtFunc = (Import.FunctionInterface) environment.getVariable("math::sqrt");
-            return sqrtFunc.call(new Object[]{arg});
+            return Profiler.callNative("math::sqrt", sqrtFunc, new Object[]{arg});
         }
         
         // Check for member access (struct field access): varName.fieldName
@@ -995,9 +1229,52 @@ public class Executor {
             }
         }
 
-        // Otherwise, treat it as an arithmetic expression
-        ExpressionEvaluator evaluator = new ExpressionEvaluator(expression, environment);
-        return evaluator.parse();
+        // Otherwise, treat it as an arithmetic expression, compiled once per distinct string
+        return ExpressionCompiler.evaluate(expression, environment);
+    }
+
+    private static String argumentLabel(Object[] values, String[] labels, int i) {
+        return labels != null ? labels[i] : ExpressionCompiler.formatArgument(values[i]);
+    }
+
+    /**
+     * The result coerceTypedValue would give for values that need no
+     * tolerance or range handling, or null to take the general path. Hot
+     * calls with already-typed numbers then skip building the error subject
+     * and the double round trip.
+     */
+    private static Object coerceExact(String typeAnnotation, Object value) {
+        switch (typeAnnotation) {
+            case "String":
+                return value instanceof String ? value : null;
+            case "Int32":
+                if (value instanceof Integer) {
+                    return value;
+                }
+                if (value instanceof Double) {
+                    double d = (Double) value;
+                    if ((int) d == d) {
+                        return (int) d;
+                    }
+                }
+                return null;
+            case "Int64":
+                // Long values stay on the general path, which rounds them through double
+                if (value instanceof Integer) {
+                    return (long) (Integer) value;
+                }
+                if (value instanceof Double) {
+                    double d = (Double) value;
+                    if ((long) d == d) {
+                        return (long) d;
+                    }
+                }
+                return null;
+            case "Float64":
+                return value instanceof Double ? value : null;
+            default:
+                return null;
+        }
     }
 
     private Object coerceTypedValue(String typeAnnotation, Object value, String subject) {
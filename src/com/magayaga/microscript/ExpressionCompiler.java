@@ -0,0 +1,1020 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * It was originally written in Java programming language.
+ */
+package com.magayaga.microscript;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.ConcurrentHashMap;
+
+/**
+ * Compiles expression strings into reusable node trees. ExpressionEvaluator
+ * parses and evaluates in one pass, so a loop body re-scans the same text on
+ * every iteration; here each distinct string is parsed once and the tree is
+ * evaluated against whatever Environment is current.
+ *
+ * The grammar and evaluation order follow ExpressionEvaluator exactly,
+ * including its quirks: both ternary branches and both sides of && and ||
+ * are evaluated, and only numbers and parenthesized factors take a ^
+ * suffix. Anything the compiler rejects is remembered and handed to
+ * ExpressionEvaluator, which produces the same result or error as before.
+ */
+public class ExpressionCompiler {
+    /**
+     * A compiled expression. Nodes hold no per-evaluation state, only
+     * immutable slot resolutions, so a tree can be shared by concurrent
+     * HTTP workers.
+     */
+    public interface Node {
+        Object evaluate(Environment environment);
+
+        /**
+         * The value as a double, for numeric contexts. Arithmetic nodes
+         * override this to combine their operands without boxing, so a
+         * chain like i * i + x allocates at most the final Double.
+         */
+        default double evaluateNumber(Environment environment) {
+            return ExpressionEvaluator.objectToDouble(evaluate(environment));
+        }
+
+        /**
+         * True if evaluate always returns a Double, so converting the
+         * result can never fail
+         */
+        default boolean isNumeric() {
+            return false;
+        }
+    }
+
+    // Bounded so scripts that build many distinct strings cannot grow it forever
+    private static final int MAX_CACHED = 4096;
+    private static final ConcurrentHashMap<String, Node> CACHE = new ConcurrentHashMap<>();
+    private static final Node UNSUPPORTED = environment -> null;
+
+    private final String expression;
+    private int pos = -1;
+    private int ch;
+
+    private ExpressionCompiler(String expression) {
+        this.expression = expression;
+    }
+
+    /**
+     * Evaluate an expression through the cache, falling back to
+     * ExpressionEvaluator for text the compiler does not accept
+     */
+    public static Object evaluate(String expression, Environment environment) {
+        Node node = compile(expression);
+        if (node == null) {
+            return new ExpressionEvaluator(expression, environment).parse();
+        }
+        return node.evaluate(environment);
+    }
+
+    /**
+     * The compiled tree for an expression, or null if it must be interpreted
+     */
+    public static Node compile(String expression) {
+        Node node = CACHE.get(expression);
+        if (node == null) {
+            try {
+                node = new ExpressionCompiler(expression).parse();
+            } catch (UnsupportedException e) {
+                node = UNSUPPORTED;
+            }
+            if (CACHE.size() >= MAX_CACHED) {
+                CACHE.clear();
+            }
+            CACHE.put(expression, node);
+        }
+        return node == UNSUPPORTED ? null : node;
+    }
+
+    // Thrown for any text ExpressionEvaluator would reject while parsing
+    private static final class UnsupportedException extends RuntimeException {
+        UnsupportedException() {
+            super(null, null, false, false);
+        }
+    }
+
+    private static UnsupportedException unsupported() {
+        return new UnsupportedException();
+    }
+
+    private Node parse() {
+        nextChar();
+        skipWhitespace();
+
+        Node increment = parseIncrementDecrement();
+        if (increment != null) {
+            return increment;
+        }
+
+        pos = -1;
+        nextChar();
+        skipWhitespace();
+
+        Node x = parseAssignment();
+        skipWhitespace();
+        if (pos < expression.length()) throw unsupported();
+        return x;
+    }
+
+    // Statement form "name++" or "name--", optionally followed by ';'
+    private Node parseIncrementDecrement() {
+        int savedPos = pos;
+        int savedCh = ch;
+
+        String variable = parseIdentifierChars();
+        skipWhitespace();
+
+        if (ch == '+' || ch == '-') {
+            int sign = ch;
+            nextChar();
+            if (ch == sign) {
+                nextChar();
+                skipWhitespace();
+                if (pos >= expression.length() || ch == ';') {
+                    return new Step(variable, sign == '+', true);
+                }
+            }
+        }
+
+        pos = savedPos;
+        ch = savedCh;
+        return null;
+    }
+
+    private Node parseAssignment() {
+        int savedPos = pos;
+        int savedCh = ch;
+
+        String variable = parseIdentifierChars();
+        skipWhitespace();
+
+        char op = 0;
+        if (ch == ':' || ch == '+' || ch == '-' || ch == '*' || ch == '/') {
+            char candidate = (char) ch;
+            nextChar();
+            if (ch == '=') {
+                op = candidate;
+                nextChar();
+                skipWhitespace();
+            }
+        }
+
+        if (op == 0) {
+            pos = savedPos;
+            ch = savedCh;
+            return parseTernary();
+        }
+
+        Node right = parseAssignment();
+        return op == ':' ? new Walrus(variable, right) : new CompoundAssignment(variable, op, right);
+    }
+
+    private Node parseTernary() {
+        Node condition = parseLogicalOr();
+        skipWhitespace();
+
+        if (ch == '?') {
+            nextChar();
+            skipWhitespace();
+            Node trueValue = parseExpression();
+            skipWhitespace();
+            if (ch != ':') throw unsupported();
+            nextChar();
+            skipWhitespace();
+            Node falseValue = parseExpression();
+            return new Ternary(condition, trueValue, falseValue);
+        }
+
+        return condition;
+    }
+
+    private Node parseLogicalOr() {
+        Node left = parseLogicalAnd();
+        skipWhitespace();
+
+        while (ch == '|') {
+            nextChar();
+            if (ch != '|') throw unsupported();
+            nextChar();
+            skipWhitespace();
+            left = new Logical(left, parseLogicalAnd(), false);
+            skipWhitespace();
+        }
+
+        return left;
+    }
+
+    private Node parseLogicalAnd() {
+        Node left = parseComparison();
+        skipWhitespace();
+
+        while (ch == '&') {
+            nextChar();
+            if (ch != '&') throw unsupported();
+            nextChar();
+            skipWhitespace();
+            left = new Logical(left, parseComparison(), true);
+            skipWhitespace();
+        }
+
+        return left;
+    }
+
+    // A single, non-chaining comparison, as in ExpressionEvaluator
+    private Node parseComparison() {
+        Node x = parseExpression();
+        skipWhitespace();
+
+        int op;
+        if (ch == '<') {
+            nextChar();
+            if (ch == '=') {
+                nextChar();
+                if (ch == '>') {
+                    nextChar();
+                    op = Comparison.SPACESHIP;
+                } else {
+                    op = Comparison.LE;
+                }
+            } else {
+                op = Comparison.LT;
+            }
+        } else if (ch == '>') {
+            nextChar();
+            if (ch == '=') {
+                nextChar();
+                op = Comparison.GE;
+            } else {
+                op = Comparison.GT;
+            }
+        } else if (ch == '=' || ch == '!') {
+            boolean equal = ch == '=';
+            nextChar();
+            if (ch != '=') throw unsupported();
+            nextChar();
+            op = equal ? Comparison.EQ : Comparison.NE;
+        } else {
+            return x;
+        }
+
+        skipWhitespace();
+        return new Comparison(x, parseExpression(), op);
+    }
+
+    private Node parseExpression() {
+        Node x = parseTerm();
+        skipWhitespace();
+        while (ch == '+' || ch == '-') {
+            char op = (char) ch;
+            nextChar();
+            skipWhitespace();
+            x = new Arithmetic(x, parseTerm(), op);
+            skipWhitespace();
+        }
+        return x;
+    }
+
+    private Node parseTerm() {
+        Node x = parseFactor();
+        skipWhitespace();
+        while (ch == '*' || ch == '/' || ch == '#' || ch == '%') {
+            char op = (char) ch;
+            nextChar();
+            skipWhitespace();
+            x = new Arithmetic(x, parseFactor(), op);
+            skipWhitespace();
+        }
+        return x;
+    }
+
+    private Node parseFactor() {
+        skipWhitespace();
+
+        if (ch == '!') {
+            if (peek() == '=') throw unsupported();
+            nextChar();
+            skipWhitespace();
+            return new Not(parseFactor());
+        }
+
+        if (ch == '+' || ch == '-') {
+            boolean plus = ch == '+';
+            if (peek() == ch) {
+                nextChar();
+                nextChar();
+                skipWhitespace();
+                return new Step(parseIdentifierChars(), plus, false);
+            }
+            nextChar();
+            skipWhitespace();
+            Node factor = parseFactor();
+            return plus ? factor : new Negate(factor); // unary plus passes the value through
+        }
+
+        Node x;
+        int startPos = pos;
+        if (ch == '(') {
+            nextChar();
+            skipWhitespace();
+            x = parseAssignment();
+            skipWhitespace();
+            if (ch != ')') throw unsupported();
+            nextChar();
+            skipWhitespace();
+        } else if ((ch >= '0' && ch <= '9') || ch == '.') {
+            while ((ch >= '0' && ch <= '9') || ch == '.') nextChar();
+            try {
+                x = new Constant(Double.parseDouble(expression.substring(startPos, pos)));
+            } catch (NumberFormatException e) {
+                throw unsupported();
+            }
+            skipWhitespace();
+        } else if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_') {
+            // Identifiers never take a ^ suffix in ExpressionEvaluator
+            return parseIdentifier();
+        } else {
+            throw unsupported();
+        }
+
+        skipWhitespace();
+        if (ch == '^') {
+            nextChar();
+            skipWhitespace();
+            x = new Arithmetic(x, parseFactor(), '^');
+            skipWhitespace();
+        }
+        return x;
+    }
+
+    private Node parseIdentifier() {
+        String identifier = parseIdentifierChars();
+        skipWhitespace();
+
+        if ((ch == '+' || ch == '-') && peek() == ch) {
+            boolean plus = ch == '+';
+            nextChar();
+            nextChar();
+            skipWhitespace();
+            return new Step(identifier, plus, true);
+        }
+
+        if (ch == ':') {
+            nextChar();
+            if (ch == ':') {
+                nextChar();
+                skipWhitespace();
+                String fullName = identifier + "::" + parseIdentifierChars();
+                skipWhitespace();
+                if (ch == '(') {
+                    return new ModuleCall(fullName, parseArguments());
+                }
+                return new ModuleValue(fullName);
+            }
+            pos--;
+            ch = expression.charAt(pos);
+        }
+
+        if (ch == '(') {
+            return new Call(identifier, parseArguments());
+        }
+
+        if (ch == '[') {
+            nextChar();
+            skipWhitespace();
+            Node index = parseAssignment();
+            skipWhitespace();
+            if (ch != ']') throw unsupported();
+            nextChar();
+            skipWhitespace();
+            return new Element(identifier, index);
+        }
+
+        return new Variable(identifier);
+    }
+
+    private Node[] parseArguments() {
+        nextChar(); // consume (
+        skipWhitespace();
+        List<Node> args = new ArrayList<>();
+        if (ch != ')') {
+            while (true) {
+                args.add(parseAssignment());
+                skipWhitespace();
+                if (ch == ')') {
+                    nextChar();
+                    break;
+                }
+                if (ch != ',') throw unsupported();
+                nextChar();
+                skipWhitespace();
+            }
+        } else {
+            nextChar();
+        }
+        skipWhitespace();
+        return args.toArray(new Node[0]);
+    }
+
+    private String parseIdentifierChars() {
+        int start = pos;
+        while ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+               (ch >= '0' && ch <= '9') || ch == '_') {
+            nextChar();
+        }
+        return expression.substring(start, Math.min(pos, expression.length()));
+    }
+
+    private int peek() {
+        return pos + 1 < expression.length() ? expression.charAt(pos + 1) : -1;
+    }
+
+    private void nextChar() {
+        ch = (++pos < expression.length()) ? expression.charAt(pos) : -1;
+    }
+
+    private void skipWhitespace() {
+        while (pos < expression.length() &&
+               (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n')) {
+            nextChar();
+        }
+    }
+
+    /**
+     * A variable name bound to a slot of the innermost frame. Frames of the
+     * same function share one layout array, so the slot index is resolved
+     * once per layout and reused until a frame with another layout shows up.
+     */
+    private static final class Reference {
+        private final String name;
+        private volatile Resolution resolution;
+
+        Reference(String name) {
+            this.name = name;
+        }
+
+        private int slot(Environment environment) {
+            String[] layout = environment.getLayout();
+            Resolution r = resolution;
+            if (r == null || r.layout != layout) {
+                int index = -1;
+                for (int i = 0; i < layout.length; i++) {
+                    if (layout[i].equals(name)) {
+                        index = i;
+                        break;
+                    }
+                }
+                r = new Resolution(layout, index);
+                resolution = r;
+            }
+            return r.index;
+        }
+
+        // Same result as Environment.getVariable
+        Object get(Environment environment) {
+            int slot = slot(environment);
+            if (slot >= 0) {
+                Object value = environment.getSlot(slot);
+                if (value != null) {
+                    return value;
+                }
+            }
+            return environment.getVariable(name);
+        }
+
+        Object require(Environment environment) {
+            Object value = get(environment);
+            if (value == null) {
+                throw new RuntimeException("Undefined variable: " + name);
+            }
+            return value;
+        }
+
+        // Same effect as Environment.setVariable
+        void set(Environment environment, Object value) {
+            int slot = slot(environment);
+            if (slot >= 0) {
+                environment.setSlot(slot, value);
+            } else {
+                environment.setVariable(name, value);
+            }
+        }
+    }
+
+    private static final class Resolution {
+        final String[] layout;
+        final int index;
+
+        Resolution(String[] layout, int index) {
+            this.layout = layout;
+            this.index = index;
+        }
+    }
+
+    private static Object[] evaluateAll(Node[] nodes, Environment environment) {
+        Object[] values = new Object[nodes.length];
+        for (int i = 0; i < nodes.length; i++) {
+            values[i] = nodes[i].evaluate(environment);
+        }
+        return values;
+    }
+
+    private static final class Constant implements Node {
+        private final double number;
+        private final Double value;
+
+        Constant(double number) {
+            this.number = number;
+            this.value = number;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            return value;
+        }
+
+        @Override
+        public double evaluateNumber(Environment environment) {
+            return number;
+        }
+
+        @Override
+        public boolean isNumeric() {
+            return true;
+        }
+    }
+
+    private static final class Variable implements Node {
+        private final Reference variable;
+
+        Variable(String name) {
+            this.variable = new Reference(name);
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            return variable.require(environment);
+        }
+    }
+
+    // list[index]
+    private static final class Element implements Node {
+        private final String name;
+        private final Reference variable;
+        private final Node index;
+
+        Element(String name, Node index) {
+            this.name = name;
+            this.variable = new Reference(name);
+            this.index = index;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            Object value = variable.require(environment);
+            if (!(value instanceof ListVariable)) {
+                throw new RuntimeException("Cannot use array access on non-list variable: " + name);
+            }
+
+            Object indexValue = index.evaluate(environment);
+            if (!(indexValue instanceof Number)) {
+                throw new RuntimeException("Array index must be a number, got: " + indexValue);
+            }
+
+            ListVariable list = (ListVariable) value;
+            int i = ((Number) indexValue).intValue();
+            if (i < 0 || i >= list.size()) {
+                throw new RuntimeException("Array index out of bounds: " + i + " (size: " + list.size() + ")");
+            }
+            return list.get(i);
+        }
+    }
+
+    // ++name, --name, name++ and name--
+    private static final class Step implements Node {
+        private final String name;
+        private final Reference variable;
+        private final boolean increment;
+        private final boolean postfix;
+
+        Step(String name, boolean increment, boolean postfix) {
+            this.name = name;
+            this.variable = new Reference(name);
+            this.increment = increment;
+            this.postfix = postfix;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            Object currentValue = variable.require(environment);
+            if (!(currentValue instanceof Number)) {
+                throw new RuntimeException("Cannot " + (increment ? "increment" : "decrement") + " non-numeric variable: " + name);
+            }
+
+            double currentNum = ((Number) currentValue).doubleValue();
+            double newValue = increment ? currentNum + 1 : currentNum - 1;
+            double result = postfix ? currentNum : newValue;
+            if (currentValue instanceof Integer) {
+                variable.set(environment, (int) newValue);
+                return (int) result;
+            }
+            variable.set(environment, newValue);
+            return result;
+        }
+    }
+
+    private static final class Walrus implements Node {
+        private final Reference variable;
+        private final Node value;
+
+        Walrus(String name, Node value) {
+            this.variable = new Reference(name);
+            this.value = value;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            Object rightValue = value.evaluate(environment);
+            variable.set(environment, rightValue);
+            return rightValue;
+        }
+    }
+
+    // +=, -=, *= and /=
+    private static final class CompoundAssignment implements Node {
+        private final String name;
+        private final Reference variable;
+        private final char op;
+        private final Node value;
+
+        CompoundAssignment(String name, char op, Node value) {
+            this.name = name;
+            this.variable = new Reference(name);
+            this.op = op;
+            this.value = value;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            // A numeric right-hand side cannot fail to convert, so it is taken unboxed
+            boolean numeric = value.isNumeric();
+            double rightNum = numeric ? value.evaluateNumber(environment) : 0.0;
+            Object rightValue = numeric ? null : value.evaluate(environment);
+            Object currentValue = variable.get(environment);
+            if (currentValue == null) {
+                throw new RuntimeException("Undefined variable for compound assignment: " + name);
+            }
+
+            double currentNum = ExpressionEvaluator.objectToDouble(currentValue);
+            if (!numeric) {
+                rightNum = ExpressionEvaluator.objectToDouble(rightValue);
+            }
+            double result;
+            switch (op) {
+                case '+':
+                    result = currentNum + rightNum;
+                    break;
+                case '-':
+                    result = currentNum - rightNum;
+                    break;
+                case '*':
+                    result = currentNum * rightNum;
+                    break;
+                default:
+                    if (Math.abs(rightNum) < 0.0001) {
+                        throw new RuntimeException("Division by zero in compound assignment");
+                    }
+                    result = currentNum / rightNum;
+                    break;
+            }
+
+            Object finalValue;
+            if (currentValue instanceof Integer && result == Math.floor(result)) {
+                finalValue = (int) result;
+            } else {
+                finalValue = result;
+            }
+            variable.set(environment, finalValue);
+            return finalValue;
+        }
+    }
+
+    // Both branches are evaluated, as in ExpressionEvaluator
+    private static final class Ternary implements Node {
+        private final Node condition;
+        private final Node trueValue;
+        private final Node falseValue;
+
+        Ternary(Node condition, Node trueValue, Node falseValue) {
+            this.condition = condition;
+            this.trueValue = trueValue;
+            this.falseValue = falseValue;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            Object cond = condition.evaluate(environment);
+            Object t = trueValue.evaluate(environment);
+            Object f = falseValue.evaluate(environment);
+            return ExpressionEvaluator.isTruthy(cond) ? t : f;
+        }
+    }
+
+    // && and ||; both operands are always evaluated
+    private static final class Logical implements Node {
+        private final Node left;
+        private final Node right;
+        private final boolean and;
+
+        Logical(Node left, Node right, boolean and) {
+            this.left = left;
+            this.right = right;
+            this.and = and;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            boolean l = ExpressionEvaluator.isTruthy(left.evaluate(environment));
+            boolean r = ExpressionEvaluator.isTruthy(right.evaluate(environment));
+            return and ? l && r : l || r;
+        }
+    }
+
+    private static final class Not implements Node {
+        private final Node operand;
+
+        Not(Node operand) {
+            this.operand = operand;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            return !ExpressionEvaluator.isTruthy(operand.evaluate(environment));
+        }
+    }
+
+    private static final class Negate implements Node {
+        private final Node operand;
+
+        Negate(Node operand) {
+            this.operand = operand;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            return evaluateNumber(environment);
+        }
+
+        @Override
+        public double evaluateNumber(Environment environment) {
+            return -operand.evaluateNumber(environment);
+        }
+
+        @Override
+        public boolean isNumeric() {
+            return true;
+        }
+    }
+
+    /**
+     * Two operands converted to doubles. ExpressionEvaluator evaluates both
+     * operands before converting either, so a conversion error on the left
+     * wins over side effects on the right. An operand that is numeric
+     * cannot fail to convert and is combined unboxed; the others keep their
+     * evaluate-then-convert order.
+     */
+    private abstract static class NumericOperands implements Node {
+        final Node left;
+        final Node right;
+
+        NumericOperands(Node left, Node right) {
+            this.left = left;
+            this.right = right;
+        }
+
+        abstract double combine(double l, double r);
+
+        final double apply(Environment environment) {
+            if (left.isNumeric()) {
+                double l = left.evaluateNumber(environment);
+                return combine(l, right.evaluateNumber(environment));
+            }
+            Object leftObj = left.evaluate(environment);
+            if (right.isNumeric()) {
+                double r = right.evaluateNumber(environment);
+                return combine(ExpressionEvaluator.objectToDouble(leftObj), r);
+            }
+            Object rightObj = right.evaluate(environment);
+            double l = ExpressionEvaluator.objectToDouble(leftObj);
+            return combine(l, ExpressionEvaluator.objectToDouble(rightObj));
+        }
+    }
+
+    private static final class Comparison extends NumericOperands {
+        static final int LT = 0;
+        static final int LE = 1;
+        static final int GT = 2;
+        static final int GE = 3;
+        static final int EQ = 4;
+        static final int NE = 5;
+        static final int SPACESHIP = 6;
+
+        private final int op;
+
+        Comparison(Node left, Node right, int op) {
+            super(left, right);
+            this.op = op;
+        }
+
+        // 1.0 for true and 0.0 for false, except for <=>
+        @Override
+        double combine(double l, double r) {
+            switch (op) {
+                case LT: return l < r ? 1.0 : 0.0;
+                case LE: return l <= r ? 1.0 : 0.0;
+                case GT: return l > r ? 1.0 : 0.0;
+                case GE: return l >= r ? 1.0 : 0.0;
+                case EQ: return Math.abs(l - r) < 0.0001 ? 1.0 : 0.0;
+                case NE: return Math.abs(l - r) >= 0.0001 ? 1.0 : 0.0;
+                default: return Double.compare(l, r);
+            }
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            double result = apply(environment);
+            if (op == SPACESHIP) {
+                return result;
+            }
+            return result != 0.0;
+        }
+
+        @Override
+        public double evaluateNumber(Environment environment) {
+            return apply(environment);
+        }
+    }
+
+    // + - * / # % and ^ over doubles
+    private static final class Arithmetic extends NumericOperands {
+        private final char op;
+
+        Arithmetic(Node left, Node right, char op) {
+            super(left, right);
+            this.op = op;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            return apply(environment); // the only box in a numeric chain
+        }
+
+        @Override
+        public double evaluateNumber(Environment environment) {
+            return apply(environment);
+        }
+
+        @Override
+        public boolean isNumeric() {
+            return true;
+        }
+
+        @Override
+        double combine(double l, double r) {
+            switch (op) {
+                case '+': return l + r;
+                case '-': return l - r;
+                case '*': return l * r;
+                case '^': return Math.pow(l, r);
+                default:
+                    if (Math.abs(r) < 0.0001) {
+                        throw new RuntimeException("Division by zero");
+                    }
+                    if (op == '/') return l / r;
+                    if (op == '#') return Math.floor(l / r);
+                    return l % r;
+            }
+        }
+    }
+
+    // module::name without a call: a module constant such as math::PI
+    private static final class ModuleValue implements Node {
+        private final String fullName;
+
+        ModuleValue(String fullName) {
+            this.fullName = fullName;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            Object value = environment.getVariable(fullName);
+            if (value == null) {
+                throw new RuntimeException("Expected '(' after module function " + fullName);
+            }
+            return value;
+        }
+    }
+
+    private static final class ModuleCall implements Node {
+        private final String fullName;
+        private final Node[] args;
+
+        ModuleCall(String fullName, Node[] args) {
+            this.fullName = fullName;
+            this.args = args;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            Object[] values = evaluateAll(args, environment);
+
+            Object moduleFunc = environment.getVariable(fullName);
+            if (moduleFunc instanceof Import.FunctionInterface) {
+                return Profiler.callNative(fullName, (Import.FunctionInterface) moduleFunc, values);
+            }
+
+            if (environment.getFunction(fullName) != null) {
+                String[] argStrings = new String[values.length];
+                for (int i = 0; i < values.length; i++) {
+                    argStrings[i] = values[i].toString();
+                }
+                return new Executor(environment).executeFunction(fullName, argStrings);
+            }
+
+            throw new RuntimeException("Unknown module function: " + fullName);
+        }
+    }
+
+    private static final class Call implements Node {
+        private final String name;
+        private final Node[] args;
+
+        Call(String name, Node[] args) {
+            this.name = name;
+            this.args = args;
+        }
+
+        @Override
+        public Object evaluate(Environment environment) {
+            Object[] values = evaluateAll(args, environment);
+
+            if (environment.getFunction(name) == null) {
+                throw new RuntimeException("Function not found: " + name);
+            }
+
+            Executor executor = new Executor(environment);
+            boolean direct = true;
+            for (Object value : values) {
+                direct &= roundTrips(value);
+            }
+            if (direct) {
+                return executor.callFunctionWithValues(name, values);
+            }
+
+            // Arguments are re-evaluated from text by executeFunction
+            String[] argStrings = new String[values.length];
+            for (int i = 0; i < values.length; i++) {
+                argStrings[i] = formatArgument(values[i]);
+            }
+            return executor.executeFunction(name, argStrings);
+        }
+    }
+
+    /**
+     * The text passed to executeFunction for an argument value; integral
+     * doubles drop their fraction
+     */
+    static String formatArgument(Object arg) {
+        if (arg instanceof Double) {
+            double d = (Double) arg;
+            if (d == Math.floor(d)) {
+                return String.format("%.0f", d);
+            }
+        }
+        return arg.toString();
+    }
+
+    // True if evaluating formatArgument(value) yields the same number, so a
+    // call can pass the value itself. Typed parameters coerce Integer and
+    // Double alike, and Double.toString switches to exponent notation (which
+    // the evaluator rejects) outside [1e-3, 1e7).
+    private static boolean roundTrips(Object value) {
+        if (value instanceof Integer) {
+            return true;
+        }
+        if (value instanceof Long) {
+            return Math.abs((Long) value) <= (1L << 53);
+        }
+        if (value instanceof Double) {
+            double d = Math.abs((Double) value);
+            return d == Math.floor(d) ? d < 1e15 : d >= 1e-3 && d < 1e7;
+        }
+        return false;
+    }
+}
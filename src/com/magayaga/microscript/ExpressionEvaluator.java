@@ -347,7 +347,7 @@ public class ExpressionEvaluator {
     }
 
     // Check if an object is truthy (non-zero for numbers, true for booleans)
-    private boolean isTruthy(Object obj) {
+    static boolean isTruthy(Object obj) {
         if (obj == null) {
             return false;
         }
@@ -533,7 +533,7 @@ public class ExpressionEvaluator {
         }
     }
 
-    private double objectToDouble(Object obj) {
+    static double objectToDouble(Object obj) {
         if (obj instanceof Number) {
             return ((Number) obj).doubleValue();
         }
@@ -791,7 +791,7 @@ public class ExpressionEvaluator {
                             for (int i = 0; i < args.size(); i++) {
                                 argsArray[i] = args.get(i);
                             }
-                            return ((Import.FunctionInterface) moduleFunc).call(argsArray);
+                            return Profiler.callNative(fullName.toString(), (Import.FunctionInterface) moduleFunc, argsArray);
                         }
 
                         Function userFunction = environment.getFunction(fullName.toString());
@@ -11,6 +11,15 @@ import java.util.regex.Matcher;
 import java.util.regex.Pattern;
 
 public class ForLoop {
+    private static final Pattern RANGE_DETECT_PATTERN = Pattern.compile(
+        "for\\s*\\(\\s*([^:=]+)\\s*:\\s*([^)]+)\\s*\\)"
+    );
+    private static final Pattern RANGE_FOR_PATTERN = Pattern.compile(
+        "for\\s*\\(\\s*([^:]+)\\s*:\\s*([^)]+)\\s*\\)\\s*(\\{)?"
+    );
+    private static final Pattern FOR_PATTERN = Pattern.compile(
+        "for\\s*\\(\\s*([^;]+)\\s*;\\s*([^;]+)\\s*;\\s*([^)]+)\\s*\\)\\s*(\\{)?"
+    );
 
     /**
      * Process a for loop statement in the code
@@ -49,10 +58,7 @@ public class ForLoop {
         // Note: This should NOT match type annotations like "var i: Float64"
         // Range-based loops have the format: for (varDecl : collection)
         // where varDecl does NOT contain "=" and the colon is followed by a collection name
-        Pattern rangePattern = Pattern.compile(
-            "for\\s*\\(\\s*([^:=]+)\\s*:\\s*([^)]+)\\s*\\)"
-        );
-        Matcher matcher = rangePattern.matcher(line);
+        Matcher matcher = RANGE_DETECT_PATTERN.matcher(line);
 
         if (!matcher.find()) {
             return false;
@@ -221,10 +227,7 @@ public class ForLoop {
     }
 
     private static RangeBasedForComponents parseRangeBasedForSyntax(String line) {
-        Pattern rangePattern = Pattern.compile(
-            "for\\s*\\(\\s*([^:]+)\\s*:\\s*([^)]+)\\s*\\)\\s*(\\{)?"
-        );
-        Matcher rangeMatcher = rangePattern.matcher(line);
+        Matcher rangeMatcher = RANGE_FOR_PATTERN.matcher(line);
 
         if (!rangeMatcher.find()) {
             throw new RuntimeException(
@@ -249,10 +252,7 @@ public class ForLoop {
      * @return ForLoopComponents containing parsed information
      */
     private static ForLoopComponents parseForLoopSyntax(String line) {
-        Pattern forPattern = Pattern.compile(
-            "for\\s*\\(\\s*([^;]+)\\s*;\\s*([^;]+)\\s*;\\s*([^)]+)\\s*\\)\\s*(\\{)?"
-        );
-        Matcher forMatcher = forPattern.matcher(line);
+        Matcher forMatcher = FOR_PATTERN.matcher(line);
 
         if (!forMatcher.find()) {
             throw new RuntimeException(
@@ -312,15 +312,17 @@ public class ForLoop {
                 throw new RuntimeException("Array/collection '" + arrayName + "' is null");
             }
 
-            // Convert to iterable (this will depend on your MicroScript type system)
+            // Extract variable name from declaration
+            String variableName = extractVariableName(variableDeclaration);
+            CompiledBlock body = CompiledBlock.of(lines, startIndex, endIndex, CompiledBlock.FOR_LOOP);
+
+            // Convert to iterable (this will depend on your MicroScript type system);
+            // a ListVariable iterates straight over its packed storage
             Iterable<?> iterable = convertToIterable(arrayObject);
             if (iterable == null) {
                 throw new RuntimeException("'" + arrayName + "' is not iterable");
             }
 
-            // Extract variable name from declaration
-            String variableName = extractVariableName(variableDeclaration);
-
             // Iterate over each element
             for (Object element : iterable) {
                 // Safety check for infinite loops
@@ -331,18 +333,10 @@ public class ForLoop {
                 }
 
                 // Assign the current element to the loop variable
-                try {
-                    executor.execute(
-                        variableName + " = " + formatValueForAssignment(element)
-                    );
-                } catch (Exception e) {
-                    throw new RuntimeException(
-                        "Error assigning loop variable '" + variableName + "': " + e.getMessage()
-                    );
-                }
+                executor.getEnvironment().setVariable(variableName, element);
 
                 try {
-                    executeLoopBlock(lines, startIndex, endIndex, executor);
+                    body.execute(executor);
                 } catch (Statements.BreakException e) {
                     break;
                 } catch (Statements.ContinueException e) {
@@ -354,6 +348,8 @@ public class ForLoop {
             }
         } catch (Statements.BreakException | Statements.ContinueException e) {
             // These should have been caught in the inner loop
+        } catch (Statements.ReturnException e) {
+            throw e; // a return in the body leaves the enclosing function
         } catch (Exception e) {
             throw new RuntimeException(
                 "Error in range-based for loop execution: " + e.getMessage()
@@ -442,23 +438,6 @@ public class ForLoop {
         return variableDeclaration.trim();
     }
 
-    /**
-     * Format a value for assignment in MicroScript syntax
-     * @param value The value to format
-     * @return The formatted value as a string
-     */
-    private static String formatValueForAssignment(Object value) {
-        if (value == null) {
-            return "null";
-        } else if (value instanceof String) {
-            return "\"" + value.toString().replace("\"", "\\\"") + "\"";
-        } else if (value instanceof Character) {
-            return "'" + value.toString().replace("'", "\\'") + "'";
-        } else {
-            return value.toString();
-        }
-    }
-
     /**
      * Execute a for loop
      * @param initialization The initialization statement (variable declaration or assignment)
@@ -496,12 +475,17 @@ public class ForLoop {
                 executor.execute(initialization);
             }
 
+            // Classify the condition, increment and body once rather than every iteration
+            CompiledBlock.Evaluation test = CompiledBlock.Evaluation.of(condition);
+            CompiledBlock.Statement step = CompiledBlock.Statement.of(increment);
+            CompiledBlock body = CompiledBlock.of(lines, startIndex, endIndex, CompiledBlock.FOR_LOOP);
+
             // For loop execution
             while (iterations < MAX_ITERATIONS) {
                 // Evaluate the condition
                 Object conditionResult;
                 try {
-                    conditionResult = executor.evaluate(condition);
+                    conditionResult = test.evaluate(executor);
                 } catch (Exception e) {
                     throw new RuntimeException(
                         "Error evaluating for loop condition '" + condition + "': " + e.getMessage()
@@ -514,13 +498,13 @@ public class ForLoop {
                 }
 
                 try {
-                    executeLoopBlock(lines, startIndex, endIndex, executor);
+                    body.execute(executor);
                 } catch (Statements.BreakException e) {
                     break;
                 } catch (Statements.ContinueException e) {
                     // Execute increment and continue
                     try {
-                        executor.execute(increment);
+                        step.run(executor);
                     } catch (Exception ex) {
                         throw new RuntimeException(
                             "Error executing for loop increment '" + increment + "': " + ex.getMessage()
@@ -531,7 +515,7 @@ public class ForLoop {
                 }
 
                 try {
-                    executor.execute(increment);
+                    step.run(executor);
                 } catch (Exception e) {
                     throw new RuntimeException(
                         "Error executing for loop increment '" + increment + "': " + e.getMessage()
@@ -550,6 +534,8 @@ public class ForLoop {
             }
         } catch (Statements.BreakException | Statements.ContinueException e) {
             // These should have been caught in the inner loop
+        } catch (Statements.ReturnException e) {
+            throw e; // a return in the body leaves the enclosing function
         } catch (Exception e) {
             throw new RuntimeException(
                 "Error in for loop execution: " + e.getMessage()
@@ -557,109 +543,6 @@ public class ForLoop {
         }
     }
 
-    private static void executeLoopBlock(
-        List<String> lines,
-        int startIndex,
-        int endIndex,
-        Executor executor
-    ) throws Statements.BreakException, Statements.ContinueException {
-        for (int i = startIndex; i < endIndex; i++) {
-            String line = lines.get(i).trim();
-
-            if (line.isEmpty() || line.startsWith("//")) {
-                continue;
-            }
-
-            // Skip closing braces - they're just block delimiters
-            if (line.equals("}")) {
-                continue;
-            }
-
-            // Handle multi-line comments
-            if (line.startsWith("/*")) {
-                while (i < endIndex && !lines.get(i).contains("*/")) {
-                    i++;
-                }
-                continue;
-            }
-
-            // Handle break - throw exception to propagate up
-            if (line.equals("break") || line.equals("break;")) {
-                throw new Statements.BreakException();
-            }
-
-            // Handle continue - throw exception to propagate up
-            if (line.equals("continue") || line.equals("continue;")) {
-                throw new Statements.ContinueException();
-            }
-
-            // Handle return statements
-            if (line.startsWith("return")) {
-                executor.execute(line);
-                throw new Statements.BreakException(); // Treat return as break for loop purposes
-            }
-
-            if (line.startsWith("if")) {
-                try {
-                    int newIndex = Statements.processConditionalStatement(lines, i, executor);
-                    if (newIndex > i) {
-                        i = newIndex - 1;
-                    }
-                } catch (Statements.BreakException | Statements.ContinueException e) {
-                    // Propagate break/continue from nested if
-                    throw e;
-                } catch (Exception e) {
-                    throw new RuntimeException(
-                        "Error processing if statement in for loop: " + e.getMessage()
-                    );
-                }
-                continue;
-            }
-
-            // Handle nested while loops
-            if (line.startsWith("while")) {
-                try {
-                    int newIndex = WhileLoop.processWhileLoop(lines, i, executor);
-                    if (newIndex > i) {
-                        i = newIndex - 1;
-                    }
-                } catch (Exception e) {
-                    throw new RuntimeException(
-                        "Error processing nested while loop in for loop: " + e.getMessage()
-                    );
-                }
-                continue;
-            }
-
-            // Handle nested for loops
-            if (line.startsWith("for")) {
-                try {
-                    // Process the nested for loop
-                    int newIndex = processForLoop(lines, i, executor);
-
-                    // Make sure we advance properly
-                    if (newIndex > i) {
-                        i = newIndex - 1;
-                    }
-                } catch (Exception e) {
-                    throw new RuntimeException(
-                        "Error processing nested for loop: " + e.getMessage()
-                    );
-                }
-                continue;
-            }
-
-            try {
-                // Execute regular statements (including variable assignments, function calls, etc.)
-                executor.execute(line);
-            } catch (Exception e) {
-                throw new RuntimeException(
-                    "Error executing statement in for loop: '" + line + "' - " + e.getMessage()
-                );
-            }
-        }
-    }
-
     /**
      * Find the next line with an opening brace '{' (skipping comments/empty lines)
      * @param lines List of code lines
@@ -1,24 +1,58 @@
 /**
  * MicroScript — The programming language
- * Copyright (c) 2024-2025 Cyril John Magayaga
+ * Copyright (c) 2024-2026 Cyril John Magayaga
  * 
  * It was originally written in Java programming language.
  */
 package com.magayaga.microscript;
 
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.LinkedHashMap;
 import java.util.List;
+import java.util.Map;
+import java.util.Set;
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
 
 public class Function {
     private final String name;
     private final List<Parameter> parameters;
     private final String returnType;
     private final List<String> body;
+    private String[] slotLayout;
+    private Boolean ownNamesOnly;
+
+    // Words a body may use that never name a variable
+    private static final Set<String> RESERVED = new HashSet<>(Arrays.asList(
+        "if", "else", "for", "while", "switch", "case", "default", "break", "continue", "return",
+        "var", "bool", "letexpr", "list", "true", "false", "and", "or", "not", "console",
+        "String", "Int32", "Int64", "Float32", "Float64", "Char", "Bool"));
+    private static final Pattern DECLARATION_PATTERN = Pattern.compile("^(?:var|bool|letexpr|list)\\s+(\\w+)");
+    // Identifiers, skipping module members (math::sqrt) and fields (p.x)
+    private static final Pattern IDENTIFIER_PATTERN = Pattern.compile("(?<![\\w.:])([A-Za-z_]\\w*)(?!\\w|\\s*::)");
+    private static final Pattern TEMPLATE_PATTERN = Pattern.compile("\\{([^{}]*)\\}");
+    private static final Pattern LITERAL_PATTERN = Pattern.compile("\"(?:\\\\.|[^\"\\\\])*\"|'(?:\\\\.|[^'\\\\])'");
+
+    // Results of an @memo function, keyed on argument values; least recently used entries go first
+    private static final int MEMO_CAPACITY = 4096;
+    private final Map<List<Object>, Object> memo;
 
     public Function(String name, List<Parameter> parameters, String returnType, List<String> body) {
+        this(name, parameters, returnType, body, false);
+    }
+
+    public Function(String name, List<Parameter> parameters, String returnType, List<String> body, boolean memoized) {
         this.name = name;
         this.parameters = parameters;
         this.returnType = returnType;
         this.body = body;
+        this.memo = memoized ? new LinkedHashMap<List<Object>, Object>(16, 0.75f, true) {
+            @Override
+            protected boolean removeEldestEntry(Map.Entry<List<Object>, Object> eldest) {
+                return size() > MEMO_CAPACITY;
+            }
+        } : null;
     }
 
     public String getName() {
@@ -36,4 +70,118 @@ public class Function {
     public List<String> getBody() {
         return body;
     }
+
+    public boolean isMemoized() {
+        return memo != null;
+    }
+
+    // Callers may run on several threads (pmap workers), hence the locking
+    public Object memoLookup(List<Object> arguments) {
+        synchronized (memo) {
+            return memo.get(arguments);
+        }
+    }
+
+    public void memoStore(List<Object> arguments, Object result) {
+        synchronized (memo) {
+            memo.put(arguments, result);
+        }
+    }
+
+    /**
+     * Whether every name the body reads is a parameter, the function itself,
+     * or a local declared at the top of the body before its first use. Only
+     * such bodies see the same names in a replaced frame as in a nested one,
+     * since scoping is dynamic. Anything unrecognised (a nested declaration,
+     * a call to another function, an annotation) counts as a free name.
+     */
+    public boolean readsOwnNamesOnly() {
+        Boolean result = ownNamesOnly;
+        if (result == null) {
+            result = scanOwnNames();
+            ownNamesOnly = result;
+        }
+        return result;
+    }
+
+    private boolean scanOwnNames() {
+        Set<String> known = new HashSet<>(RESERVED);
+        known.add(name);
+        for (Parameter parameter : parameters) {
+            known.add(parameter.getName());
+        }
+        int depth = 0;
+        for (String rawLine : body) {
+            String line = rawLine.trim();
+            int comment = line.indexOf("//");
+            if (comment >= 0) {
+                line = line.substring(0, comment).trim();
+            }
+            if (line.startsWith("@")) {
+                return false;
+            }
+            line = stripLiterals(line);
+            String declared = null;
+            Matcher declaration = DECLARATION_PATTERN.matcher(line);
+            if (depth == 0 && declaration.find()) {
+                declared = declaration.group(1);
+                line = line.substring(declaration.end());
+            }
+            Matcher identifier = IDENTIFIER_PATTERN.matcher(line);
+            while (identifier.find()) {
+                if (!known.contains(identifier.group(1))) {
+                    return false;
+                }
+            }
+            if (declared != null) {
+                known.add(declared);
+            }
+            for (int i = 0; i < line.length(); i++) {
+                char c = line.charAt(i);
+                if (c == '{') {
+                    depth++;
+                } else if (c == '}') {
+                    depth--;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Replace each string literal by the {expressions} it interpolates, which read names too
+    private static String stripLiterals(String line) {
+        Matcher literal = LITERAL_PATTERN.matcher(line);
+        StringBuffer output = new StringBuffer();
+        while (literal.find()) {
+            StringBuilder expressions = new StringBuilder(" ");
+            Matcher template = TEMPLATE_PATTERN.matcher(literal.group());
+            while (template.find()) {
+                expressions.append('(').append(template.group(1)).append(") ");
+            }
+            literal.appendReplacement(output, Matcher.quoteReplacement(expressions.toString()));
+        }
+        literal.appendTail(output);
+        return output.toString();
+    }
+
+    /**
+     * Parameter names in order, shared by the Environment of every call so
+     * arguments bind by slot index. Null when a name repeats, since slots
+     * could not then mirror the last-one-wins map semantics.
+     */
+    public String[] getSlotLayout() {
+        String[] layout = slotLayout;
+        if (layout == null) {
+            layout = new String[parameters.size()];
+            Set<String> seen = new HashSet<>();
+            for (int i = 0; i < layout.length; i++) {
+                layout[i] = parameters.get(i).getName();
+                if (!seen.add(layout[i])) {
+                    return null;
+                }
+            }
+            slotLayout = layout;
+        }
+        return layout;
+    }
 }
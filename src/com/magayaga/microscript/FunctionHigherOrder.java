@@ -7,16 +7,37 @@
 package com.magayaga.microscript;
 
 import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.List;
+import java.util.concurrent.ForkJoinPool;
+import java.util.concurrent.RecursiveAction;
+import java.util.concurrent.RecursiveTask;
 import java.util.function.BiFunction;
 import java.util.function.Function;
+import java.util.function.Supplier;
+import java.util.regex.Matcher;
+import java.util.regex.Pattern;
 
 /**
  * FunctionHigherOrder — Haskell-style higher-order functions for MicroScript
  * Supports: map, filter, foldlt (fold left), foldrt (fold right)
  * Extended with @map and @__globalfn__ syntax support
+ *
+ * pmap, pfilter and preduce split large lists into chunks on the common
+ * ForkJoinPool and merge the chunk results in list order. They take a
+ * supplier rather than a single lambda: each chunk asks it for its own
+ * worker, so no two threads ever share an Environment. Lambdas must be
+ * pure; assigning to an enclosing variable from a worker is a race.
  */
 public class FunctionHigherOrder {
+    // math::name(it) and math::pow(it, exponent) map through a native array kernel
+    private static final Pattern MATH_UNARY = Pattern.compile("^math::(\\w+)\\(\\s*it\\s*\\)$");
+    private static final Pattern MATH_POW = Pattern.compile("^math::pow\\(\\s*it\\s*,\\s*([-+]?[0-9]*\\.?[0-9]+)\\s*\\)$");
+
+    // Lists shorter than this are not worth splitting
+    static final int PARALLEL_THRESHOLD = 4096;
+    private static final int MIN_CHUNK = 1024;
+
     // Applies a function to each element of the list and returns a new list
     public static List<Object> map(Function<Object, Object> fn, List<Object> list) {
         List<Object> result = new ArrayList<>();
@@ -26,6 +47,50 @@ public class FunctionHigherOrder {
         return result;
     }
 
+    /**
+     * Map a math builtin over a list in one native call. Returns null when
+     * the lambda is not a plain math::name(it) call with an array kernel, or
+     * when the list holds anything other than numbers.
+     */
+    public static List<Object> mapMath(String lambda, List<Object> list) {
+        String expression = lambda.trim();
+        Matcher unary = MATH_UNARY.matcher(expression);
+        Matcher pow = MATH_POW.matcher(expression);
+        if (!unary.matches() && !pow.matches()) {
+            return null;
+        }
+
+        double[] values = toDoubles(list);
+        if (values == null) {
+            return null;
+        }
+
+        double[] mapped = unary.matches()
+            ? NativeMath.applyArray(unary.group(1), values)
+            : NativeMath.powArray(values, Double.parseDouble(pow.group(1)));
+        return mapped == null ? null : toList(mapped);
+    }
+
+    static double[] toDoubles(List<Object> list) {
+        if (list instanceof ListVariable) {
+            return ((ListVariable) list).toDoubleArray(); // packed lists copy without unboxing
+        }
+        double[] values = new double[list.size()];
+        for (int i = 0; i < values.length; i++) {
+            Object item = list.get(i);
+            if (!(item instanceof Number)) {
+                return null;
+            }
+            values[i] = ((Number) item).doubleValue();
+        }
+        return values;
+    }
+
+    // Native results become packed lists without boxing each element
+    static List<Object> toList(double[] values) {
+        return ListVariable.ofDoubles(values);
+    }
+
     // Returns a new list containing only elements for which the predicate returns true
     public static List<Object> filter(Function<Object, Boolean> predicate, List<Object> list) {
         List<Object> result = new ArrayList<>();
@@ -37,6 +102,134 @@ public class FunctionHigherOrder {
         return result;
     }
 
+    // Parallel map: same result as map, computed in chunks
+    public static List<Object> pmap(Supplier<Function<Object, Object>> workers, List<Object> list) {
+        if (list.size() < PARALLEL_THRESHOLD) {
+            return map(workers.get(), list);
+        }
+        Object[] result = new Object[list.size()];
+        ForkJoinPool.commonPool().invoke(new MapTask(workers, list, result, 0, list.size(), chunkSize(list.size())));
+        return new ArrayList<>(Arrays.asList(result));
+    }
+
+    // Parallel filter: same elements, in the same order, as filter
+    public static List<Object> pfilter(Supplier<Function<Object, Boolean>> workers, List<Object> list) {
+        if (list.size() < PARALLEL_THRESHOLD) {
+            return filter(workers.get(), list);
+        }
+        return ForkJoinPool.commonPool().invoke(new FilterTask(workers, list, 0, list.size(), chunkSize(list.size())));
+    }
+
+    /**
+     * Parallel reduce for an associative fn. Chunks are folded and combined
+     * in list order, and initial is applied once on the left, so the result
+     * equals foldlt(fn, initial, list) without fn needing an identity.
+     */
+    public static Object preduce(Supplier<BiFunction<Object, Object, Object>> workers, Object initial, List<Object> list) {
+        if (list.size() < PARALLEL_THRESHOLD) {
+            return foldlt(workers.get(), initial, list);
+        }
+        Object reduced = ForkJoinPool.commonPool().invoke(new ReduceTask(workers, list, 0, list.size(), chunkSize(list.size())));
+        return workers.get().apply(initial, reduced);
+    }
+
+    // A few chunks per core, so faster workers can steal the remainder
+    private static int chunkSize(int size) {
+        int chunks = ForkJoinPool.getCommonPoolParallelism() * 4;
+        return Math.max(MIN_CHUNK, (size + chunks - 1) / chunks);
+    }
+
+    private static final class MapTask extends RecursiveAction {
+        private final Supplier<Function<Object, Object>> workers;
+        private final List<Object> list;
+        private final Object[] result;
+        private final int from;
+        private final int to;
+        private final int chunk;
+
+        MapTask(Supplier<Function<Object, Object>> workers, List<Object> list, Object[] result, int from, int to, int chunk) {
+            this.workers = workers;
+            this.list = list;
+            this.result = result;
+            this.from = from;
+            this.to = to;
+            this.chunk = chunk;
+        }
+
+        @Override
+        protected void compute() {
+            if (to - from <= chunk) {
+                Function<Object, Object> fn = workers.get();
+                for (int i = from; i < to; i++) {
+                    result[i] = fn.apply(list.get(i));
+                }
+                return;
+            }
+            int mid = (from + to) >>> 1;
+            invokeAll(new MapTask(workers, list, result, from, mid, chunk),
+                      new MapTask(workers, list, result, mid, to, chunk));
+        }
+    }
+
+    private static final class FilterTask extends RecursiveTask<List<Object>> {
+        private final Supplier<Function<Object, Boolean>> workers;
+        private final List<Object> list;
+        private final int from;
+        private final int to;
+        private final int chunk;
+
+        FilterTask(Supplier<Function<Object, Boolean>> workers, List<Object> list, int from, int to, int chunk) {
+            this.workers = workers;
+            this.list = list;
+            this.from = from;
+            this.to = to;
+            this.chunk = chunk;
+        }
+
+        @Override
+        protected List<Object> compute() {
+            if (to - from <= chunk) {
+                return filter(workers.get(), list.subList(from, to));
+            }
+            int mid = (from + to) >>> 1;
+            FilterTask left = new FilterTask(workers, list, from, mid, chunk);
+            left.fork();
+            List<Object> right = new FilterTask(workers, list, mid, to, chunk).compute();
+            List<Object> result = left.join();
+            result.addAll(right);
+            return result;
+        }
+    }
+
+    private static final class ReduceTask extends RecursiveTask<Object> {
+        private final Supplier<BiFunction<Object, Object, Object>> workers;
+        private final List<Object> list;
+        private final int from;
+        private final int to;
+        private final int chunk;
+
+        // Ranges are never empty: the pool only sees lists of PARALLEL_THRESHOLD or more
+        ReduceTask(Supplier<BiFunction<Object, Object, Object>> workers, List<Object> list, int from, int to, int chunk) {
+            this.workers = workers;
+            this.list = list;
+            this.from = from;
+            this.to = to;
+            this.chunk = chunk;
+        }
+
+        @Override
+        protected Object compute() {
+            if (to - from <= chunk) {
+                return foldlt(workers.get(), list.get(from), list.subList(from + 1, to));
+            }
+            int mid = (from + to) >>> 1;
+            ReduceTask left = new ReduceTask(workers, list, from, mid, chunk);
+            left.fork();
+            Object right = new ReduceTask(workers, list, mid, to, chunk).compute();
+            return workers.get().apply(left.join(), right);
+        }
+    }
+
     // Left fold: foldlt(fn, initial, list)
     public static Object foldlt(BiFunction<Object, Object, Object> fn, Object initial, List<Object> list) {
         Object acc = initial;
@@ -57,12 +250,17 @@ public class FunctionHigherOrder {
     
     // Process @map syntax: @map => (operation) [list]
     public static List<Object> processMap(String operation, List<Object> list) {
+        return processMap(operation, list, false);
+    }
+
+    // Process @map and @pmap syntax; parallel splits the list across the pool
+    public static List<Object> processMap(String operation, List<Object> list, boolean parallel) {
         if (operation.startsWith("(*")) {
             // Multiplication operation: (*2)
             String multiplierStr = operation.substring(2, operation.length() - 1).trim();
             try {
                 double multiplier = Double.parseDouble(multiplierStr);
-                return map(x -> multiplyNumbers(x, multiplier), list);
+                return apply(x -> multiplyNumbers(x, multiplier), list, parallel);
             } catch (NumberFormatException e) {
                 throw new RuntimeException("Invalid multiplier in @map operation: " + operation);
             }
@@ -71,7 +269,7 @@ public class FunctionHigherOrder {
             String addendStr = operation.substring(2, operation.length() - 1).trim();
             try {
                 double addend = Double.parseDouble(addendStr);
-                return map(x -> addNumbers(x, addend), list);
+                return apply(x -> addNumbers(x, addend), list, parallel);
             } catch (NumberFormatException e) {
                 throw new RuntimeException("Invalid addend in @map operation: " + operation);
             }
@@ -80,7 +278,7 @@ public class FunctionHigherOrder {
             String subtrahendStr = operation.substring(2, operation.length() - 1).trim();
             try {
                 double subtrahend = Double.parseDouble(subtrahendStr);
-                return map(x -> subtractNumbers(x, subtrahend), list);
+                return apply(x -> subtractNumbers(x, subtrahend), list, parallel);
             } catch (NumberFormatException e) {
                 throw new RuntimeException("Invalid subtrahend in @map operation: " + operation);
             }
@@ -92,15 +290,29 @@ public class FunctionHigherOrder {
                 if (Math.abs(divisor) < 0.0001) {
                     throw new RuntimeException("Division by zero in @map operation: " + operation);
                 }
-                return map(x -> divideNumbers(x, divisor), list);
+                return apply(x -> divideNumbers(x, divisor), list, parallel);
             } catch (NumberFormatException e) {
                 throw new RuntimeException("Invalid divisor in @map operation: " + operation);
             }
+        } else if (operation.startsWith("(math::")) {
+            // Math builtin: (math::sqrt) or (math::pow 3)
+            String[] parts = operation.substring(1, operation.length() - 1).trim().split("\\s+");
+            String lambda = parts.length > 1 ? parts[0] + "(it, " + parts[1] + ")" : parts[0] + "(it)";
+            List<Object> result = mapMath(lambda, list);
+            if (result == null) {
+                throw new RuntimeException("Unsupported @map operation: " + operation);
+            }
+            return result;
         } else {
             throw new RuntimeException("Unsupported @map operation: " + operation);
         }
     }
     
+    // The operations above are plain Java, so every chunk can share one function
+    private static List<Object> apply(Function<Object, Object> fn, List<Object> list, boolean parallel) {
+        return parallel ? pmap(() -> fn, list) : map(fn, list);
+    }
+    
     // Helper methods for arithmetic operations
     private static Object multiplyNumbers(Object a, double multiplier) {
         if (a instanceof Integer) {
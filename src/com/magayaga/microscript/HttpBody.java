@@ -0,0 +1,128 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * It was originally written in Java programming language.
+ */
+package com.magayaga.microscript;
+
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+
+/**
+ * Byte-oriented request and response bodies over direct ByteBuffers.
+ * The Go side reads from the socket straight into the buffer and writes
+ * responses straight out of it, so binary payloads are never re-encoded.
+ */
+public class HttpBody {
+    private static final int INITIAL_CAPACITY = 16 * 1024;
+    private static final int MAX_STAGING_CAPACITY = 1024 * 1024;
+
+    // getRequestBodyLength results that are not a length
+    private static final int LENGTH_UNKNOWN = -1;
+    private static final int NO_SUCH_REQUEST = -2;
+
+    // Per-thread staging buffer used when a heap byte[] has to be sent
+    private static final ThreadLocal<ByteBuffer> STAGING =
+        ThreadLocal.withInitial(() -> ByteBuffer.allocateDirect(INITIAL_CAPACITY));
+
+    /**
+     * Read the whole request body into a direct buffer, flipped for reading.
+     * A known Content-Length is read in one pass with no reallocation.
+     */
+    public static ByteBuffer read(int requestId) {
+        NativeHttp.checkLibrary();
+        int expected = NativeHttp.getRequestBodyLength(requestId);
+        if (expected == NO_SUCH_REQUEST) {
+            throw new RuntimeException("Unknown request " + requestId);
+        }
+        if (expected == 0) {
+            return ByteBuffer.allocateDirect(0);
+        }
+
+        ByteBuffer buffer = ByteBuffer.allocateDirect(expected != LENGTH_UNKNOWN ? expected : INITIAL_CAPACITY);
+
+        while (true) {
+            if (!buffer.hasRemaining()) {
+                if (expected != LENGTH_UNKNOWN && buffer.position() == expected) {
+                    break;
+                }
+                buffer = grow(buffer, buffer.capacity() * 2);
+            }
+
+            int n = NativeHttp.readRequestBody(requestId, buffer, buffer.position(), buffer.remaining());
+            if (n < 0) {
+                throw new RuntimeException("Failed to read body of request " + requestId);
+            }
+            if (n == 0) {
+                break;
+            }
+            buffer.position(buffer.position() + n);
+        }
+
+        buffer.flip();
+        return buffer;
+    }
+
+    /**
+     * Copy the readable bytes of a buffer into a heap array
+     */
+    public static byte[] toArray(ByteBuffer buffer) {
+        byte[] bytes = new byte[buffer.remaining()];
+        buffer.duplicate().get(bytes);
+        return bytes;
+    }
+
+    /**
+     * Send the readable bytes of a buffer as the response body. Direct
+     * buffers go out as-is; heap buffers are staged once into direct memory.
+     */
+    public static void send(int requestId, int statusCode, String contentType, ByteBuffer body) {
+        NativeHttp.checkLibrary();
+        if (body.isDirect()) {
+            NativeHttp.sendResponseBytes(requestId, statusCode, contentType, body, body.position(), body.remaining());
+            return;
+        }
+
+        ByteBuffer staging = staging(body.remaining());
+        staging.put(body.duplicate()).flip();
+        NativeHttp.sendResponseBytes(requestId, statusCode, contentType, staging, 0, staging.remaining());
+    }
+
+    public static void send(int requestId, int statusCode, String contentType, byte[] body) {
+        send(requestId, statusCode, contentType, ByteBuffer.wrap(body));
+    }
+
+    /**
+     * Convert a script value into a body buffer: buffers and byte arrays are
+     * used directly, anything else is sent as its UTF-8 text.
+     */
+    static ByteBuffer fromValue(Object value) {
+        if (value instanceof ByteBuffer) {
+            return (ByteBuffer) value;
+        }
+        if (value instanceof byte[]) {
+            return ByteBuffer.wrap((byte[]) value);
+        }
+        return ByteBuffer.wrap(String.valueOf(value).getBytes(StandardCharsets.UTF_8));
+    }
+
+    private static ByteBuffer grow(ByteBuffer buffer, int capacity) {
+        ByteBuffer larger = ByteBuffer.allocateDirect(capacity);
+        buffer.flip();
+        larger.put(buffer);
+        return larger;
+    }
+
+    private static ByteBuffer staging(int size) {
+        ByteBuffer staging = STAGING.get();
+        if (staging.capacity() < size) {
+            staging = ByteBuffer.allocateDirect(size);
+            if (size <= MAX_STAGING_CAPACITY) {
+                STAGING.set(staging);
+            }
+        }
+        staging.clear();
+        return staging;
+    }
+}
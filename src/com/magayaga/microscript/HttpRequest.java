@@ -0,0 +1,161 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * It was originally written in Java programming language.
+ */
+package com.magayaga.microscript;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.util.Collections;
+import java.util.LinkedHashMap;
+import java.util.Map;
+import java.util.TreeMap;
+
+/**
+ * Immutable view of an HTTP request decoded from a single native snapshot.
+ * The whole request (method, path, headers, query) is fetched with one
+ * JNI/cgo call, after which every field lookup stays in Java.
+ */
+public class HttpRequest {
+    private static final Map<String, String> STRUCT_FIELDS = new LinkedHashMap<>();
+
+    static {
+        STRUCT_FIELDS.put("id", "Int32");
+        STRUCT_FIELDS.put("method", "String");
+        STRUCT_FIELDS.put("path", "String");
+        STRUCT_FIELDS.put("headers", "Map");
+        STRUCT_FIELDS.put("query", "Map");
+    }
+
+    private final int id;
+    private final String method;
+    private final String path;
+    private final Map<String, String> headers;
+    private final Map<String, String> query;
+
+    private HttpRequest(int id, String method, String path, Map<String, String> headers, Map<String, String> query) {
+        this.id = id;
+        this.method = method;
+        this.path = path;
+        this.headers = Collections.unmodifiableMap(headers);
+        this.query = Collections.unmodifiableMap(query);
+    }
+
+    /**
+     * Fetch and decode the snapshot of a live request
+     */
+    public static HttpRequest fetch(int requestId) {
+        NativeHttp.checkLibrary();
+        byte[] snapshot = NativeHttp.getRequestSnapshot(requestId);
+        if (snapshot == null || snapshot.length == 0) {
+            throw new RuntimeException("Unknown or completed request: " + requestId);
+        }
+        return decode(requestId, snapshot);
+    }
+
+    /**
+     * Decode the packed snapshot layout produced by getRequestSnapshot:
+     * method, path, header pairs and query pairs, each string prefixed by
+     * its little-endian uint32 byte length.
+     */
+    static HttpRequest decode(int requestId, byte[] snapshot) {
+        ByteBuffer buffer = ByteBuffer.wrap(snapshot).order(ByteOrder.LITTLE_ENDIAN);
+        String method = readString(buffer);
+        String path = readString(buffer);
+
+        // Header names are case-insensitive; the first value wins like Header.Get
+        Map<String, String> headers = new TreeMap<>(String.CASE_INSENSITIVE_ORDER);
+        readPairs(buffer, headers);
+
+        Map<String, String> query = new LinkedHashMap<>();
+        readPairs(buffer, query);
+
+        return new HttpRequest(requestId, method, path, headers, query);
+    }
+
+    private static String readString(ByteBuffer buffer) {
+        int length = buffer.getInt();
+        String value = new String(buffer.array(), buffer.position(), length, StandardCharsets.UTF_8);
+        buffer.position(buffer.position() + length);
+        return value;
+    }
+
+    private static void readPairs(ByteBuffer buffer, Map<String, String> target) {
+        int count = buffer.getInt();
+        for (int i = 0; i < count; i++) {
+            String name = readString(buffer);
+            String value = readString(buffer);
+            target.putIfAbsent(name, value);
+        }
+    }
+
+    public int getId() {
+        return id;
+    }
+
+    public String getMethod() {
+        return method;
+    }
+
+    public String getPath() {
+        return path;
+    }
+
+    public Map<String, String> getHeaders() {
+        return headers;
+    }
+
+    public Map<String, String> getQuery() {
+        return query;
+    }
+
+    /**
+     * Get a header value, or an empty string when absent
+     */
+    public String getHeader(String name) {
+        return headers.getOrDefault(name, "");
+    }
+
+    /**
+     * Get a query parameter value, or an empty string when absent
+     */
+    public String getQueryParam(String name) {
+        return query.getOrDefault(name, "");
+    }
+
+    /**
+     * Expose the request to scripts as an HttpRequest struct instance
+     */
+    public Struct toStruct() {
+        Map<String, Object> values = new LinkedHashMap<>();
+        values.put("id", id);
+        values.put("method", method);
+        values.put("path", path);
+        values.put("headers", headers);
+        values.put("query", query);
+        return new Struct("HttpRequest", STRUCT_FIELDS, values);
+    }
+
+    /**
+     * Resolve the snapshot behind a script value: either an HttpRequest
+     * struct returned by http::getRequest or a raw request id.
+     */
+    @SuppressWarnings("unchecked")
+    static String lookup(Object request, String field, String name) {
+        if (request instanceof Struct) {
+            Object values = ((Struct) request).getField(field);
+            if (values instanceof Map) {
+                Object value = ((Map<String, String>) values).get(name);
+                return value != null ? value.toString() : "";
+            }
+        }
+        if (request instanceof Number) {
+            HttpRequest snapshot = fetch(((Number) request).intValue());
+            return field.equals("headers") ? snapshot.getHeader(name) : snapshot.getQueryParam(name);
+        }
+        throw new RuntimeException("Expected an HttpRequest or request id, got: " + request);
+    }
+}
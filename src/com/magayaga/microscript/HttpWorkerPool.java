@@ -0,0 +1,124 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * It was originally written in Java programming language.
+ */
+package com.magayaga.microscript;
+
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+
+/**
+ * Fixed pool of threads that run MicroScript route handlers. Each worker
+ * blocks in the native awaitRequest call, then invokes the handler function
+ * named in addRoute with the request id. Queueing and back-pressure (503 when
+ * the queue is full) happen on the Go side.
+ *
+ * Workers share the script's global environment, which is not synchronized,
+ * so globals are read-only inside handlers: each worker runs in a child scope
+ * of its own, and anything a handler assigns lands there or in the call's
+ * local scope, never in the shared global frame. Scripts should finish
+ * setting up globals before calling startWorkers.
+ */
+public class HttpWorkerPool {
+    private static final int POLL_TIMEOUT_MS = 500;
+    private static final Map<Integer, HttpWorkerPool> pools = new ConcurrentHashMap<>();
+
+    private final int serverHandle;
+    private final Environment environment;
+    private final Thread[] workers;
+    private final Map<Integer, String> handlerNames = new ConcurrentHashMap<>();
+
+    private HttpWorkerPool(int serverHandle, Environment environment, int threads) {
+        this.serverHandle = serverHandle;
+        this.environment = environment;
+        this.workers = new Thread[threads];
+    }
+
+    /**
+     * Start workers for a server, or return the pool already serving it
+     */
+    public static HttpWorkerPool start(int serverHandle, Environment environment, int threads, int queueCapacity) {
+        NativeHttp.checkLibrary();
+        if (threads <= 0) {
+            threads = Runtime.getRuntime().availableProcessors();
+        }
+
+        final int workerCount = threads;
+        return pools.computeIfAbsent(serverHandle, handle -> {
+            NativeHttp.startDispatch(handle, queueCapacity);
+            HttpWorkerPool pool = new HttpWorkerPool(handle, environment, workerCount);
+            pool.startThreads();
+            return pool;
+        });
+    }
+
+    /**
+     * Block until the server stops and every worker has exited
+     */
+    public void join() {
+        for (Thread worker : workers) {
+            try {
+                worker.join();
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+                return;
+            }
+        }
+    }
+
+    private void startThreads() {
+        for (int i = 0; i < workers.length; i++) {
+            workers[i] = new Thread(this::run, "microscript-http-" + serverHandle + "-" + i);
+            workers[i].setDaemon(true);
+            workers[i].start();
+        }
+    }
+
+    private void run() {
+        // One executor per worker, in a private scope so no write reaches the
+        // shared globals; every call still gets its own local environment
+        Executor executor = new Executor(new Environment(environment));
+        try {
+            while (true) {
+                long next = NativeHttp.awaitRequest(serverHandle, POLL_TIMEOUT_MS);
+                if (next == -1) {
+                    continue;
+                }
+                if (next < 0) {
+                    break;
+                }
+
+                int requestId = (int) next;
+                int handlerSlot = (int) (next >>> 32);
+                String handlerName = handlerNames.computeIfAbsent(handlerSlot,
+                    slot -> NativeHttp.getHandlerName(serverHandle, slot));
+                dispatch(executor, handlerName, requestId);
+            }
+        } finally {
+            pools.remove(serverHandle, this);
+        }
+    }
+
+    private void dispatch(Executor executor, String handlerName, int requestId) {
+        try {
+            Function handler = environment.getFunction(handlerName);
+            if (handler == null) {
+                throw new RuntimeException("Handler function not found: " + handlerName);
+            }
+
+            // Handlers may take the request id or nothing at all
+            if (handler.getParameters().isEmpty()) {
+                executor.callFunction(handlerName);
+            } else {
+                executor.callFunction(handlerName, requestId);
+            }
+        } catch (RuntimeException e) {
+            System.err.println("HTTP handler error in " + handlerName + ": " + e.getMessage());
+            NativeHttp.respond(requestId, 500, "text/plain", "Internal Server Error");
+        } finally {
+            NativeHttp.finishRequest(requestId);
+        }
+    }
+}
@@ -7,6 +7,7 @@
 package com.magayaga.microscript;
 
 import java.util.HashMap;
+import java.util.List;
 import java.util.Map;
 import com.magayaga.microscript.NativeIo; // import native IO bindings
 
@@ -36,21 +37,92 @@ public class Import {
 
     // Example math module
     public static class MathModule implements Module {
+        private static final String NUMBERS_PREFIX = "math::numbers::";
+        private static volatile Map<String, Double> numbers;
+
+        /**
+         * math::numbers::* by name, fetched from the native library once
+         */
+        static Map<String, Double> numbers() {
+            if (numbers == null) {
+                synchronized (MathModule.class) {
+                    if (numbers == null) {
+                        double[] values = NativeMath.constants();
+                        Map<String, Double> table = new HashMap<>();
+                        for (int i = 0; i < NativeMath.CONSTANT_NAMES.length; i++) {
+                            table.put(NativeMath.CONSTANT_NAMES[i], values[i]);
+                        }
+                        table.put("eulerNumber", table.get("e"));
+                        numbers = table;
+                    }
+                }
+            }
+            return numbers;
+        }
+
+        static boolean isImported(List<String> lines) {
+            for (String line : lines) {
+                if (line.trim().equals("import math")) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Replace math::numbers::name references with numeric literals, so
+         * expressions read the value directly instead of looking it up on
+         * every evaluation. String literals and // comments are left alone.
+         */
+        static String foldConstants(String line) {
+            if (!line.contains(NUMBERS_PREFIX)) {
+                return line;
+            }
+
+            StringBuilder folded = new StringBuilder(line.length());
+            boolean inString = false;
+            int i = 0;
+            while (i < line.length()) {
+                char c = line.charAt(i);
+                if (inString) {
+                    folded.append(c);
+                    if (c == '\\' && i + 1 < line.length()) {
+                        folded.append(line.charAt(++i));
+                    } else if (c == '"') {
+                        inString = false;
+                    }
+                    i++;
+                    continue;
+                }
+                if (c == '"') {
+                    inString = true;
+                } else if (c == '/' && line.startsWith("//", i)) {
+                    folded.append(line, i, line.length());
+                    break;
+                } else if (line.startsWith(NUMBERS_PREFIX, i)
+                           && (i == 0 || !Character.isJavaIdentifierPart(line.charAt(i - 1)))) {
+                    int end = i + NUMBERS_PREFIX.length();
+                    while (end < line.length() && Character.isJavaIdentifierPart(line.charAt(end))) {
+                        end++;
+                    }
+                    Double value = numbers().get(line.substring(i + NUMBERS_PREFIX.length(), end));
+                    if (value != null) {
+                        folded.append(Double.toString(value));
+                        i = end;
+                        continue;
+                    }
+                }
+                folded.append(c);
+                i++;
+            }
+            return folded.toString();
+        }
+
         @Override
         public void register(Environment env) {
-            env.setVariable("math::numbers::pi", NativeMath.PI());
-            env.setVariable("math::numbers::e", NativeMath.E());
-            env.setVariable("math::numbers::eulerNumber", NativeMath.E());
-            env.setVariable("math::numbers::tau", NativeMath.TAU());
-            env.setVariable("math::numbers::phi", NativeMath.PHI());
-            env.setVariable("math::numbers::silverRatio", NativeMath.SILVERRATIO());
-            env.setVariable("math::numbers::eulerConstant", NativeMath.EULER());
-            env.setVariable("math::numbers::catalan", NativeMath.CATALAN());
-            env.setVariable("math::numbers::apery", NativeMath.APERY());
-            env.setVariable("math::numbers::feigenbaumDelta", NativeMath.FEIGENBAUMDELTA());
-            env.setVariable("math::numbers::feigenbaumAlpha", NativeMath.FEIGENBAUMALPHA());
-            env.setVariable("math::numbers::plastic", NativeMath.PLASTIC());
-            env.setVariable("math::numbers::twinPrime", NativeMath.TWINPRIME());
+            for (Map.Entry<String, Double> constant : numbers().entrySet()) {
+                env.setVariable(NUMBERS_PREFIX + constant.getKey(), constant.getValue());
+            }
             env.setVariable("math::sqrt", (Import.FunctionInterface) (args) -> NativeMath.sqrt(((Number) args[0]).doubleValue()));
             env.setVariable("math::square", (Import.FunctionInterface) (args) -> NativeMath.square(((Number) args[0]).doubleValue()));
             env.setVariable("math::cbrt", (Import.FunctionInterface) (args) -> NativeMath.cbrt(((Number) args[0]).doubleValue()));
@@ -72,10 +144,65 @@ public class Import {
             env.setVariable("math::asinh", (Import.FunctionInterface) (args) -> NativeMath.asinh(((Number) args[0]).doubleValue()));
             env.setVariable("math::acosh", (Import.FunctionInterface) (args) -> NativeMath.acosh(((Number) args[0]).doubleValue()));
             env.setVariable("math::atanh", (Import.FunctionInterface) (args) -> NativeMath.atanh(((Number) args[0]).doubleValue()));
+            env.setVariable("math::pow", (Import.FunctionInterface) (args) -> NativeMath.pow(((Number) args[0]).doubleValue(), ((Number) args[1]).doubleValue()));
+            // math::fma(a, b, c): a * b + c, element-wise when given three lists
+            env.setVariable("math::fma", (Import.FunctionInterface) (args) -> {
+                if (args[0] instanceof List && args[1] instanceof List && args[2] instanceof List) {
+                    double[] a = FunctionHigherOrder.toDoubles((List<Object>) args[0]);
+                    double[] b = FunctionHigherOrder.toDoubles((List<Object>) args[1]);
+                    double[] c = FunctionHigherOrder.toDoubles((List<Object>) args[2]);
+                    if (a == null || b == null || c == null || a.length != b.length || a.length != c.length) {
+                        throw new RuntimeException("math::fma expects three numeric lists of the same length");
+                    }
+                    return FunctionHigherOrder.toList(NativeMath.fmaArray(a, b, c));
+                }
+                return Math.fma(((Number) args[0]).doubleValue(), ((Number) args[1]).doubleValue(), ((Number) args[2]).doubleValue());
+            });
+            // Reductions over numeric lists, computed natively
+            env.setVariable("math::sum", (Import.FunctionInterface) (args) -> NativeMath.sumArray(numericList("math::sum", args[0])));
+            env.setVariable("math::mean", (Import.FunctionInterface) (args) -> NativeMath.meanArray(numericList("math::mean", args[0])));
+            // math::variance(list[, sample]): population variance unless sample is true
+            env.setVariable("math::variance", (Import.FunctionInterface) (args) -> {
+                boolean sample = args.length > 1 && Boolean.TRUE.equals(args[1]);
+                return NativeMath.varianceArray(numericList("math::variance", args[0]), sample);
+            });
+            // math::min and math::max take a list, or two numbers
+            env.setVariable("math::min", (Import.FunctionInterface) (args) -> {
+                if (args.length == 1) {
+                    return NativeMath.minArray(numericList("math::min", args[0]));
+                }
+                return Math.min(((Number) args[0]).doubleValue(), ((Number) args[1]).doubleValue());
+            });
+            env.setVariable("math::max", (Import.FunctionInterface) (args) -> {
+                if (args.length == 1) {
+                    return NativeMath.maxArray(numericList("math::max", args[0]));
+                }
+                return Math.max(((Number) args[0]).doubleValue(), ((Number) args[1]).doubleValue());
+            });
+            env.setVariable("math::dot", (Import.FunctionInterface) (args) -> {
+                double[] a = numericList("math::dot", args[0]);
+                double[] b = numericList("math::dot", args[1]);
+                if (a.length != b.length) {
+                    throw new RuntimeException("math::dot expects lists of the same length");
+                }
+                return NativeMath.dotArray(a, b);
+            });
+            env.setVariable("math::prefixSum", (Import.FunctionInterface) (args) ->
+                FunctionHigherOrder.toList(NativeMath.prefixSumArray(numericList("math::prefixSum", args[0]))));
             // Add more math functions as needed
         }
     }
 
+    // Unbox a list argument of a math:: reduction
+    @SuppressWarnings("unchecked")
+    private static double[] numericList(String function, Object value) {
+        double[] values = value instanceof List ? FunctionHigherOrder.toDoubles((List<Object>) value) : null;
+        if (values == null) {
+            throw new RuntimeException(function + " expects a list of numbers");
+        }
+        return values;
+    }
+
     // IO module
     public static class IoModule implements Module {
         @Override
@@ -98,6 +225,80 @@ public class Import {
                 }
                 return null;
             });
+            // printBatch: prints every element of a list on its own line in one native call
+            env.setVariable("io::printBatch", (Import.FunctionInterface) (args) -> {
+                List<?> items = (List<?>) args[0];
+                String[] lines = new String[items.size()];
+                for (int i = 0; i < lines.length; i++) {
+                    lines[i] = String.valueOf(items.get(i));
+                }
+                NativeIo.printBatch(lines);
+                return null;
+            });
+            // setBufferMode: "none", "line" or "full", with an optional line count between flushes
+            env.setVariable("io::setBufferMode", (Import.FunctionInterface) (args) -> {
+                int flushLines = args.length > 1 ? ((Number) args[1]).intValue() : 0;
+                NativeIo.setBufferMode(NativeIo.parseBufferMode((String) args[0]), flushLines);
+                return null;
+            });
+            env.setVariable("io::flush", (Import.FunctionInterface) (args) -> {
+                NativeIo.flush();
+                return null;
+            });
+
+            // Files
+            env.setVariable("io::readFile", (Import.FunctionInterface) (args) -> NativeFile.readFile((String) args[0]));
+            env.setVariable("io::openReader", (Import.FunctionInterface) (args) -> {
+                String path = (String) args[0];
+                int handle = NativeFile.openReader(path);
+                if (handle < 0) {
+                    throw new RuntimeException("Cannot open file for reading: " + path);
+                }
+                return handle;
+            });
+            // readLines: io::readLines(reader[, maxLines]), an empty list at end of file
+            env.setVariable("io::readLines", (Import.FunctionInterface) (args) -> {
+                int handle = ((Number) args[0]).intValue();
+                int maxLines = args.length > 1 ? ((Number) args[1]).intValue() : 0;
+                return NativeFile.nextLines(handle, maxLines);
+            });
+            env.setVariable("io::closeReader", (Import.FunctionInterface) (args) -> {
+                NativeFile.closeReader(((Number) args[0]).intValue());
+                return null;
+            });
+            // openWriter: io::openWriter(path[, append])
+            env.setVariable("io::openWriter", (Import.FunctionInterface) (args) -> {
+                String path = (String) args[0];
+                boolean append = args.length > 1 && Boolean.TRUE.equals(args[1]);
+                int handle = NativeFile.openWriter(path, append);
+                if (handle < 0) {
+                    throw new RuntimeException("Cannot open file for writing: " + path);
+                }
+                return handle;
+            });
+            env.setVariable("io::write", (Import.FunctionInterface) (args) -> {
+                if (!NativeFile.write(((Number) args[0]).intValue(), String.valueOf(args[1]))) {
+                    throw new RuntimeException("Write failed");
+                }
+                return null;
+            });
+            env.setVariable("io::writeLines", (Import.FunctionInterface) (args) -> {
+                List<?> items = (List<?>) args[1];
+                String[] lines = new String[items.size()];
+                for (int i = 0; i < lines.length; i++) {
+                    lines[i] = String.valueOf(items.get(i));
+                }
+                if (!NativeFile.writeLines(((Number) args[0]).intValue(), lines)) {
+                    throw new RuntimeException("Write failed");
+                }
+                return null;
+            });
+            env.setVariable("io::closeWriter", (Import.FunctionInterface) (args) -> {
+                if (!NativeFile.closeWriter(((Number) args[0]).intValue())) {
+                    throw new RuntimeException("Closing file failed");
+                }
+                return null;
+            });
         }
     }
 
@@ -117,6 +318,23 @@ public class Import {
                 return NativeHttp.createServer(port);
             });
             
+            // http::createServerWithOptions(port, readTimeoutMs, writeTimeoutMs, idleTimeoutMs,
+            //                               maxHeaderBytes, maxConnections, h2c, listeners)
+            // Trailing arguments may be omitted; 0 keeps the default
+            env.setVariable("http::createServerWithOptions", (Import.FunctionInterface) (args) -> {
+                NativeHttp.checkLibrary();
+                int port = ((Number) args[0]).intValue();
+                int readTimeoutMs = args.length > 1 ? ((Number) args[1]).intValue() : 0;
+                int writeTimeoutMs = args.length > 2 ? ((Number) args[2]).intValue() : 0;
+                int idleTimeoutMs = args.length > 3 ? ((Number) args[3]).intValue() : 0;
+                int maxHeaderBytes = args.length > 4 ? ((Number) args[4]).intValue() : 0;
+                int maxConnections = args.length > 5 ? ((Number) args[5]).intValue() : 0;
+                boolean h2c = args.length > 6 && Boolean.TRUE.equals(args[6]);
+                int listeners = args.length > 7 ? ((Number) args[7]).intValue() : 1;
+                return NativeHttp.createServerWithOptions(port, readTimeoutMs, writeTimeoutMs, idleTimeoutMs,
+                                                          maxHeaderBytes, maxConnections, h2c, listeners);
+            });
+            
             env.setVariable("http::stopServer", (Import.FunctionInterface) (args) -> {
                 int serverHandle = ((Number) args[0]).intValue();
                 NativeHttp.stopServer(serverHandle);
@@ -146,12 +364,29 @@ public class Import {
                 return null;
             });
             
+            // Script handlers: http::startWorkers(server, threads[, queueCapacity])
+            env.setVariable("http::startWorkers", (Import.FunctionInterface) (args) -> {
+                int serverHandle = ((Number) args[0]).intValue();
+                int threads = args.length > 1 ? ((Number) args[1]).intValue() : 0;
+                int queueCapacity = args.length > 2 ? ((Number) args[2]).intValue() : 0;
+                HttpWorkerPool.start(serverHandle, env, threads, queueCapacity);
+                return null;
+            });
+            
+            // Serve requests on worker threads until the server stops
+            env.setVariable("http::listen", (Import.FunctionInterface) (args) -> {
+                int serverHandle = ((Number) args[0]).intValue();
+                int threads = args.length > 1 ? ((Number) args[1]).intValue() : 0;
+                HttpWorkerPool.start(serverHandle, env, threads, 0).join();
+                return null;
+            });
+            
             // Response utilities
             env.setVariable("http::setResponseHeader", (Import.FunctionInterface) (args) -> {
                 int requestId = ((Number) args[0]).intValue();
                 String name = (String) args[1];
                 String value = (String) args[2];
-                NativeHttp.setResponseHeader(requestId, name, value);
+                NativeHttp.setHeader(requestId, name, value);
                 return null;
             });
             
@@ -160,7 +395,7 @@ public class Import {
                 int statusCode = ((Number) args[1]).intValue();
                 String contentType = (String) args[2];
                 String body = (String) args[3];
-                NativeHttp.sendResponse(requestId, statusCode, contentType, body);
+                NativeHttp.respond(requestId, statusCode, contentType, body);
                 return null;
             });
             
@@ -207,6 +442,36 @@ public class Import {
                 return NativeHttp.getQueryParam(requestId, paramName);
             });
             
+            // Byte-oriented bodies
+            env.setVariable("http::getRequestBodyBytes", (Import.FunctionInterface) (args) -> {
+                int requestId = ((Number) args[0]).intValue();
+                return HttpBody.read(requestId);
+            });
+            
+            env.setVariable("http::sendResponseBytes", (Import.FunctionInterface) (args) -> {
+                int requestId = ((Number) args[0]).intValue();
+                int statusCode = ((Number) args[1]).intValue();
+                String contentType = (String) args[2];
+                HttpBody.send(requestId, statusCode, contentType, HttpBody.fromValue(args[3]));
+                return null;
+            });
+            
+            // Whole request in one native call: method, path, headers and query
+            env.setVariable("http::getRequest", (Import.FunctionInterface) (args) -> {
+                int requestId = ((Number) args[0]).intValue();
+                return HttpRequest.fetch(requestId).toStruct();
+            });
+            
+            env.setVariable("http::header", (Import.FunctionInterface) (args) -> {
+                String headerName = (String) args[1];
+                return HttpRequest.lookup(args[0], "headers", headerName);
+            });
+            
+            env.setVariable("http::query", (Import.FunctionInterface) (args) -> {
+                String paramName = (String) args[1];
+                return HttpRequest.lookup(args[0], "query", paramName);
+            });
+            
             // Middleware
             env.setVariable("http::useMiddleware", (Import.FunctionInterface) (args) -> {
                 int serverHandle = ((Number) args[0]).intValue();
@@ -258,6 +523,29 @@ public class Import {
                 NativeHttp.closeWebSocketConnection(endpointHandle, clientId);
                 return null;
             });
+            
+            // Deliver inbound messages to a script function: http::onWebSocketMessage(endpoint, "handler"[, batchSize])
+            env.setVariable("http::onWebSocketMessage", (Import.FunctionInterface) (args) -> {
+                int endpointHandle = ((Number) args[0]).intValue();
+                String handlerName = (String) args[1];
+                int batchSize = args.length > 2 ? ((Number) args[2]).intValue() : 0;
+                WebSocketDispatcher.start(endpointHandle, handlerName, env, batchSize);
+                return null;
+            });
+            
+            // Metrics: http::enableMetricsEndpoint(server[, "/metrics"]) serves Prometheus text
+            env.setVariable("http::enableMetricsEndpoint", (Import.FunctionInterface) (args) -> {
+                int serverHandle = ((Number) args[0]).intValue();
+                String path = args.length > 1 ? (String) args[1] : "/metrics";
+                NativeHttp.enableMetricsEndpoint(serverHandle, path);
+                return null;
+            });
+            
+            // Snapshot of the same counters as a JSON string
+            env.setVariable("http::getServerStats", (Import.FunctionInterface) (args) -> {
+                int serverHandle = ((Number) args[0]).intValue();
+                return NativeHttp.getServerStats(serverHandle);
+            });
         }
     }
 
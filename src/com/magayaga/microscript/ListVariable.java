@@ -6,26 +6,254 @@
  */
 package com.magayaga.microscript;
 
-import java.util.ArrayList;
+import java.util.AbstractList;
+import java.util.Arrays;
+import java.util.RandomAccess;
+import java.util.regex.Pattern;
+
+/**
+ * A MicroScript list. Lists whose elements are all Integer, all Long or
+ * all Double are stored unboxed in a long[] or double[]; the first insert
+ * of any other kind of element moves the list to Object[] storage for good.
+ * Elements read back as the same boxed type they were added as.
+ */
+public class ListVariable extends AbstractList<Object> implements RandomAccess {
+    private static final Pattern NUMBER_PATTERN = Pattern.compile("[-+]?(\\d+\\.?\\d*|\\.\\d+)");
+
+    private static final int EMPTY = 0;
+    private static final int INTEGER = 1; // Integer values in longs
+    private static final int LONG = 2;    // Long values in longs
+    private static final int DOUBLE = 3;  // Double values in doubles
+    private static final int OBJECT = 4;  // anything, in objects
+
+    private static final int DEFAULT_CAPACITY = 10;
+
+    private int kind = EMPTY;
+    private long[] longs;
+    private double[] doubles;
+    private Object[] objects;
+    private int size;
 
-public class ListVariable extends ArrayList<Object> {
     public ListVariable() {
         super();
     }
 
+    // Numeric elements are stored as numbers, everything else as trimmed strings
     public ListVariable(String[] elements) {
         for (String element : elements) {
-            this.add(element.trim());
+            String trimmed = element.trim();
+            if (NUMBER_PATTERN.matcher(trimmed).matches()) {
+                this.add(Double.parseDouble(trimmed));
+            } else {
+                this.add(trimmed);
+            }
         }
     }
-    
+
     public ListVariable(Object[] elements) {
         for (Object element : elements) {
             this.add(element);
         }
     }
-    
+
+    /**
+     * A Double list backed by values itself, without copying
+     */
+    public static ListVariable ofDoubles(double[] values) {
+        ListVariable list = new ListVariable();
+        list.kind = DOUBLE;
+        list.doubles = values;
+        list.size = values.length;
+        return list;
+    }
+
+    /**
+     * The elements as doubles, or null if any element is not a number.
+     * Packed lists copy their array without unboxing.
+     */
+    public double[] toDoubleArray() {
+        switch (kind) {
+            case EMPTY:
+                return new double[0];
+            case DOUBLE:
+                return Arrays.copyOf(doubles, size);
+            case INTEGER:
+            case LONG: {
+                double[] values = new double[size];
+                for (int i = 0; i < size; i++) {
+                    values[i] = longs[i];
+                }
+                return values;
+            }
+            default: {
+                double[] values = new double[size];
+                for (int i = 0; i < size; i++) {
+                    if (!(objects[i] instanceof Number)) {
+                        return null;
+                    }
+                    values[i] = ((Number) objects[i]).doubleValue();
+                }
+                return values;
+            }
+        }
+    }
+
+    @Override
+    public int size() {
+        return size;
+    }
+
+    @Override
     public Object get(int index) {
-        return super.get(index);
+        checkIndex(index, size);
+        switch (kind) {
+            case INTEGER:
+                return (int) longs[index];
+            case LONG:
+                return longs[index];
+            case DOUBLE:
+                return doubles[index];
+            default:
+                return objects[index];
+        }
+    }
+
+    @Override
+    public Object set(int index, Object element) {
+        checkIndex(index, size);
+        Object previous = get(index);
+        if (kindOf(element) != kind) {
+            inflate();
+        }
+        store(index, element);
+        return previous;
+    }
+
+    @Override
+    public void add(int index, Object element) {
+        checkIndex(index, size + 1);
+        int elementKind = kindOf(element);
+        if (kind == EMPTY) {
+            allocate(elementKind, DEFAULT_CAPACITY);
+        } else if (elementKind != kind) {
+            inflate();
+        }
+
+        ensureCapacity(size + 1);
+        Object array = backing();
+        System.arraycopy(array, index, array, index + 1, size - index);
+        store(index, element);
+        size++;
+        modCount++;
+    }
+
+    @Override
+    public Object remove(int index) {
+        checkIndex(index, size);
+        Object previous = get(index);
+        Object array = backing();
+        System.arraycopy(array, index + 1, array, index, size - index - 1);
+        size--;
+        if (kind == OBJECT) {
+            objects[size] = null;
+        }
+        modCount++;
+        return previous;
+    }
+
+    @Override
+    public void clear() {
+        kind = EMPTY;
+        longs = null;
+        doubles = null;
+        objects = null;
+        size = 0;
+        modCount++;
+    }
+
+    private static int kindOf(Object element) {
+        if (element instanceof Integer) {
+            return INTEGER;
+        }
+        if (element instanceof Long) {
+            return LONG;
+        }
+        if (element instanceof Double) {
+            return DOUBLE;
+        }
+        return OBJECT;
+    }
+
+    private void allocate(int newKind, int capacity) {
+        kind = newKind;
+        if (newKind == INTEGER || newKind == LONG) {
+            longs = new long[capacity];
+        } else if (newKind == DOUBLE) {
+            doubles = new double[capacity];
+        } else {
+            objects = new Object[capacity];
+        }
+    }
+
+    // Move to Object[] storage, boxing every element as get would
+    private void inflate() {
+        if (kind == OBJECT) {
+            return;
+        }
+        Object[] boxed = new Object[Math.max(size, DEFAULT_CAPACITY)];
+        for (int i = 0; i < size; i++) {
+            boxed[i] = get(i);
+        }
+        kind = OBJECT;
+        longs = null;
+        doubles = null;
+        objects = boxed;
+    }
+
+    private Object backing() {
+        if (kind == INTEGER || kind == LONG) {
+            return longs;
+        }
+        return kind == DOUBLE ? doubles : objects;
+    }
+
+    private void ensureCapacity(int required) {
+        int capacity = kind == INTEGER || kind == LONG ? longs.length
+            : kind == DOUBLE ? doubles.length : objects.length;
+        if (required <= capacity) {
+            return;
+        }
+        int grown = Math.max(required, capacity + (capacity >> 1));
+        if (kind == INTEGER || kind == LONG) {
+            longs = Arrays.copyOf(longs, grown);
+        } else if (kind == DOUBLE) {
+            doubles = Arrays.copyOf(doubles, grown);
+        } else {
+            objects = Arrays.copyOf(objects, grown);
+        }
+    }
+
+    // Callers have already matched the storage to the element
+    private void store(int index, Object element) {
+        switch (kind) {
+            case INTEGER:
+                longs[index] = (Integer) element;
+                break;
+            case LONG:
+                longs[index] = (Long) element;
+                break;
+            case DOUBLE:
+                doubles[index] = (Double) element;
+                break;
+            default:
+                objects[index] = element;
+                break;
+        }
+    }
+
+    private void checkIndex(int index, int bound) {
+        if (index < 0 || index >= bound) {
+            throw new IndexOutOfBoundsException("Index: " + index + ", Size: " + size);
+        }
     }
-}
\ No newline at end of file
+}
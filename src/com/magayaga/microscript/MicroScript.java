@@ -1,12 +1,15 @@
 /**
  * MicroScript — The programming language
- * Copyright (c) 2024-2025 Cyril John Magayaga
+ * Copyright (c) 2024-2026 Cyril John Magayaga
  * 
  * It was originally written in Java programming language.
  */
 package com.magayaga.microscript;
 
 import java.io.IOException;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.util.Arrays;
 import java.util.List;
 import java.util.Set;
 
@@ -18,6 +21,11 @@ public class MicroScript {
     
     // Constants for better maintainability
     private static final String RUN_COMMAND = "run";
+    private static final String COMPILE_COMMAND = "compile";
+    private static final String BENCH_COMMAND = "bench";
+    private static final String CACHE_OPTION = "--cache";
+    private static final String IO_BUFFER_OPTION = "--io-buffer=";
+    private static final String PROFILE_OPTION = "--profile";
     
     public static void main(String[] args) {
         // Handle CLI commands early return pattern
@@ -26,6 +34,20 @@ public class MicroScript {
             return;
         }
 
+        if (BENCH_COMMAND.equals(args[0])) {
+            Bench.main(Arrays.copyOfRange(args, 1, args.length));
+            return;
+        }
+
+        if (args.length >= 2 && COMPILE_COMMAND.equals(args[0])) {
+            if (hasValidExtension(args[1])) {
+                compileScript(args[1]);
+            } else {
+                printExtensionError(args[1]);
+            }
+            return;
+        }
+
         if (!isValidRunCommand(args)) {
             Cli.printUsage();
             return;
@@ -39,8 +61,26 @@ public class MicroScript {
             return;
         }
         
+        // Run options after the file name
+        boolean useCache = false;
+        Path profileOutput = null;
+        for (int i = 2; i < args.length; i++) {
+            if (args[i].startsWith(IO_BUFFER_OPTION)) {
+                NativeIo.setBufferMode(NativeIo.parseBufferMode(args[i].substring(IO_BUFFER_OPTION.length())), 0);
+            } else if (CACHE_OPTION.equals(args[i])) {
+                useCache = true;
+            } else if (PROFILE_OPTION.equals(args[i])) {
+                profileOutput = Profiler.defaultOutput(filePath);
+            } else if (args[i].startsWith(PROFILE_OPTION + "=")) {
+                profileOutput = Paths.get(args[i].substring(PROFILE_OPTION.length() + 1));
+            }
+        }
+        if (profileOutput != null) {
+            Profiler.start(Paths.get(filePath).getFileName().toString(), profileOutput);
+        }
+        
         // Execute MicroScript file
-        executeScript(filePath);
+        executeScript(filePath, useCache);
     }
     
     /**
@@ -68,7 +108,7 @@ public class MicroScript {
      * Efficiently checks if file has valid MicroScript extension using Set lookup
      * Time complexity: O(1) average case vs O(n) with List iteration
      */
-    private static boolean hasValidExtension(String filePath) {
+    static boolean hasValidExtension(String filePath) {
         // Find the last dot in the filename
         int lastDotIndex = filePath.lastIndexOf('.');
         if (lastDotIndex == -1 || lastDotIndex == filePath.length() - 1) {
@@ -87,20 +127,39 @@ public class MicroScript {
         System.err.println("The file '" + filePath + "' does not have a recognized MicroScript extension.");
     }
     
+    /**
+     * Writes the preprocessed form of a script to the script cache
+     */
+    private static void compileScript(String filePath) {
+        try {
+            System.out.println("Cached '" + filePath + "' as " + ScriptCache.compile(Paths.get(filePath)));
+        } catch (IOException e) {
+            System.err.println("Error compiling file '" + filePath + "': " + e.getMessage());
+        } catch (Exception e) {
+            System.err.println("Error compiling script '" + filePath + "': " + e.getMessage());
+        }
+    }
+    
     /**
      * Executes the MicroScript file with proper error handling
      */
-    private static void executeScript(String filePath) {
+    private static void executeScript(String filePath, boolean useCache) {
         try {
-            // Create Scanner object
-            Scanner scanner = new Scanner(filePath);
-            
-            // Read and preprocess lines
-            List<String> lines = scanner.readLines();
-            
-            // Preprocess macros
-            Define define = new Define();
-            List<String> preprocessedLines = define.preprocess(lines);
+            List<String> preprocessedLines;
+            if (useCache) {
+                // Preprocessed lines from the script cache, keyed by source hash
+                preprocessedLines = ScriptCache.load(Paths.get(filePath));
+            } else {
+                // Create Scanner object
+                Scanner scanner = new Scanner(filePath);
+                
+                // Read and preprocess lines
+                List<String> lines = scanner.readLines();
+                
+                // Preprocess macros
+                Define define = new Define();
+                preprocessedLines = define.preprocess(lines);
+            }
             
             // Parse and execute
             Parser parser = new Parser(preprocessedLines);
@@ -0,0 +1,63 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ * 
+ * Native file reading and writing for the io:: module.
+ */
+package com.magayaga.microscript;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+
+public class NativeFile {
+    public static final int DEFAULT_BATCH_LINES = 1024;
+
+    static {
+        System.loadLibrary("file"); // Loads file.dll or libfile.so
+        // Writers a script never closed must not lose their buffered output
+        Runtime.getRuntime().addShutdownHook(new Thread(NativeFile::flushWriters, "microscript-file-flush"));
+    }
+
+    // Readers: memory-mapped where possible, lines fetched in batches
+    public static native int openReader(String path);
+    public static native byte[] readLines(int handle, int maxLines);
+    public static native void closeReader(int handle);
+    public static native byte[] readAll(String path);
+
+    // Writers: large native buffer, flushed on close
+    public static native int openWriter(String path, boolean append);
+    public static native boolean write(int handle, String text);
+    public static native boolean writeLines(int handle, String[] lines);
+    public static native boolean closeWriter(int handle);
+    public static native void flushWriters();
+
+    /**
+     * Next batch of lines from a reader; an empty list at end of file
+     */
+    public static ListVariable nextLines(int handle, int maxLines) {
+        ListVariable lines = new ListVariable();
+        byte[] batch = readLines(handle, maxLines > 0 ? maxLines : DEFAULT_BATCH_LINES);
+        if (batch == null) {
+            return lines;
+        }
+
+        // Little-endian uint32 count, then length-prefixed UTF-8 lines
+        ByteBuffer buffer = ByteBuffer.wrap(batch).order(ByteOrder.LITTLE_ENDIAN);
+        int count = buffer.getInt();
+        for (int i = 0; i < count; i++) {
+            int length = buffer.getInt();
+            lines.add(new String(batch, buffer.position(), length, StandardCharsets.UTF_8));
+            buffer.position(buffer.position() + length);
+        }
+        return lines;
+    }
+
+    public static String readFile(String path) {
+        byte[] contents = readAll(path);
+        if (contents == null) {
+            throw new RuntimeException("Cannot read file: " + path);
+        }
+        return new String(contents, StandardCharsets.UTF_8);
+    }
+}
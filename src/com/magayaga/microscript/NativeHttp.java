@@ -6,10 +6,18 @@
  */
 package com.magayaga.microscript;
 
+import java.nio.ByteBuffer;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+
 public class NativeHttp {
     private static boolean libraryLoaded = false;
     private static String loadError = null;
     
+    // Mirrors the native intern table, capped at the same size
+    private static final int MAX_INTERNED = 1024;
+    private static final Map<String, Integer> internedIds = new ConcurrentHashMap<>();
+    
     static {
         try {
             System.loadLibrary("httpserver"); // Loads httpserver.dll or libhttpserver.so
@@ -32,6 +40,8 @@ public class NativeHttp {
     
     // HTTP Server core functions
     public static native int createServer(int port);
+    public static native int createServerWithOptions(int port, int readTimeoutMs, int writeTimeoutMs, int idleTimeoutMs,
+                                                     int maxHeaderBytes, int maxConnections, boolean h2c, int listeners);
     public static native void stopServer(int serverHandle);
     public static native boolean isRunning(int serverHandle);
     
@@ -39,18 +49,71 @@ public class NativeHttp {
     public static native void addRoute(int serverHandle, String method, String path, String handlerName);
     public static native void removeRoute(int serverHandle, String method, String path);
     
+    // Script dispatch
+    public static native void startDispatch(int serverHandle, int queueCapacity);
+    public static native long awaitRequest(int serverHandle, int timeoutMs);
+    public static native String getHandlerName(int serverHandle, int handlerSlot);
+    public static native void finishRequest(int requestId);
+    
     // Response utilities
     public static native void setResponseHeader(int requestId, String name, String value);
     public static native void sendResponse(int requestId, int statusCode, String contentType, String body);
     public static native void sendJsonResponse(int requestId, int statusCode, String jsonBody);
     public static native void sendFileResponse(int requestId, String filePath);
     
+    // Interned header names and content types
+    public static native int internString(String value);
+    public static native void setResponseHeaderInterned(int requestId, int nameId, String value);
+    public static native void sendResponseInterned(int requestId, int statusCode, int contentTypeId, String body);
+    
+    /**
+     * Native ID of a repeated string, or 0 when it cannot be interned.
+     * Only the first use of each string crosses into native code.
+     */
+    public static int intern(String value) {
+        if (value == null) {
+            return 0;
+        }
+        Integer id = internedIds.get(value);
+        if (id != null) {
+            return id;
+        }
+        if (internedIds.size() >= MAX_INTERNED) {
+            return 0;
+        }
+        return internedIds.computeIfAbsent(value, NativeHttp::internString);
+    }
+    
+    public static void setHeader(int requestId, String name, String value) {
+        int nameId = intern(name);
+        if (nameId > 0) {
+            setResponseHeaderInterned(requestId, nameId, value);
+        } else {
+            setResponseHeader(requestId, name, value);
+        }
+    }
+    
+    public static void respond(int requestId, int statusCode, String contentType, String body) {
+        int contentTypeId = intern(contentType);
+        if (contentTypeId > 0) {
+            sendResponseInterned(requestId, statusCode, contentTypeId, body);
+        } else {
+            sendResponse(requestId, statusCode, contentType, body);
+        }
+    }
+    
     // Request information
     public static native String getRequestPath(int requestId);
     public static native String getRequestMethod(int requestId);
     public static native String getRequestHeader(int requestId, String headerName);
     public static native String getRequestBody(int requestId);
     public static native String getQueryParam(int requestId, String paramName);
+    public static native byte[] getRequestSnapshot(int requestId);
+    
+    // Byte-oriented bodies (buffers must be direct)
+    public static native int getRequestBodyLength(int requestId);
+    public static native int readRequestBody(int requestId, ByteBuffer buffer, int offset, int length);
+    public static native void sendResponseBytes(int requestId, int statusCode, String contentType, ByteBuffer body, int offset, int length);
     
     // Middleware
     public static native void useMiddleware(int serverHandle, String middlewareName);
@@ -65,4 +128,10 @@ public class NativeHttp {
     public static native void sendWebSocketMessage(int endpointHandle, String clientId, String message);
     public static native void broadcastWebSocketMessage(int endpointHandle, String message);
     public static native void closeWebSocketConnection(int endpointHandle, String clientId);
+    public static native void enableWebSocketInbox(int endpointHandle, int capacity);
+    public static native byte[] drainWebSocketMessages(int endpointHandle, int maxMessages, int timeoutMs);
+    
+    // Metrics
+    public static native void enableMetricsEndpoint(int serverHandle, String path);
+    public static native String getServerStats(int serverHandle);
 }
\ No newline at end of file
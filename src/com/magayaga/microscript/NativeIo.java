@@ -1,16 +1,40 @@
 /**
  * MicroScript — The programming language
- * Copyright (c) 2025 Cyril John Magayaga
+ * Copyright (c) 2025-2026 Cyril John Magayaga
  * 
  * It was originally written in Java programming language.
  */
 package com.magayaga.microscript;
 
 public class NativeIo {
-    static { System.loadLibrary("io"); }
+    // Buffer modes for setBufferMode
+    public static final int UNBUFFERED = 0;
+    public static final int LINE = 1;
+    public static final int FULL = 2;
+
+    static {
+        System.loadLibrary("io");
+        // Buffered output must not be lost when the script ends
+        Runtime.getRuntime().addShutdownHook(new Thread(NativeIo::flush, "microscript-io-flush"));
+    }
 
     public static native void print(String message);
     public static native void print(int code);
     public static native void println(String message);
     public static native void println(int code);
+    public static native void printBatch(String[] lines);
+    public static native void flush();
+    public static native void setBufferMode(int mode, int flushLines);
+
+    /**
+     * Buffer mode by name: "none", "line" or "full"
+     */
+    public static int parseBufferMode(String name) {
+        switch (name) {
+            case "none": return UNBUFFERED;
+            case "line": return LINE;
+            case "full": return FULL;
+            default: throw new RuntimeException("Unknown IO buffer mode: " + name + " (expected none, line or full)");
+        }
+    }
 }
@@ -10,6 +10,13 @@ public class NativeMath {
     static {
         System.loadLibrary("math"); // Loads math.dll or math.so
     }
+    // Names of the values returned by constants(), in order (math::numbers::<name>)
+    public static final String[] CONSTANT_NAMES = {
+        "pi", "e", "tau", "phi", "silverRatio", "eulerConstant", "catalan",
+        "apery", "feigenbaumDelta", "feigenbaumAlpha", "plastic", "twinPrime"
+    };
+
+    public static native double[] constants();
     public static native double sqrt(double value);
     public static native double cbrt(double value);
     public static native double PI();
@@ -43,4 +50,50 @@ public class NativeMath {
     public static native double asinh(double value);
     public static native double acosh(double value);
     public static native double atanh(double value);
+    public static native double pow(double base, double exponent);
+
+    // Array variants: one native call per list instead of one per element
+    public static native double[] sqrtArray(double[] values);
+    public static native double[] squareArray(double[] values);
+    public static native double[] cubeArray(double[] values);
+    public static native double[] cbrtArray(double[] values);
+    public static native double[] absArray(double[] values);
+    public static native double[] logArray(double[] values);
+    public static native double[] log2Array(double[] values);
+    public static native double[] log10Array(double[] values);
+    public static native double[] sinArray(double[] values);
+    public static native double[] cosArray(double[] values);
+    public static native double[] tanArray(double[] values);
+    public static native double[] powArray(double[] values, double exponent);
+    public static native double[] fmaArray(double[] a, double[] b, double[] c);
+
+    // Reductions over numeric lists (microscript_stats.c)
+    public static native double sumArray(double[] values);
+    public static native double meanArray(double[] values);
+    public static native double varianceArray(double[] values, boolean sample);
+    public static native double minArray(double[] values);
+    public static native double maxArray(double[] values);
+    public static native double dotArray(double[] a, double[] b);
+    public static native double[] prefixSumArray(double[] values);
+
+    /**
+     * Apply the array kernel of a unary math builtin, or return null when
+     * the builtin has none
+     */
+    public static double[] applyArray(String name, double[] values) {
+        switch (name) {
+            case "sqrt": return sqrtArray(values);
+            case "square": return squareArray(values);
+            case "cube": return cubeArray(values);
+            case "cbrt": return cbrtArray(values);
+            case "abs": return absArray(values);
+            case "log": return logArray(values);
+            case "log2": return log2Array(values);
+            case "log10": return log10Array(values);
+            case "sin": return sinArray(values);
+            case "cos": return cosArray(values);
+            case "tan": return tanArray(values);
+            default: return null;
+        }
+    }
 }
\ No newline at end of file
@@ -17,6 +17,9 @@ public class Parser {
     private final List<String> lines;
     private final Environment environment;
 
+    // Set by an @memo line; applies to the next function declared
+    private boolean memoizeNextFunction = false;
+
     public Parser(com.magayaga.microscript.Scanner scanner) throws IOException {
         this.lines = scanner.readLines();
         this.environment = new Environment();
@@ -33,6 +36,11 @@ public class Parser {
     }
 
     public void parse() {
+        // Constants are known up front, so fold them once instead of per evaluation
+        if (Import.MathModule.isImported(lines)) {
+            lines.replaceAll(Import.MathModule::foldConstants);
+        }
+
         int i = 0;
         boolean hasCStyleMain = false;
         while (i < lines.size()) {
@@ -54,6 +62,13 @@ public class Parser {
                 continue;
             }
 
+            // @memo caches the results of the function that follows
+            if (line.equals("@memo")) {
+                memoizeNextFunction = true;
+                i++;
+                continue;
+            }
+
             // Handle @__globalfn__ block
             else if (line.startsWith("@__globalfn__")) {
                 // Support both forms:
@@ -328,7 +343,8 @@ public class Parser {
             body.add(lines.get(i).trim());
         }
 
-        environment.defineFunction(new Function(name, parameters, returnType, body));
+        environment.defineFunction(new Function(name, parameters, returnType, body, memoizeNextFunction));
+        memoizeNextFunction = false;
     }
         
     private int findClosingBrace(int start) {
@@ -357,8 +373,8 @@ public class Parser {
             return;
         }
 
-        // Handle @map statements
-        if (line.startsWith("@map")) {
+        // Handle @map and @pmap statements
+        if (line.startsWith("@map") || line.startsWith("@pmap")) {
             Executor executor = new Executor(environment);
             parseMapOperation(line, executor);
             return;
@@ -537,6 +553,11 @@ public class Parser {
                 continue;
             }
 
+            if (line.equals("@memo")) {
+                memoizeNextFunction = true;
+                continue;
+            }
+
             if (line.matches("^(String|Int32|Int64|Float32|Float64|fn)\\s+\\w+\\s*\\(.*\\)\\s*\\{")) {
                 int closingBraceIndex = findClosingBrace(i);
                 parseFunction(i, closingBraceIndex, prefix);
@@ -675,6 +696,51 @@ public class Parser {
         };
     }
     
+    /**
+     * Creates unary lambdas for parallel use; each call to the supplier
+     * gives a worker with its own Environment child
+     */
+    public java.util.function.Supplier<java.util.function.Function<Object, Object>> makeUnaryLambdaWorkers(String lambda, Executor executor) {
+        return () -> {
+            Environment workerEnv = new Environment(executor.getEnvironment());
+            Executor workerExecutor = new Executor(workerEnv);
+            return (arg) -> {
+                workerEnv.setVariable("it", arg);
+                return workerExecutor.evaluate(lambda);
+            };
+        };
+    }
+
+    /**
+     * Creates predicate lambdas for parallel use, one Environment child per worker
+     */
+    public java.util.function.Supplier<java.util.function.Function<Object, Boolean>> makePredicateLambdaWorkers(String lambda, Executor executor) {
+        return () -> {
+            Environment workerEnv = new Environment(executor.getEnvironment());
+            Executor workerExecutor = new Executor(workerEnv);
+            return (arg) -> {
+                workerEnv.setVariable("it", arg);
+                Object result = workerExecutor.evaluate(lambda);
+                return result instanceof Boolean ? (Boolean) result : false;
+            };
+        };
+    }
+
+    /**
+     * Creates binary lambdas for parallel use, one Environment child per worker
+     */
+    public java.util.function.Supplier<java.util.function.BiFunction<Object, Object, Object>> makeBinaryLambdaWorkers(String lambda, Executor executor) {
+        return () -> {
+            Environment workerEnv = new Environment(executor.getEnvironment());
+            Executor workerExecutor = new Executor(workerEnv);
+            return (arg1, arg2) -> {
+                workerEnv.setVariable("acc", arg1);
+                workerEnv.setVariable("it", arg2);
+                return workerExecutor.evaluate(lambda);
+            };
+        };
+    }
+
     /**
      * Parse @__globalfn__ block containing higher-order function operations
      */
@@ -689,8 +755,8 @@ public class Parser {
                 continue;
             }
             
-            // Handle @map operations
-            if (line.startsWith("@map")) {
+            // Handle @map and @pmap operations
+            if (line.startsWith("@map") || line.startsWith("@pmap")) {
                 parseMapOperation(line, executor);
             }
             // Add other higher-order function operations here
@@ -702,18 +768,20 @@ public class Parser {
     
     /**
      * Parse @map operation: @map => (operation) [list]
+     * @pmap takes the same form and maps large lists in parallel
      */
     public void parseMapOperation(String line, Executor executor) {
-        // Pattern: @map => (operation) [list]
-        Pattern mapPattern = Pattern.compile("@map\\s*=>\\s*(\\([^)]+\\))\\s*\\[([^\\]]+)\\]");
+        // Pattern: @map => (operation) [list] or @pmap => (operation) [list]
+        Pattern mapPattern = Pattern.compile("@(p?)map\\s*=>\\s*(\\([^)]+\\))\\s*\\[([^\\]]+)\\]");
         Matcher matcher = mapPattern.matcher(line);
         
         if (!matcher.find()) {
             throw new RuntimeException("Invalid @map syntax: " + line);
         }
         
-        String operation = matcher.group(1).trim();  // e.g., (*2)
-        String listExpression = matcher.group(2).trim();  // e.g., 1, 2, 3, 4
+        boolean parallel = !matcher.group(1).isEmpty();
+        String operation = matcher.group(2).trim();  // e.g., (*2)
+        String listExpression = matcher.group(3).trim();  // e.g., 1, 2, 3, 4
         
         // Parse the list elements
         List<Object> list = new ArrayList<>();
@@ -726,8 +794,15 @@ public class Parser {
             }
         }
         
+        // A single list-valued element, as in [numbers], maps over that list
+        if (list.size() == 1 && list.get(0) instanceof List) {
+            @SuppressWarnings("unchecked")
+            List<Object> values = (List<Object>) list.get(0);
+            list = values;
+        }
+        
         // Execute the map operation
-        List<Object> result = FunctionHigherOrder.processMap(operation, list);
+        List<Object> result = FunctionHigherOrder.processMap(operation, list, parallel);
         
         // Store the result in a temporary variable for potential use
         environment.setVariable("_last_map_result", result);
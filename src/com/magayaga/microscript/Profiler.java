@@ -0,0 +1,379 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * It was originally written in Java programming language.
+ */
+package com.magayaga.microscript;
+
+import java.io.IOException;
+import java.lang.management.GarbageCollectorMXBean;
+import java.lang.management.ManagementFactory;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.TreeMap;
+import java.util.concurrent.ConcurrentLinkedQueue;
+
+/**
+ * Per-function profiler behind the run command's --profile option.
+ *
+ * Every user function call and every call into a native module function
+ * (math::, http::, io:: and the other Import modules) is timed at its
+ * boundaries with System.nanoTime. Each thread keeps its own frame stack,
+ * call tree and counters, so a profiled call takes no locks; when the
+ * profiler is off the only cost is one static boolean check per call.
+ *
+ * At exit a table of calls and inclusive/exclusive times goes to stderr
+ * and the call tree is written in the folded-stack format read by
+ * flamegraph.pl and speedscope, one "a;b;c microseconds" line per stack.
+ */
+public final class Profiler {
+    // Deeper frames are folded into the frame at this depth
+    private static final int MAX_STACK_DEPTH = 512;
+    // Reads of a thread that changed its tables mid-read are retried this often
+    private static final int SNAPSHOT_ATTEMPTS = 3;
+
+    private static boolean enabled;
+    private static long startNanos;
+    private static Path outputFile;
+
+    private static final ConcurrentLinkedQueue<ThreadProfile> PROFILES = new ConcurrentLinkedQueue<>();
+    private static final ThreadLocal<ThreadProfile> PROFILE = ThreadLocal.withInitial(() -> {
+        ThreadProfile profile = new ThreadProfile();
+        PROFILES.add(profile);
+        return profile;
+    });
+
+    private Profiler() {
+    }
+
+    /**
+     * Start profiling a script run. The script itself is the root frame of
+     * the calling thread; the report is written when the JVM exits, so
+     * servers stopped with Ctrl-C are reported too.
+     */
+    public static void start(String scriptName, Path output) {
+        outputFile = output;
+        startNanos = System.nanoTime();
+        enabled = true;
+        enter(scriptName, false);
+        Runtime.getRuntime().addShutdownHook(new Thread(Profiler::report, "microscript-profiler"));
+    }
+
+    public static boolean isEnabled() {
+        return enabled;
+    }
+
+    /**
+     * Open a frame for a user function on the current thread
+     */
+    public static void enter(String name) {
+        enter(name, false);
+    }
+
+    /**
+     * Close the innermost frame of the current thread
+     */
+    public static void exit() {
+        long now = System.nanoTime();
+        PROFILE.get().pop(now);
+    }
+
+    /**
+     * Count a call answered from a memo table as a zero-time frame
+     */
+    public static void memoHit(String name) {
+        long now = System.nanoTime();
+        ThreadProfile profile = PROFILE.get();
+        profile.push(name, false, now);
+        profile.pop(now);
+    }
+
+    /**
+     * Call a native module function, timing it as a frame of its own when
+     * profiling is on
+     */
+    public static Object callNative(String name, Import.FunctionInterface function, Object[] args) {
+        if (!enabled) {
+            return function.call(args);
+        }
+        enter(name, true);
+        try {
+            return function.call(args);
+        } finally {
+            exit();
+        }
+    }
+
+    private static void enter(String name, boolean nativeFrame) {
+        PROFILE.get().push(name, nativeFrame, System.nanoTime());
+    }
+
+    // A call path; selfNanos is the exclusive time spent with this path on top
+    private static final class Node {
+        final String name;
+        final Node parent;
+        Map<String, Node> children;
+        long selfNanos;
+
+        Node(String name, Node parent) {
+            this.name = name;
+            this.parent = parent;
+        }
+
+        Node child(String childName) {
+            if (children == null) {
+                children = new HashMap<>();
+            }
+            Node child = children.get(childName);
+            if (child == null) {
+                child = new Node(childName, this);
+                children.put(childName, child);
+            }
+            return child;
+        }
+    }
+
+    private static final class Stats {
+        long calls;
+        long inclusiveNanos;
+        long exclusiveNanos;
+        int active; // frames of this function currently open, so recursion counts inclusive time once
+    }
+
+    private static final class ThreadProfile {
+        final String threadName = Thread.currentThread().getName();
+        final Node root = new Node("", null);
+        final Map<String, Stats> functions = new HashMap<>();
+        final Map<String, Stats> natives = new HashMap<>();
+
+        Node[] nodes = new Node[64];
+        Stats[] stats = new Stats[64];
+        long[] starts = new long[64];
+        long[] childNanos = new long[64];
+        int depth;
+
+        void push(String name, boolean nativeFrame, long now) {
+            if (depth == nodes.length) {
+                int grown = depth * 2;
+                nodes = Arrays.copyOf(nodes, grown);
+                stats = Arrays.copyOf(stats, grown);
+                starts = Arrays.copyOf(starts, grown);
+                childNanos = Arrays.copyOf(childNanos, grown);
+            }
+            Node parent = depth == 0 ? root : nodes[depth - 1];
+            nodes[depth] = depth < MAX_STACK_DEPTH ? parent.child(name) : parent;
+
+            Map<String, Stats> table = nativeFrame ? natives : functions;
+            Stats entry = table.get(name);
+            if (entry == null) {
+                entry = new Stats();
+                table.put(name, entry);
+            }
+            entry.active++;
+            stats[depth] = entry;
+            starts[depth] = now;
+            childNanos[depth] = 0;
+            depth++;
+        }
+
+        void pop(long now) {
+            if (depth == 0) {
+                return;
+            }
+            int top = --depth;
+            long inclusive = now - starts[top];
+            long exclusive = inclusive - childNanos[top];
+            Stats entry = stats[top];
+            entry.calls++;
+            entry.exclusiveNanos += exclusive;
+            if (--entry.active == 0) {
+                entry.inclusiveNanos += inclusive;
+            }
+            nodes[top].selfNanos += exclusive;
+            stats[top] = null;
+            nodes[top] = null;
+            if (top > 0) {
+                childNanos[top - 1] += inclusive;
+            }
+        }
+    }
+
+    /**
+     * Merged results of every thread. Frames still open when the report is
+     * taken (the script root, a server's accept loop) are counted up to now.
+     * Threads still running at exit are read without stopping them, so their
+     * last few calls may be missing, and a read that races with the thread
+     * adding a function or call path fails; see addConsistent.
+     */
+    private static final class Snapshot {
+        final Map<String, long[]> functions = new HashMap<>();
+        final Map<String, long[]> natives = new HashMap<>();
+        final Map<String, Long> folded = new TreeMap<>();
+
+        /**
+         * Add one thread's results, reading them into a separate snapshot
+         * first so a read that fails part-way leaves this one untouched.
+         * Returns false if every attempt raced with the thread.
+         */
+        boolean addConsistent(ThreadProfile profile, long now) {
+            for (int attempt = 0; attempt < SNAPSHOT_ATTEMPTS; attempt++) {
+                Snapshot part = new Snapshot();
+                try {
+                    part.add(profile, now);
+                } catch (RuntimeException e) {
+                    continue; // ConcurrentModificationException and the like; read again
+                }
+                absorb(part.functions, functions);
+                absorb(part.natives, natives);
+                for (Map.Entry<String, Long> entry : part.folded.entrySet()) {
+                    folded.merge(entry.getKey(), entry.getValue(), Long::sum);
+                }
+                return true;
+            }
+            return false;
+        }
+
+        private static void absorb(Map<String, long[]> from, Map<String, long[]> into) {
+            for (Map.Entry<String, long[]> entry : from.entrySet()) {
+                long[] totals = into.computeIfAbsent(entry.getKey(), key -> new long[3]);
+                for (int i = 0; i < totals.length; i++) {
+                    totals[i] += entry.getValue()[i];
+                }
+            }
+        }
+
+        private void add(ThreadProfile profile, long now) {
+            Map<Node, Long> openSelf = new HashMap<>();
+            Map<Stats, long[]> openTimes = new HashMap<>();
+            long innerInclusive = 0;
+            for (int i = profile.depth - 1; i >= 0; i--) {
+                long inclusive = now - profile.starts[i];
+                long exclusive = inclusive - profile.childNanos[i] - innerInclusive;
+                innerInclusive = inclusive;
+                if (profile.nodes[i] == null || profile.stats[i] == null) {
+                    continue; // popped while we were reading
+                }
+                openSelf.merge(profile.nodes[i], exclusive, Long::sum);
+                long[] times = openTimes.computeIfAbsent(profile.stats[i], key -> new long[3]);
+                times[0]++;
+                times[1] = inclusive; // outermost open frame wins
+                times[2] += exclusive;
+            }
+
+            merge(functions, profile.functions, openTimes);
+            merge(natives, profile.natives, openTimes);
+            fold(profile.root, new StringBuilder(), openSelf);
+        }
+
+        private static void merge(Map<String, long[]> into, Map<String, Stats> table, Map<Stats, long[]> open) {
+            for (Map.Entry<String, Stats> entry : table.entrySet()) {
+                Stats stats = entry.getValue();
+                long[] extra = open.getOrDefault(stats, new long[3]);
+                long[] totals = into.computeIfAbsent(entry.getKey(), key -> new long[3]);
+                totals[0] += stats.calls + extra[0];
+                totals[1] += stats.inclusiveNanos + extra[1];
+                totals[2] += stats.exclusiveNanos + extra[2];
+            }
+        }
+
+        private void fold(Node node, StringBuilder path, Map<Node, Long> openSelf) {
+            int length = path.length();
+            if (node.parent != null) {
+                if (node.parent.parent != null) {
+                    path.append(';');
+                }
+                path.append(node.name);
+                long micros = (node.selfNanos + openSelf.getOrDefault(node, 0L)) / 1000;
+                if (micros > 0) {
+                    folded.merge(path.toString(), micros, Long::sum);
+                }
+            }
+            if (node.children != null) {
+                for (Node child : new ArrayList<>(node.children.values())) {
+                    fold(child, path, openSelf);
+                }
+            }
+            path.setLength(length);
+        }
+    }
+
+    private static void report() {
+        long now = System.nanoTime();
+        enabled = false;
+
+        Snapshot snapshot = new Snapshot();
+        List<String> skipped = new ArrayList<>();
+        for (ThreadProfile profile : PROFILES) {
+            if (!snapshot.addConsistent(profile, now)) {
+                skipped.add(profile.threadName);
+            }
+        }
+
+        long gcMillis = 0;
+        long gcCount = 0;
+        for (GarbageCollectorMXBean collector : ManagementFactory.getGarbageCollectorMXBeans()) {
+            gcMillis += Math.max(0, collector.getCollectionTime());
+            gcCount += Math.max(0, collector.getCollectionCount());
+        }
+
+        StringBuilder out = new StringBuilder();
+        out.append(String.format("%nProfile: %.3f ms wall, %d ms in %d GC collections%n",
+            (now - startNanos) / 1e6, gcMillis, gcCount));
+        appendTable(out, "Function", snapshot.functions);
+        if (!snapshot.natives.isEmpty()) {
+            appendTable(out, "Native", snapshot.natives);
+        }
+        if (!skipped.isEmpty()) {
+            out.append("Partial profile: left out threads busy while being read: ")
+                .append(String.join(", ", skipped)).append(System.lineSeparator());
+        }
+
+        List<String> lines = new ArrayList<>(snapshot.folded.size());
+        for (Map.Entry<String, Long> entry : snapshot.folded.entrySet()) {
+            lines.add(entry.getKey() + " " + entry.getValue());
+        }
+        try {
+            Files.write(outputFile, lines, StandardCharsets.UTF_8);
+            out.append("Folded stacks written to ").append(outputFile).append(System.lineSeparator());
+        } catch (IOException e) {
+            out.append("Error writing folded stacks to ").append(outputFile).append(": ")
+                .append(e.getMessage()).append(System.lineSeparator());
+        }
+        System.err.print(out);
+        System.err.flush();
+    }
+
+    // Sorted by exclusive time, the usual first question
+    private static void appendTable(StringBuilder out, String heading, Map<String, long[]> rows) {
+        List<Map.Entry<String, long[]>> sorted = new ArrayList<>(rows.entrySet());
+        sorted.sort((a, b) -> Long.compare(b.getValue()[2], a.getValue()[2]));
+
+        int width = heading.length();
+        for (Map.Entry<String, long[]> row : sorted) {
+            width = Math.max(width, row.getKey().length());
+        }
+        String format = "%-" + width + "s  %10s  %14s  %14s%n";
+        out.append(String.format(format, heading, "Calls", "Inclusive ms", "Exclusive ms"));
+        for (Map.Entry<String, long[]> row : sorted) {
+            long[] totals = row.getValue();
+            out.append(String.format(format, row.getKey(), totals[0],
+                String.format("%.3f", totals[1] / 1e6), String.format("%.3f", totals[2] / 1e6)));
+        }
+    }
+
+    /**
+     * Default folded-stack file for a script: its path with a .folded extension
+     */
+    public static Path defaultOutput(String scriptPath) {
+        int dot = scriptPath.lastIndexOf('.');
+        return Paths.get((dot > 0 ? scriptPath.substring(0, dot) : scriptPath) + ".folded");
+    }
+}
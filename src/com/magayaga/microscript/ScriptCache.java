@@ -0,0 +1,159 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * It was originally written in Java programming language.
+ */
+package com.magayaga.microscript;
+
+import java.io.BufferedReader;
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.IOException;
+import java.io.StringReader;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.nio.file.StandardCopyOption;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.stream.Collectors;
+
+/**
+ * On-disk cache of preprocessed scripts. An entry holds the lines that
+ * Define.preprocess produced for a source file and is named after the
+ * SHA-256 of that source together with the entry format and
+ * Define.VERSION, so neither a changed script nor a changed preprocessor
+ * can hit a stale entry. A cached run skips macro expansion; reading the
+ * source once to hash it is the only remaining startup work before parsing.
+ *
+ * Entries live in ~/.microscript/cache unless the microscript.cache.dir
+ * system property or the MICROSCRIPT_CACHE_DIR variable says otherwise.
+ */
+public class ScriptCache {
+    private static final int MAGIC = 0x4D534331; // "MSC1"
+    private static final String FORMAT = "microscript-preprocessed-1;define-" + Define.VERSION;
+    private static final String EXTENSION = ".msc";
+
+    /**
+     * Preprocessed lines of a script, from the cache when possible. A miss
+     * preprocesses the source and stores the result for the next run.
+     */
+    public static List<String> load(Path script) throws IOException {
+        byte[] source = Files.readAllBytes(script);
+        Path entry = entryFor(source);
+
+        List<String> cached = read(entry);
+        if (cached != null) {
+            return cached;
+        }
+
+        List<String> lines = preprocess(source);
+        try {
+            write(entry, lines);
+        } catch (IOException e) {
+            // The cache is an optimization; an unwritable directory must not fail the run
+        }
+        return lines;
+    }
+
+    /**
+     * Preprocess a script and store its entry, replacing any existing one
+     */
+    public static Path compile(Path script) throws IOException {
+        byte[] source = Files.readAllBytes(script);
+        Path entry = entryFor(source);
+        write(entry, preprocess(source));
+        return entry;
+    }
+
+    private static List<String> preprocess(byte[] source) throws IOException {
+        // Same line splitting as Files.readAllLines
+        String text = new String(source, StandardCharsets.UTF_8);
+        List<String> lines;
+        try (BufferedReader reader = new BufferedReader(new StringReader(text))) {
+            lines = reader.lines().collect(Collectors.toCollection(ArrayList::new));
+        }
+        return new Define().preprocess(lines);
+    }
+
+    private static Path entryFor(byte[] source) {
+        try {
+            MessageDigest digest = MessageDigest.getInstance("SHA-256");
+            digest.update(FORMAT.getBytes(StandardCharsets.UTF_8));
+            byte[] hash = digest.digest(source);
+            StringBuilder name = new StringBuilder(hash.length * 2 + EXTENSION.length());
+            for (byte b : hash) {
+                name.append(Character.forDigit((b >> 4) & 0xF, 16)).append(Character.forDigit(b & 0xF, 16));
+            }
+            return cacheDirectory().resolve(name.append(EXTENSION).toString());
+        } catch (NoSuchAlgorithmException e) {
+            throw new IllegalStateException("SHA-256 is not available", e);
+        }
+    }
+
+    private static Path cacheDirectory() {
+        String configured = System.getProperty("microscript.cache.dir");
+        if (configured == null) {
+            configured = System.getenv("MICROSCRIPT_CACHE_DIR");
+        }
+        if (configured != null && !configured.isEmpty()) {
+            return Paths.get(configured);
+        }
+        return Paths.get(System.getProperty("user.home"), ".microscript", "cache");
+    }
+
+    // Entry layout: magic, line count, then each line as length-prefixed UTF-8
+    private static List<String> read(Path entry) {
+        byte[] bytes;
+        try {
+            bytes = Files.readAllBytes(entry);
+        } catch (IOException e) {
+            return null;
+        }
+
+        try (DataInputStream in = new DataInputStream(new ByteArrayInputStream(bytes))) {
+            if (in.readInt() != MAGIC) {
+                return null;
+            }
+            int count = in.readInt();
+            List<String> lines = new ArrayList<>(count);
+            for (int i = 0; i < count; i++) {
+                byte[] line = new byte[in.readInt()];
+                in.readFully(line);
+                lines.add(new String(line, StandardCharsets.UTF_8));
+            }
+            return lines;
+        } catch (IOException | RuntimeException e) {
+            return null; // truncated or corrupt entry: treat as a miss
+        }
+    }
+
+    private static void write(Path entry, List<String> lines) throws IOException {
+        ByteArrayOutputStream bytes = new ByteArrayOutputStream();
+        try (DataOutputStream out = new DataOutputStream(bytes)) {
+            out.writeInt(MAGIC);
+            out.writeInt(lines.size());
+            for (String line : lines) {
+                byte[] encoded = line.getBytes(StandardCharsets.UTF_8);
+                out.writeInt(encoded.length);
+                out.write(encoded);
+            }
+        }
+
+        // Write beside the entry and rename, so concurrent runs never read a partial file
+        Files.createDirectories(entry.getParent());
+        Path temp = Files.createTempFile(entry.getParent(), "entry", ".tmp");
+        try {
+            Files.write(temp, bytes.toByteArray());
+            Files.move(temp, entry, StandardCopyOption.REPLACE_EXISTING, StandardCopyOption.ATOMIC_MOVE);
+        } finally {
+            Files.deleteIfExists(temp);
+        }
+    }
+}
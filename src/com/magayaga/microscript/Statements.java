@@ -26,6 +26,21 @@ public class Statements {
         }
     }
     
+    // Thrown by a return nested inside a block of a function body; carries the
+    // returned value to the function. Raised once per call, so no stack trace.
+    public static class ReturnException extends RuntimeException {
+        private final Object value;
+        
+        public ReturnException(Object value) {
+            super("Return statement executed", null, false, false);
+            this.value = value;
+        }
+        
+        public Object getValue() {
+            return value;
+        }
+    }
+    
     /**
      * Processes conditional statements (if/elif/else blocks) in the code
      * Supports logical operators: ||, &&, ==, !=, <, >, <=, >=
@@ -187,8 +202,7 @@ public class Statements {
     private static Object evaluateCondition(String condition, Executor executor) {
         try {
             // Use the ExpressionEvaluator to handle complex conditions with logical operators
-            ExpressionEvaluator evaluator = new ExpressionEvaluator(condition, executor.getEnvironment());
-            return evaluator.parse();
+            return ExpressionCompiler.evaluate(condition, executor.getEnvironment());
         } catch (Exception e) {
             throw new RuntimeException("Error evaluating condition '" + condition + "': " + e.getMessage(), e);
         }
@@ -0,0 +1,102 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * It was originally written in Java programming language.
+ */
+package com.magayaga.microscript;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+
+/**
+ * Delivers inbound WebSocket messages to a MicroScript callback. The Go side
+ * buffers frames per endpoint; this thread drains them in batches, so the
+ * native crossing is paid once per batch instead of once per frame.
+ */
+public class WebSocketDispatcher {
+    private static final int DEFAULT_BATCH_SIZE = 64;
+    private static final int POLL_TIMEOUT_MS = 500;
+    private static final Map<Integer, WebSocketDispatcher> dispatchers = new ConcurrentHashMap<>();
+
+    private final int endpointHandle;
+    private final String handlerName;
+    private final Environment environment;
+    private final int batchSize;
+
+    private WebSocketDispatcher(int endpointHandle, String handlerName, Environment environment, int batchSize) {
+        this.endpointHandle = endpointHandle;
+        this.handlerName = handlerName;
+        this.environment = environment;
+        this.batchSize = batchSize > 0 ? batchSize : DEFAULT_BATCH_SIZE;
+    }
+
+    /**
+     * Route messages of an endpoint to handlerName(clientId, message), or to
+     * handlerName(message) when the callback takes a single parameter
+     */
+    public static void start(int endpointHandle, String handlerName, Environment environment, int batchSize) {
+        NativeHttp.checkLibrary();
+        dispatchers.computeIfAbsent(endpointHandle, handle -> {
+            NativeHttp.enableWebSocketInbox(handle, 0);
+            WebSocketDispatcher dispatcher = new WebSocketDispatcher(handle, handlerName, environment, batchSize);
+            Thread thread = new Thread(dispatcher::run, "microscript-ws-" + handle);
+            thread.setDaemon(true);
+            thread.start();
+            return dispatcher;
+        });
+    }
+
+    private void run() {
+        Executor executor = new Executor(environment);
+        try {
+            while (true) {
+                byte[] batch = NativeHttp.drainWebSocketMessages(endpointHandle, batchSize, POLL_TIMEOUT_MS);
+                if (batch == null) {
+                    break; // endpoint closed
+                }
+                if (batch.length > 0) {
+                    deliver(executor, batch);
+                }
+            }
+        } finally {
+            dispatchers.remove(endpointHandle, this);
+        }
+    }
+
+    /**
+     * Decode a drained batch: count, then clientId/message pairs, each
+     * prefixed by its little-endian uint32 byte length
+     */
+    private void deliver(Executor executor, byte[] batch) {
+        ByteBuffer buffer = ByteBuffer.wrap(batch).order(ByteOrder.LITTLE_ENDIAN);
+        int count = buffer.getInt();
+
+        Function handler = environment.getFunction(handlerName);
+        boolean withClientId = handler == null || handler.getParameters().size() != 1;
+
+        for (int i = 0; i < count; i++) {
+            String clientId = readString(buffer);
+            String message = readString(buffer);
+            try {
+                if (withClientId) {
+                    executor.callFunction(handlerName, clientId, message);
+                } else {
+                    executor.callFunction(handlerName, message);
+                }
+            } catch (RuntimeException e) {
+                System.err.println("WebSocket handler error in " + handlerName + ": " + e.getMessage());
+            }
+        }
+    }
+
+    private static String readString(ByteBuffer buffer) {
+        int length = buffer.getInt();
+        String value = new String(buffer.array(), buffer.position(), length, StandardCharsets.UTF_8);
+        buffer.position(buffer.position() + length);
+        return value;
+    }
+}
@@ -11,6 +11,7 @@ import java.util.regex.Matcher;
 import java.util.regex.Pattern;
 
 public class WhileLoop {
+    private static final Pattern WHILE_PATTERN = Pattern.compile("while\\s*\\((.+?)\\)\\s*(\\{)?");
     
     /**
      * Process a while loop statement in the code
@@ -23,8 +24,7 @@ public class WhileLoop {
         String line = lines.get(startIndex).trim();
         
         // Extract condition from while statement
-        Pattern whilePattern = Pattern.compile("while\\s*\\((.+?)\\)\\s*(\\{)?");
-        Matcher whileMatcher = whilePattern.matcher(line);
+        Matcher whileMatcher = WHILE_PATTERN.matcher(line);
         
         if (!whileMatcher.find()) {
             throw new RuntimeException("Invalid while loop syntax at line: " + line);
@@ -69,10 +69,14 @@ public class WhileLoop {
         final int MAX_ITERATIONS = 1000000;
         int iterations = 0;
         
+        // Classify the condition and body once rather than every iteration
+        CompiledBlock.Evaluation test = CompiledBlock.Evaluation.of(condition);
+        CompiledBlock body = CompiledBlock.of(lines, startIndex, endIndex, CompiledBlock.WHILE_LOOP);
+        
         // While loop execution
         while (iterations < MAX_ITERATIONS) {
             // Evaluate the condition
-            Object conditionResult = executor.evaluate(condition);
+            Object conditionResult = test.evaluate(executor);
             boolean conditionValue = isTruthyValue(conditionResult);
             
             // If condition is false, exit the loop
@@ -81,7 +85,7 @@ public class WhileLoop {
             }
             
             try {
-                executeLoopBlock(lines, startIndex, endIndex, executor);
+                body.execute(executor);
             } catch (Statements.BreakException e) {
                 break;
             } catch (Statements.ContinueException e) {
@@ -100,105 +104,6 @@ public class WhileLoop {
         }
     }
     
-    /**
-     * Execute a block of code within the loop
-     * @param lines List of code lines
-     * @param startIndex Start index of the block
-     * @param endIndex End index of the block
-     * @param executor The executor to use
-     * @return LoopControl indicating how the loop should proceed
-     */
-    private static void executeLoopBlock(List<String> lines, int startIndex, int endIndex, 
-                                        Executor executor) throws Statements.BreakException, Statements.ContinueException {
-        for (int i = startIndex; i < endIndex; i++) {
-            String line = lines.get(i).trim();
-            
-            // Skip empty lines and comments
-            if (line.isEmpty() || line.startsWith("//")) {
-                continue;
-            }
-            
-            // Handle multi-line comments
-            if (line.startsWith("/*")) {
-                while (i < endIndex && !lines.get(i).contains("*/")) {
-                    i++;
-                }
-                continue;
-            }
-            
-            // Handle break - throw exception to propagate up
-            if (line.equals("break") || line.equals("break;")) {
-                throw new Statements.BreakException();
-            }
-            
-            // Handle continue - throw exception to propagate up
-            if (line.equals("continue") || line.equals("continue;")) {
-                throw new Statements.ContinueException();
-            }
-            
-            // Handle return statements
-            if (line.startsWith("return")) {
-                executor.execute(line);
-                throw new Statements.BreakException(); // Treat return as break
-            }
-            
-            // Handle nested if statements
-            if (line.startsWith("if")) {
-                try {
-                    // Process the conditional statement and get the new index
-                    int newIndex = Statements.processConditionalStatement(lines, i, executor);
-                    
-                    // Make sure we advance properly
-                    if (newIndex > i) {
-                        i = newIndex - 1;
-                    }
-                } catch (Statements.BreakException | Statements.ContinueException e) {
-                    // Propagate break/continue from nested if
-                    throw e;
-                } catch (Exception e) {
-                    throw new RuntimeException("Error processing if statement in while loop: " + e.getMessage());
-                }
-                continue;
-            }
-            
-            // Handle nested while loops
-            if (line.startsWith("while")) {
-                try {
-                    // Process the nested while loop
-                    int newIndex = processWhileLoop(lines, i, executor);
-                    
-                    // Make sure we advance properly
-                    if (newIndex > i) {
-                        i = newIndex - 1;
-                    }
-                } catch (Exception e) {
-                    throw new RuntimeException("Error processing nested while loop: " + e.getMessage());
-                }
-                continue;
-            }
-            
-            // Handle for loops (if you have them)
-            if (line.startsWith("for")) {
-                try {
-                    int newIndex = ForLoop.processForLoop(lines, i, executor);
-                    if (newIndex > i) {
-                        i = newIndex - 1;
-                    }
-                } catch (Exception e) {
-                    throw new RuntimeException("Error processing for loop in while loop: " + e.getMessage());
-                }
-                continue;
-            }
-            
-            try {
-                // Execute regular statements (including variable assignments, increments/decrements, etc.)
-                executor.execute(line);
-            } catch (Exception e) {
-                throw new RuntimeException("Error executing statement in while loop: '" + line + "' - " + e.getMessage());
-            }
-        }
-    }
-    
     /**
      * Find the next line with an opening brace '{' (skipping comments/empty lines)
      * @param lines List of code lines
@@ -21,6 +21,9 @@ typedef struct { const char *p; ptrdiff_t n; } _GoString_;
 
 
 
+
+
+
 /* End of preamble from import "C" comments.  */
 
 
@@ -74,7 +77,30 @@ typedef struct { void *data; GoInt len; GoInt cap; } GoSlice;
 extern "C" {
 #endif
 
+
+// Start routing requests of this server to script workers. queueCapacity
+// bounds the number of requests waiting for a worker; 0 picks the default.
+//
+extern __declspec(dllexport) void startDispatch(GoInt serverHandle, GoInt queueCapacity);
+
+// Wait up to timeoutMs for the next queued request. Returns its ID and stores
+// the handler slot, -1 on timeout, or -2 once the server has stopped.
+//
+extern __declspec(dllexport) GoInt awaitRequest(GoInt serverHandle, GoInt timeoutMs, GoInt* handlerSlot);
+extern __declspec(dllexport) char* getHandlerName(GoInt serverHandle, GoInt handlerSlot);
+
+// Called by a worker once the script handler has returned. A handler that
+// never sent anything gets an empty 200 instead of waiting for the reaper.
+//
+extern __declspec(dllexport) void finishRequest(GoInt requestId);
 extern __declspec(dllexport) GoInt createServer(GoInt port);
+
+// Create a server with explicit limits. Timeouts are in milliseconds;
+// maxConnections caps open connections across all listeners; listeners > 1
+// binds that many SO_REUSEPORT sockets where the platform supports it.
+// Returns -1 if the port cannot be bound.
+//
+extern __declspec(dllexport) GoInt createServerWithOptions(GoInt port, GoInt readTimeoutMs, GoInt writeTimeoutMs, GoInt idleTimeoutMs, GoInt maxHeaderBytes, GoInt maxConnections, GoUint8 h2c, GoInt listeners);
 extern __declspec(dllexport) void stopServer(GoInt serverHandle);
 extern __declspec(dllexport) GoUint8 isRunning(GoInt serverHandle);
 
@@ -98,6 +124,34 @@ extern __declspec(dllexport) char* getRequestHeader(GoInt requestId, char* heade
 extern __declspec(dllexport) char* getRequestBody(GoInt requestId);
 extern __declspec(dllexport) char* getQueryParam(GoInt requestId, char* paramName);
 
+// Request snapshot
+//
+// getRequestSnapshot packs method, path, headers and query parameters into a
+// single malloc'd buffer so a handler can read every field with one native
+// call. Strings are length-prefixed UTF-8; all integers are little-endian
+// uint32:
+//
+//	method, path, headerCount, {name, value}..., queryCount, {name, value}...
+//
+// Repeated header or query keys appear once per value.
+// The caller owns the returned buffer and must free it.
+//
+extern __declspec(dllexport) char* getRequestSnapshot(GoInt requestId, GoInt* length);
+
+// Byte-oriented bodies
+//
+// These exchange raw memory owned by the caller (a direct ByteBuffer on the
+// Java side) instead of NUL-terminated strings, so binary payloads survive
+// and each direction is copied once: socket to buffer, or buffer to socket.
+//
+extern __declspec(dllexport) GoInt getRequestBodyLength(GoInt requestId);
+
+// Read up to capacity body bytes into dst; returns the count, 0 at end of
+// body, or -1 if the request is unknown or the read failed
+//
+extern __declspec(dllexport) GoInt readRequestBody(GoInt requestId, void* dst, GoInt capacity);
+extern __declspec(dllexport) void sendResponseBytes(GoInt requestId, GoInt statusCode, char* contentType, void* body, GoInt length);
+
 // Middleware
 //
 extern __declspec(dllexport) void useMiddleware(GoInt serverHandle, char* middlewareName);
@@ -112,6 +166,32 @@ extern __declspec(dllexport) void sendWebSocketMessage(GoInt endpointHandle, cha
 extern __declspec(dllexport) void broadcastWebSocketMessage(GoInt endpointHandle, char* message);
 extern __declspec(dllexport) void closeWebSocketConnection(GoInt endpointHandle, char* clientId);
 
+// Buffer inbound text frames for a script callback instead of echoing them.
+// capacity bounds the frames waiting to be drained; 0 picks the default.
+//
+extern __declspec(dllexport) void enableWebSocketInbox(GoInt endpointHandle, GoInt capacity);
+
+// Drain up to maxMessages buffered frames, waiting up to timeoutMs for the
+// first. The result is a malloc'd buffer in the snapshot encoding:
+//
+//	count, {clientId, message}...
+//
+// length is 0 when the wait timed out and -1 once the endpoint is closed.
+//
+extern __declspec(dllexport) char* drainWebSocketMessages(GoInt endpointHandle, GoInt maxMessages, GoInt timeoutMs, GoInt* length);
+extern __declspec(dllexport) GoInt internString(char* value);
+extern __declspec(dllexport) void setResponseHeaderInterned(GoInt requestId, GoInt nameId, char* value);
+extern __declspec(dllexport) void sendResponseInterned(GoInt requestId, GoInt statusCode, GoInt contentTypeId, void* body, GoInt length);
+
+// Serve Prometheus-format metrics for this server at path (e.g. "/metrics")
+//
+extern __declspec(dllexport) void enableMetricsEndpoint(GoInt serverHandle, char* path);
+
+// Return the server's counters, latency summaries and WebSocket client
+// counts as a JSON document
+//
+extern __declspec(dllexport) char* getServerStats(GoInt serverHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,180 @@
+package main
+
+import (
+	"compress/flate"
+	"compress/gzip"
+	"io"
+	"net/http"
+	"strconv"
+	"strings"
+	"sync"
+)
+
+// Response compression
+//
+// Enabled per server with useMiddleware(server, "gzip"). Bodies written by
+// the send* functions are compressed with gzip or deflate when the client
+// accepts it, the content type is compressible and the body is at least
+// compressMinSize bytes; smaller bodies cost more to frame than they save.
+// Encoders are pooled since each one carries a sizeable window.
+const compressMinSize = 1024
+
+var (
+	gzipWriters = sync.Pool{
+		New: func() any {
+			writer, _ := gzip.NewWriterLevel(io.Discard, gzip.DefaultCompression)
+			return writer
+		},
+	}
+	flateWriters = sync.Pool{
+		New: func() any {
+			writer, _ := flate.NewWriter(io.Discard, flate.DefaultCompression)
+			return writer
+		},
+	}
+)
+
+// Report whether the Accept-Encoding header allows the given coding
+func acceptsEncoding(acceptEncoding, coding string) bool {
+	for _, part := range strings.Split(acceptEncoding, ",") {
+		name, params, _ := strings.Cut(strings.TrimSpace(part), ";")
+		if !strings.EqualFold(strings.TrimSpace(name), coding) {
+			continue
+		}
+
+		quality := 1.0
+		for _, param := range strings.Split(params, ";") {
+			key, value, found := strings.Cut(strings.TrimSpace(param), "=")
+			if found && strings.TrimSpace(key) == "q" {
+				if parsed, err := strconv.ParseFloat(strings.TrimSpace(value), 64); err == nil {
+					quality = parsed
+				}
+			}
+		}
+		return quality > 0
+	}
+	return false
+}
+
+func isCompressible(contentType string) bool {
+	contentType = strings.ToLower(contentType)
+	switch {
+	case strings.HasPrefix(contentType, "text/"),
+		strings.HasPrefix(contentType, "application/json"),
+		strings.HasPrefix(contentType, "application/javascript"),
+		strings.HasPrefix(contentType, "application/xml"),
+		strings.HasPrefix(contentType, "image/svg+xml"),
+		strings.HasSuffix(contentType, "+json"),
+		strings.HasSuffix(contentType, "+xml"):
+		return true
+	}
+	return false
+}
+
+// Pick the content coding for a response body, or "" to send it as-is.
+// negotiated reports whether the choice depended on Accept-Encoding, in
+// which case the response must say so with Vary whichever way it went.
+func (request *RequestContext) negotiateCompression(statusCode, size int) (encoding string, negotiated bool) {
+	if request.server == nil || !request.server.compression.Load() {
+		return "", false
+	}
+	if statusCode == http.StatusNoContent || statusCode == http.StatusNotModified {
+		return "", false
+	}
+
+	header := request.w.Header()
+	if header.Get("Content-Encoding") != "" || !isCompressible(header.Get("Content-Type")) {
+		return "", false
+	}
+	if size < compressMinSize {
+		return "", true
+	}
+
+	acceptEncoding := request.r.Header.Get("Accept-Encoding")
+	switch {
+	case acceptsEncoding(acceptEncoding, "gzip"):
+		return "gzip", true
+	case acceptsEncoding(acceptEncoding, "deflate"):
+		return "deflate", true
+	}
+	return "", true
+}
+
+// Write status and body, compressing the body when negotiation allows it
+func (request *RequestContext) writeBody(statusCode int, body []byte) {
+	header := request.w.Header()
+	encoding, negotiated := request.negotiateCompression(statusCode, len(body))
+	if negotiated {
+		header.Add("Vary", "Accept-Encoding")
+	}
+	if encoding == "" {
+		header.Set("Content-Length", strconv.Itoa(len(body)))
+		request.w.WriteHeader(statusCode)
+		request.w.Write(body)
+		return
+	}
+
+	header.Set("Content-Encoding", encoding)
+	header.Del("Content-Length")
+	request.w.WriteHeader(statusCode)
+
+	switch encoding {
+	case "gzip":
+		writer := gzipWriters.Get().(*gzip.Writer)
+		writer.Reset(request.w)
+		writer.Write(body)
+		writer.Close()
+		gzipWriters.Put(writer)
+	case "deflate":
+		writer := flateWriters.Get().(*flate.Writer)
+		writer.Reset(request.w)
+		writer.Write(body)
+		writer.Close()
+		flateWriters.Put(writer)
+	}
+}
+
+// Pre-compressed assets
+//
+// When a client accepts br or gzip, sendFileResponse looks for a sibling
+// file with the matching suffix (app.js.br, app.js.gz) and serves it with
+// the original file's content type. Brotli is only available this way:
+// the standard library has no brotli encoder.
+var precompressedSiblings = []struct {
+	coding string
+	suffix string
+}{
+	{"br", ".br"},
+	{"gzip", ".gz"},
+}
+
+// Acquire the best pre-compressed sibling of path the client accepts
+func acquirePrecompressed(r *http.Request, path string) (*cachedFile, string) {
+	acceptEncoding := r.Header.Get("Accept-Encoding")
+	if acceptEncoding == "" {
+		return nil, ""
+	}
+
+	for _, sibling := range precompressedSiblings {
+		if !acceptsEncoding(acceptEncoding, sibling.coding) {
+			continue
+		}
+		if entry, err := staticFiles.acquire(path + sibling.suffix); err == nil {
+			return entry, sibling.coding
+		}
+	}
+	return nil, ""
+}
+
+// Middleware
+//
+// Built-in middleware selectable by name through useMiddleware
+var builtinMiddleware = map[string]func(server *HttpServer){
+	"gzip":        enableCompression,
+	"compress":    enableCompression,
+	"compression": enableCompression,
+}
+
+func enableCompression(server *HttpServer) {
+	server.compression.Store(true)
+}
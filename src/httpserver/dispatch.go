@@ -0,0 +1,170 @@
+package main
+
+import "C"
+import (
+	"net/http"
+	"sync"
+	"time"
+)
+
+// Script dispatch
+//
+// Route handlers are MicroScript functions run by a pool of JVM worker
+// threads. The serving goroutine pushes each request onto a bounded
+// per-server queue and waits; workers pull request IDs with awaitRequest and
+// answer through the usual send* calls. A full queue is answered with 503
+// right away instead of piling more goroutines onto the interpreter.
+const defaultDispatchCapacity = 1024
+
+type dispatchQueue struct {
+	requests chan *RequestContext
+	stopped  chan struct{}
+	stopOnce sync.Once
+}
+
+// Handler names are interned per server so a worker learns which script
+// function to run from a small slot number instead of a fresh C string
+type handlerTable struct {
+	mu    sync.RWMutex
+	slots map[string]int
+	names []string
+}
+
+func (table *handlerTable) slotFor(name string) int {
+	table.mu.Lock()
+	defer table.mu.Unlock()
+
+	if slot, exists := table.slots[name]; exists {
+		return slot
+	}
+	if table.slots == nil {
+		table.slots = make(map[string]int)
+	}
+
+	slot := len(table.names)
+	table.slots[name] = slot
+	table.names = append(table.names, name)
+	return slot
+}
+
+func (table *handlerTable) name(slot int) (string, bool) {
+	table.mu.RLock()
+	defer table.mu.RUnlock()
+
+	if slot < 0 || slot >= len(table.names) {
+		return "", false
+	}
+	return table.names[slot], true
+}
+
+// Enqueue without blocking; false means the queue is full or shut down
+func (queue *dispatchQueue) offer(request *RequestContext) bool {
+	select {
+	case <-queue.stopped:
+		return false
+	default:
+	}
+
+	select {
+	case queue.requests <- request:
+		return true
+	default:
+		return false
+	}
+}
+
+func (queue *dispatchQueue) stop() {
+	queue.stopOnce.Do(func() {
+		close(queue.stopped)
+	})
+
+	for {
+		select {
+		case request := <-queue.requests:
+			request.fail(http.StatusServiceUnavailable)
+		default:
+			return
+		}
+	}
+}
+
+func lookupServer(serverHandle int) (*HttpServer, bool) {
+	globalMu.Lock()
+	defer globalMu.Unlock()
+
+	server, exists := servers[serverHandle]
+	return server, exists
+}
+
+// Start routing requests of this server to script workers. queueCapacity
+// bounds the number of requests waiting for a worker; 0 picks the default.
+//
+//export startDispatch
+func startDispatch(serverHandle int, queueCapacity int) {
+	server, exists := lookupServer(serverHandle)
+	if !exists {
+		return
+	}
+
+	if queueCapacity <= 0 {
+		queueCapacity = defaultDispatchCapacity
+	}
+
+	server.dispatch.CompareAndSwap(nil, &dispatchQueue{
+		requests: make(chan *RequestContext, queueCapacity),
+		stopped:  make(chan struct{}),
+	})
+}
+
+// Wait up to timeoutMs for the next queued request. Returns its ID and stores
+// the handler slot, -1 on timeout, or -2 once the server has stopped.
+//
+//export awaitRequest
+func awaitRequest(serverHandle int, timeoutMs int, handlerSlot *int) int {
+	server, exists := lookupServer(serverHandle)
+	if !exists {
+		return -2
+	}
+
+	queue := server.dispatch.Load()
+	if queue == nil {
+		return -2
+	}
+
+	timer := time.NewTimer(time.Duration(timeoutMs) * time.Millisecond)
+	defer timer.Stop()
+
+	select {
+	case request := <-queue.requests:
+		*handlerSlot = request.handlerSlot
+		return request.id
+	case <-queue.stopped:
+		return -2
+	case <-timer.C:
+		return -1
+	}
+}
+
+//export getHandlerName
+func getHandlerName(serverHandle int, handlerSlot int) *C.char {
+	server, exists := lookupServer(serverHandle)
+	if !exists {
+		return C.CString("")
+	}
+
+	name, _ := server.handlers.name(handlerSlot)
+	return C.CString(name)
+}
+
+// Called by a worker once the script handler has returned. A handler that
+// never sent anything gets an empty 200 instead of waiting for the reaper.
+//
+//export finishRequest
+func finishRequest(requestId int) {
+	request, exists := lookupRequest(requestId)
+	if !exists || !request.claimResponse() {
+		return
+	}
+
+	request.finish()
+}
@@ -0,0 +1,220 @@
+package main
+
+import (
+	"container/list"
+	"fmt"
+	"io"
+	"mime"
+	"net/http"
+	"os"
+	"path/filepath"
+	"sync"
+	"time"
+)
+
+// Static file serving
+//
+// sendFileResponse goes through http.ServeContent, which brings byte ranges,
+// Content-Length and conditional GETs (ETag, If-Modified-Since). Open file
+// descriptors and their stat results are kept in a bounded LRU so hot assets
+// skip the open/stat syscalls; each entry is re-validated at most once per
+// fileCacheStatTTL. Large files are opened per request instead so that the
+// response writer can hand the *os.File to the kernel's sendfile.
+const (
+	fileCacheCapacity  = 256
+	fileCacheStatTTL   = time.Second
+	fileCacheMaxPooled = 64 * 1024
+)
+
+type cachedFile struct {
+	path        string
+	file        *os.File
+	size        int64
+	modTime     time.Time
+	etag        string
+	contentType string
+	checkedAt   time.Time
+	refs        int
+	evicted     bool
+	missing     bool
+	elem        *list.Element
+}
+
+type fileCache struct {
+	mu       sync.Mutex
+	entries  map[string]*cachedFile
+	lru      *list.List
+	capacity int
+}
+
+var staticFiles = &fileCache{
+	entries:  make(map[string]*cachedFile),
+	lru:      list.New(),
+	capacity: fileCacheCapacity,
+}
+
+// Get a referenced entry for path, opening or re-validating it as needed.
+// Callers must release the entry when done with its file descriptor.
+func (cache *fileCache) acquire(path string) (*cachedFile, error) {
+	now := time.Now()
+
+	cache.mu.Lock()
+	if entry, exists := cache.entries[path]; exists {
+		if now.Sub(entry.checkedAt) < fileCacheStatTTL {
+			if entry.missing {
+				cache.mu.Unlock()
+				return nil, os.ErrNotExist
+			}
+			entry.refs++
+			cache.lru.MoveToFront(entry.elem)
+			cache.mu.Unlock()
+			return entry, nil
+		}
+	}
+	cache.mu.Unlock()
+
+	// Stat outside the lock; a stale entry is replaced if the file changed
+	info, err := os.Stat(path)
+	if err == nil && info.IsDir() {
+		err = os.ErrNotExist
+	}
+
+	cache.mu.Lock()
+	defer cache.mu.Unlock()
+
+	// Misses are remembered too, so probing for absent siblings stays cheap
+	if err != nil {
+		if existing, exists := cache.entries[path]; exists {
+			cache.evictLocked(existing)
+		}
+		cache.insertLocked(&cachedFile{path: path, missing: true, checkedAt: now})
+		return nil, err
+	}
+
+	if entry, exists := cache.entries[path]; exists {
+		if !entry.missing && entry.size == info.Size() && entry.modTime.Equal(info.ModTime()) {
+			entry.checkedAt = now
+			entry.refs++
+			cache.lru.MoveToFront(entry.elem)
+			return entry, nil
+		}
+		cache.evictLocked(entry)
+	}
+
+	entry := &cachedFile{
+		path:        path,
+		size:        info.Size(),
+		modTime:     info.ModTime(),
+		etag:        fmt.Sprintf("\"%x-%x\"", info.ModTime().UnixNano(), info.Size()),
+		contentType: contentTypeForPath(path),
+		checkedAt:   now,
+		refs:        1,
+	}
+
+	// Only small files keep a pooled descriptor; see serveFile
+	if entry.size < fileCacheMaxPooled {
+		file, err := os.Open(path)
+		if err != nil {
+			return nil, err
+		}
+		entry.file = file
+	}
+
+	cache.insertLocked(entry)
+	return entry, nil
+}
+
+func (cache *fileCache) insertLocked(entry *cachedFile) {
+	entry.elem = cache.lru.PushFront(entry)
+	cache.entries[entry.path] = entry
+	for cache.lru.Len() > cache.capacity {
+		cache.evictLocked(cache.lru.Back().Value.(*cachedFile))
+	}
+}
+
+func (cache *fileCache) release(entry *cachedFile) {
+	cache.mu.Lock()
+	defer cache.mu.Unlock()
+
+	entry.refs--
+	if entry.evicted && entry.refs == 0 && entry.file != nil {
+		entry.file.Close()
+	}
+}
+
+// Forget path, so the next acquire stats it afresh
+func (cache *fileCache) remove(path string) {
+	cache.mu.Lock()
+	defer cache.mu.Unlock()
+
+	if entry, exists := cache.entries[path]; exists {
+		cache.evictLocked(entry)
+	}
+}
+
+// Drop an entry from the index; its descriptor closes once no response uses it
+func (cache *fileCache) evictLocked(entry *cachedFile) {
+	delete(cache.entries, entry.path)
+	cache.lru.Remove(entry.elem)
+	entry.evicted = true
+	if entry.refs == 0 && entry.file != nil {
+		entry.file.Close()
+	}
+}
+
+func contentTypeForPath(path string) string {
+	ext := filepath.Ext(path)
+	if contentType := mime.TypeByExtension(ext); contentType != "" {
+		return contentType
+	}
+	return getContentTypeFromExtension(ext)
+}
+
+// Serve a file with ServeContent semantics (ranges, conditional requests),
+// preferring a pre-compressed sibling when the client accepts one
+func serveFile(w http.ResponseWriter, r *http.Request, path string) {
+	entry, err := staticFiles.acquire(path)
+	if err != nil {
+		w.WriteHeader(http.StatusNotFound)
+		w.Write([]byte("File not found"))
+		return
+	}
+	defer staticFiles.release(entry)
+
+	w.Header().Set("Content-Type", entry.contentType)
+
+	if sibling, coding := acquirePrecompressed(r, path); sibling != nil {
+		defer staticFiles.release(sibling)
+
+		w.Header().Set("Content-Encoding", coding)
+		w.Header().Add("Vary", "Accept-Encoding")
+		serveEntry(w, r, sibling)
+		return
+	}
+
+	serveEntry(w, r, entry)
+}
+
+func serveEntry(w http.ResponseWriter, r *http.Request, entry *cachedFile) {
+	w.Header().Set("ETag", entry.etag)
+
+	// Pooled descriptors are shared, so read them with positioned reads
+	if entry.file != nil {
+		content := io.NewSectionReader(entry.file, 0, entry.size)
+		http.ServeContent(w, r, entry.path, entry.modTime, content)
+		return
+	}
+
+	// A fresh *os.File lets the response writer use sendfile
+	file, err := os.Open(entry.path)
+	if err != nil {
+		// Gone since its last stat; make the next request look again
+		staticFiles.remove(entry.path)
+		w.WriteHeader(http.StatusNotFound)
+		w.Write([]byte("File not found"))
+		return
+	}
+	defer file.Close()
+
+	http.ServeContent(w, r, entry.path, entry.modTime, file)
+}
@@ -0,0 +1,15 @@
+//go:build go1.24
+
+package main
+
+import (
+	"net/http"
+)
+
+// Serve HTTP/2 over cleartext connections alongside HTTP/1.x
+func enableH2C(srv *http.Server) {
+	protocols := new(http.Protocols)
+	protocols.SetHTTP1(true)
+	protocols.SetUnencryptedHTTP2(true)
+	srv.Protocols = protocols
+}
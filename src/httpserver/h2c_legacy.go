@@ -0,0 +1,13 @@
+//go:build !go1.24
+
+package main
+
+import (
+	"log"
+	"net/http"
+)
+
+// Cleartext HTTP/2 needs http.Protocols (Go 1.24); serve HTTP/1.x only
+func enableH2C(srv *http.Server) {
+	log.Printf("h2c requested but not supported by this Go version; serving HTTP/1.x")
+}
@@ -9,98 +9,382 @@ package main
 import (
 	"C"
 	"context"
+	"encoding/binary"
 	"fmt"
 	"io"
 	"log"
+	"net"
 	"net/http"
 	"net/url"
-	"os"
-	"path/filepath"
 	"sync"
+	"sync/atomic"
 	"time"
+	"unsafe"
 
 	"github.com/google/uuid"
-	"github.com/gorilla/mux"
 	"github.com/gorilla/websocket"
 )
 
 // Server management
 type HttpServer struct {
 	server      *http.Server
-	router      *mux.Router
+	router      *router
 	isRunning   bool
 	mu          sync.Mutex
 	wsEndpoints map[int]*WebSocketEndpoint
-	handlers    map[string]func(int)
+	handlers    handlerTable
+	dispatch    atomic.Pointer[dispatchQueue]
+	compression atomic.Bool
+	metrics     serverMetrics
 }
 
 type WebSocketEndpoint struct {
-	path      string
-	clients   map[string]*websocket.Conn
-	clientsMu sync.Mutex
+	path        string
+	clients     map[string]*wsClient
+	clientsMu   sync.RWMutex
+	inbox       atomic.Pointer[wsInbox]
+	messagesIn  atomic.Int64
+	messagesOut atomic.Int64
 }
 
 type RequestContext struct {
 	id          int
+	server      *HttpServer
 	w           http.ResponseWriter
 	r           *http.Request
+	mu          sync.Mutex
 	headersSent bool
+	failStatus  int
+	handlerSlot int
+	done        chan struct{}
+	doneOnce    sync.Once
+	reapSlot    int32
 }
 
 var (
 	servers         = make(map[int]*HttpServer)
-	requests        = make(map[int]*RequestContext)
 	serverCounter   = 0
-	requestCounter  = 0
 	endpointCounter = 0
 	globalMu        sync.Mutex
 )
 
+// Request registry
+//
+// In-flight requests live in a fixed set of shards keyed by request ID, so
+// concurrent handlers only contend when their IDs land on the same shard.
+// IDs come from an atomic counter and stay plain ints for the GoInt ABI.
+const requestShardCount = 64
+
+type requestShard struct {
+	mu       sync.RWMutex
+	requests map[int]*RequestContext
+	_        [32]byte // keep neighbouring shards on separate cache lines
+}
+
+var (
+	requestShards  [requestShardCount]requestShard
+	requestCounter int64
+)
+
+func init() {
+	for i := range requestShards {
+		requestShards[i].requests = make(map[int]*RequestContext)
+	}
+}
+
+func requestShardFor(requestId int) *requestShard {
+	return &requestShards[uint(requestId)%requestShardCount]
+}
+
+// Register a new request context and return it with its freshly allocated ID
+func registerRequest(server *HttpServer, w http.ResponseWriter, r *http.Request) *RequestContext {
+	reqID := int(atomic.AddInt64(&requestCounter, 1) - 1)
+	request := &RequestContext{
+		id:       reqID,
+		server:   server,
+		w:        w,
+		r:        r,
+		done:     make(chan struct{}),
+		reapSlot: -1,
+	}
+
+	// File the request with the reaper before any handler or worker can see
+	// it, so a response that arrives at once always finds it there to cancel
+	scheduleReap(request)
+
+	shard := requestShardFor(reqID)
+	shard.mu.Lock()
+	shard.requests[reqID] = request
+	shard.mu.Unlock()
+	return request
+}
+
+func lookupRequest(requestId int) (*RequestContext, bool) {
+	shard := requestShardFor(requestId)
+	shard.mu.RLock()
+	request, exists := shard.requests[requestId]
+	shard.mu.RUnlock()
+	return request, exists
+}
+
+func unregisterRequest(requestId int) {
+	shard := requestShardFor(requestId)
+	shard.mu.Lock()
+	delete(shard.requests, requestId)
+	shard.mu.Unlock()
+}
+
+// Claim the right to write the response; only the first caller wins
+func (request *RequestContext) claimResponse() bool {
+	request.mu.Lock()
+	defer request.mu.Unlock()
+
+	if request.headersSent {
+		return false
+	}
+	request.headersSent = true
+	return true
+}
+
+// Mark the response as written and wake the handler goroutine waiting on it
+func (request *RequestContext) finish() {
+	request.doneOnce.Do(func() {
+		cancelReap(request)
+		close(request.done)
+	})
+}
+
+// Block the serving goroutine until the response is written, the client goes
+// away, or the reaper gives up on the request. The ResponseWriter is only
+// valid while ServeHTTP is running, so the handler must not return earlier.
+func (request *RequestContext) await() {
+	select {
+	case <-request.done:
+	case <-request.r.Context().Done():
+		if !request.claimResponse() {
+			// A send is already writing; let it finish before returning
+			<-request.done
+		}
+		request.finish()
+	}
+
+	if request.failStatus != 0 {
+		http.Error(request.w, http.StatusText(request.failStatus), request.failStatus)
+	}
+}
+
+// Answer the request with an error status unless a send already claimed it.
+// The serving goroutine writes the status once it wakes up in await.
+func (request *RequestContext) fail(statusCode int) {
+	request.mu.Lock()
+	if request.headersSent {
+		request.mu.Unlock()
+		return
+	}
+	request.headersSent = true
+	request.failStatus = statusCode
+	request.mu.Unlock()
+
+	request.finish()
+}
+
+// Request reaper
+//
+// Abandoned requests (no send* call ever arrives) are expired by a single
+// timer wheel instead of one sleeping goroutine per request. Each request is
+// filed into the slot that the wheel reaches after requestTimeout; finishing
+// the request removes it again, so only in-flight requests are tracked.
+const (
+	requestTimeout  = 30 * time.Second
+	reaperTick      = time.Second
+	reaperSlotCount = 64 // must exceed requestTimeout / reaperTick
+)
+
+type reaperSlot struct {
+	mu       sync.Mutex
+	requests map[*RequestContext]struct{}
+}
+
+var (
+	reaperSlots  [reaperSlotCount]reaperSlot
+	reaperCursor int64
+	reaperOnce   sync.Once
+)
+
+func scheduleReap(request *RequestContext) {
+	reaperOnce.Do(startReaper)
+
+	ticks := int64(requestTimeout / reaperTick)
+	slotIndex := int((atomic.LoadInt64(&reaperCursor) + ticks) % reaperSlotCount)
+	slot := &reaperSlots[slotIndex]
+
+	slot.mu.Lock()
+	atomic.StoreInt32(&request.reapSlot, int32(slotIndex))
+	slot.requests[request] = struct{}{}
+	slot.mu.Unlock()
+}
+
+func cancelReap(request *RequestContext) {
+	slotIndex := atomic.LoadInt32(&request.reapSlot)
+	if slotIndex < 0 {
+		return
+	}
+
+	slot := &reaperSlots[slotIndex]
+	slot.mu.Lock()
+	delete(slot.requests, request)
+	slot.mu.Unlock()
+}
+
+func startReaper() {
+	for i := range reaperSlots {
+		reaperSlots[i].requests = make(map[*RequestContext]struct{})
+	}
+
+	go func() {
+		ticker := time.NewTicker(reaperTick)
+		defer ticker.Stop()
+
+		for range ticker.C {
+			cursor := atomic.AddInt64(&reaperCursor, 1)
+			slot := &reaperSlots[cursor%reaperSlotCount]
+
+			slot.mu.Lock()
+			expired := slot.requests
+			slot.requests = make(map[*RequestContext]struct{})
+			slot.mu.Unlock()
+
+			for request := range expired {
+				request.fail(http.StatusGatewayTimeout)
+			}
+		}
+	}()
+}
+
+// Tunables for createServerWithOptions; zero values keep net/http defaults
+type serverOptions struct {
+	readTimeout    time.Duration
+	writeTimeout   time.Duration
+	idleTimeout    time.Duration
+	maxHeaderBytes int
+	maxConnections int
+	h2c            bool
+	listeners      int
+}
+
 //export createServer
 func createServer(port int) int {
-	globalMu.Lock()
-	defer globalMu.Unlock()
+	return startServer(port, serverOptions{})
+}
 
-	serverID := serverCounter
-	serverCounter++
+// Create a server with explicit limits. Timeouts are in milliseconds;
+// maxConnections caps open connections across all listeners; listeners > 1
+// binds that many SO_REUSEPORT sockets where the platform supports it.
+// Returns -1 if the port cannot be bound.
+//
+//export createServerWithOptions
+func createServerWithOptions(port int, readTimeoutMs, writeTimeoutMs, idleTimeoutMs, maxHeaderBytes, maxConnections int, h2c bool, listeners int) int {
+	return startServer(port, serverOptions{
+		readTimeout:    time.Duration(readTimeoutMs) * time.Millisecond,
+		writeTimeout:   time.Duration(writeTimeoutMs) * time.Millisecond,
+		idleTimeout:    time.Duration(idleTimeoutMs) * time.Millisecond,
+		maxHeaderBytes: maxHeaderBytes,
+		maxConnections: maxConnections,
+		h2c:            h2c,
+		listeners:      listeners,
+	})
+}
 
-	router := mux.NewRouter()
+// Bind the listeners up front so the server is accepting connections by the
+// time the handle is returned; serving then continues in the background
+func startServer(port int, options serverOptions) int {
+	router := newRouter()
 	srv := &http.Server{
-		Addr:    fmt.Sprintf(":%d", port),
-		Handler: router,
+		Addr:           fmt.Sprintf(":%d", port),
+		Handler:        router,
+		ReadTimeout:    options.readTimeout,
+		WriteTimeout:   options.writeTimeout,
+		IdleTimeout:    options.idleTimeout,
+		MaxHeaderBytes: options.maxHeaderBytes,
+	}
+	if options.h2c {
+		enableH2C(srv)
+	}
+
+	listeners, err := listen(srv.Addr, options)
+	if err != nil {
+		log.Printf("HTTP server error: %v", err)
+		return -1
 	}
 
 	server := &HttpServer{
 		server:      srv,
 		router:      router,
-		isRunning:   false,
+		isRunning:   true,
 		wsEndpoints: make(map[int]*WebSocketEndpoint),
-		handlers:    make(map[string]func(int)),
 	}
 
+	globalMu.Lock()
+	serverID := serverCounter
+	serverCounter++
 	servers[serverID] = server
+	globalMu.Unlock()
 
-	// Start the server in a goroutine
-	go func() {
-		server.mu.Lock()
-		server.isRunning = true
-		server.mu.Unlock()
+	// Serve every listener in its own goroutine
+	var serving sync.WaitGroup
+	for _, listener := range listeners {
+		serving.Add(1)
+		go func(listener net.Listener) {
+			defer serving.Done()
 
-		err := srv.ListenAndServe()
-		if err != nil && err != http.ErrServerClosed {
-			log.Printf("HTTP server error: %v", err)
-		}
+			err := srv.Serve(listener)
+			if err != nil && err != http.ErrServerClosed {
+				log.Printf("HTTP server error: %v", err)
+			}
+		}(listener)
+	}
+
+	go func() {
+		serving.Wait()
 
 		server.mu.Lock()
 		server.isRunning = false
 		server.mu.Unlock()
 	}()
 
-	// Wait a bit to ensure the server starts
-	time.Sleep(100 * time.Millisecond)
 	return serverID
 }
 
+func listen(address string, options serverOptions) ([]net.Listener, error) {
+	count := options.listeners
+	if count < 1 || !reusePortSupported {
+		count = 1
+	}
+
+	config := net.ListenConfig{}
+	if count > 1 {
+		config.Control = setReusePort
+	}
+
+	var slots connSlots
+	if options.maxConnections > 0 {
+		slots = make(connSlots, options.maxConnections)
+	}
+
+	listeners := make([]net.Listener, 0, count)
+	for i := 0; i < count; i++ {
+		listener, err := config.Listen(context.Background(), "tcp", address)
+		if err != nil {
+			for _, opened := range listeners {
+				opened.Close()
+			}
+			return nil, err
+		}
+		listeners = append(listeners, newLimitListener(listener, slots))
+	}
+	return listeners, nil
+}
+
 //export stopServer
 func stopServer(serverHandle int) {
 	globalMu.Lock()
@@ -111,6 +395,11 @@ func stopServer(serverHandle int) {
 	}
 	globalMu.Unlock()
 
+	// Release the script workers and reject anything still queued
+	if queue := server.dispatch.Load(); queue != nil {
+		queue.stop()
+	}
+
 	server.mu.Lock()
 	defer server.mu.Unlock()
 
@@ -126,7 +415,15 @@ func stopServer(serverHandle int) {
 
 	globalMu.Lock()
 	delete(servers, serverHandle)
+	endpoints := server.wsEndpoints
+	server.wsEndpoints = make(map[int]*WebSocketEndpoint)
 	globalMu.Unlock()
+
+	// Hijacked WebSocket connections outlive Shutdown, so close them here
+	for endpointID, endpoint := range endpoints {
+		unindexWebSocketEndpoint(endpointID)
+		endpoint.closeAll()
+	}
 }
 
 //export isRunning
@@ -159,152 +456,106 @@ func addRoute(serverHandle int, method, path, handlerName *C.char) {
 
 	methodStr := C.GoString(method)
 	pathStr := C.GoString(path)
-	handlerNameStr := C.GoString(handlerName)
+	handlerSlot := server.handlers.slotFor(C.GoString(handlerName))
 
 	handler := func(w http.ResponseWriter, r *http.Request) {
-		globalMu.Lock()
-		reqID := requestCounter
-		requestCounter++
-
-		// Store request context
-		requests[reqID] = &RequestContext{
-			id:          reqID,
-			w:           w,
-			r:           r,
-			headersSent: false,
+		// Store request context for the lifetime of this call
+		request := registerRequest(server, w, r)
+		request.handlerSlot = handlerSlot
+		defer unregisterRequest(request.id)
+		// Requests turned away below never reach await; finish takes them out of the reaper
+		defer request.finish()
+
+		// Hand the request to the script workers and wait for their response
+		queue := server.dispatch.Load()
+		if queue == nil {
+			return
 		}
-		globalMu.Unlock()
-
-		// Call the registered handler by name
-		if handlerFunc, exists := server.handlers[handlerNameStr]; exists {
-			handlerFunc(reqID)
+		if !queue.offer(request) {
+			w.Header().Set("Retry-After", "1")
+			http.Error(w, http.StatusText(http.StatusServiceUnavailable), http.StatusServiceUnavailable)
+			return
 		}
-
-		// Clean up request context after a delay to ensure all processing is done
-		go func() {
-			time.Sleep(30 * time.Second)
-			globalMu.Lock()
-			delete(requests, reqID)
-			globalMu.Unlock()
-		}()
+		request.await()
 	}
 
-	server.router.HandleFunc(pathStr, handler).Methods(methodStr)
+	route := server.metrics.route(methodStr, pathStr)
+	server.router.handle(methodStr, pathStr, server.metrics.instrument(route, handler))
 }
 
 //export removeRoute
 func removeRoute(serverHandle int, method, path *C.char) {
-	// Note: mux doesn't directly support route removal
-	// In a real implementation, you might need to recreate the router
-	// For simplicity, this is a placeholder
+	server, exists := lookupServer(serverHandle)
+	if !exists {
+		return
+	}
+
+	server.router.remove(C.GoString(method), C.GoString(path))
 }
 
 // Response utilities
 //
 //export setResponseHeader
 func setResponseHeader(requestId int, name, value *C.char) {
-	globalMu.Lock()
-	defer globalMu.Unlock()
-
-	request, exists := requests[requestId]
+	request, exists := lookupRequest(requestId)
 	if !exists {
 		return
 	}
 
+	nameStr := C.GoString(name)
+	valueStr := C.GoString(value)
+
+	request.mu.Lock()
+	defer request.mu.Unlock()
+
 	if request.headersSent {
 		return
 	}
 
-	nameStr := C.GoString(name)
-	valueStr := C.GoString(value)
 	request.w.Header().Set(nameStr, valueStr)
 }
 
 //export sendResponse
 func sendResponse(requestId int, statusCode int, contentType, body *C.char) {
-	globalMu.Lock()
-	request, exists := requests[requestId]
-	if !exists {
-		globalMu.Unlock()
-		return
-	}
-
-	if request.headersSent {
-		globalMu.Unlock()
+	request, exists := lookupRequest(requestId)
+	if !exists || !request.claimResponse() {
 		return
 	}
 
 	contentTypeStr := C.GoString(contentType)
 	bodyStr := C.GoString(body)
 
-	request.headersSent = true
-	globalMu.Unlock()
+	defer request.finish()
 
 	request.w.Header().Set("Content-Type", contentTypeStr)
-	request.w.WriteHeader(statusCode)
-	request.w.Write([]byte(bodyStr))
+	request.writeBody(statusCode, []byte(bodyStr))
 }
 
 //export sendJsonResponse
 func sendJsonResponse(requestId int, statusCode int, jsonBody *C.char) {
-	globalMu.Lock()
-	request, exists := requests[requestId]
-	if !exists {
-		globalMu.Unlock()
-		return
-	}
-
-	if request.headersSent {
-		globalMu.Unlock()
+	request, exists := lookupRequest(requestId)
+	if !exists || !request.claimResponse() {
 		return
 	}
 
 	bodyStr := C.GoString(jsonBody)
-
-	request.headersSent = true
-	globalMu.Unlock()
+	defer request.finish()
 
 	request.w.Header().Set("Content-Type", "application/json")
-	request.w.WriteHeader(statusCode)
-	request.w.Write([]byte(bodyStr))
+	request.writeBody(statusCode, []byte(bodyStr))
 }
 
 //export sendFileResponse
 func sendFileResponse(requestId int, filePath *C.char) {
-	globalMu.Lock()
-	request, exists := requests[requestId]
-	if !exists {
-		globalMu.Unlock()
-		return
-	}
-
-	if request.headersSent {
-		globalMu.Unlock()
+	request, exists := lookupRequest(requestId)
+	if !exists || !request.claimResponse() {
 		return
 	}
 
 	filePathStr := C.GoString(filePath)
+	defer request.finish()
 
-	request.headersSent = true
-	globalMu.Unlock()
-
-	// Check if file exists
-	file, err := os.Open(filePathStr)
-	if err != nil {
-		request.w.WriteHeader(http.StatusNotFound)
-		request.w.Write([]byte("File not found"))
-		return
-	}
-	defer file.Close()
-
-	// Set content type based on file extension
-	ext := filepath.Ext(filePathStr)
-	contentType := getContentTypeFromExtension(ext)
-	request.w.Header().Set("Content-Type", contentType)
-
-	// Send file
-	request.w.WriteHeader(http.StatusOK)
-	io.Copy(request.w, file)
+	serveFile(request.w, request.r, filePathStr)
 }
 
 // Get content type based on file extension
@@ -337,10 +588,7 @@ func getContentTypeFromExtension(ext string) string {
 //
 //export getRequestPath
 func getRequestPath(requestId int) *C.char {
-	globalMu.Lock()
-	defer globalMu.Unlock()
-
-	request, exists := requests[requestId]
+	request, exists := lookupRequest(requestId)
 	if !exists {
 		return C.CString("")
 	}
@@ -350,10 +598,7 @@ func getRequestPath(requestId int) *C.char {
 
 //export getRequestMethod
 func getRequestMethod(requestId int) *C.char {
-	globalMu.Lock()
-	defer globalMu.Unlock()
-
-	request, exists := requests[requestId]
+	request, exists := lookupRequest(requestId)
 	if !exists {
 		return C.CString("")
 	}
@@ -363,10 +608,7 @@ func getRequestMethod(requestId int) *C.char {
 
 //export getRequestHeader
 func getRequestHeader(requestId int, headerName *C.char) *C.char {
-	globalMu.Lock()
-	defer globalMu.Unlock()
-
-	request, exists := requests[requestId]
+	request, exists := lookupRequest(requestId)
 	if !exists {
 		return C.CString("")
 	}
@@ -377,10 +619,7 @@ func getRequestHeader(requestId int, headerName *C.char) *C.char {
 
 //export getRequestBody
 func getRequestBody(requestId int) *C.char {
-	globalMu.Lock()
-	request, exists := requests[requestId]
-	globalMu.Unlock()
-
+	request, exists := lookupRequest(requestId)
 	if !exists {
 		return C.CString("")
 	}
@@ -396,10 +635,7 @@ func getRequestBody(requestId int) *C.char {
 
 //export getQueryParam
 func getQueryParam(requestId int, paramName *C.char) *C.char {
-	globalMu.Lock()
-	defer globalMu.Unlock()
-
-	request, exists := requests[requestId]
+	request, exists := lookupRequest(requestId)
 	if !exists {
 		return C.CString("")
 	}
@@ -408,12 +644,139 @@ func getQueryParam(requestId int, paramName *C.char) *C.char {
 	return C.CString(request.r.URL.Query().Get(paramNameStr))
 }
 
+// Request snapshot
+//
+// getRequestSnapshot packs method, path, headers and query parameters into a
+// single malloc'd buffer so a handler can read every field with one native
+// call. Strings are length-prefixed UTF-8; all integers are little-endian
+// uint32:
+//
+//	method, path, headerCount, {name, value}..., queryCount, {name, value}...
+//
+// Repeated header or query keys appear once per value.
+// The caller owns the returned buffer and must free it.
+//
+//export getRequestSnapshot
+func getRequestSnapshot(requestId int, length *int) *C.char {
+	*length = 0
+
+	request, exists := lookupRequest(requestId)
+	if !exists {
+		return nil
+	}
+
+	query := request.r.URL.Query()
+	buf := make([]byte, 0, 512)
+	buf = appendSnapshotString(buf, request.r.Method)
+	buf = appendSnapshotString(buf, request.r.URL.Path)
+	buf = appendSnapshotPairs(buf, request.r.Header)
+	buf = appendSnapshotPairs(buf, query)
+
+	*length = len(buf)
+	return (*C.char)(C.CBytes(buf))
+}
+
+func appendSnapshotString(buf []byte, value string) []byte {
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(len(value)))
+	return append(buf, value...)
+}
+
+func appendSnapshotPairs(buf []byte, pairs map[string][]string) []byte {
+	count := 0
+	for _, values := range pairs {
+		count += len(values)
+	}
+
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(count))
+	for name, values := range pairs {
+		for _, value := range values {
+			buf = appendSnapshotString(buf, name)
+			buf = appendSnapshotString(buf, value)
+		}
+	}
+	return buf
+}
+
+// Byte-oriented bodies
+//
+// These exchange raw memory owned by the caller (a direct ByteBuffer on the
+// Java side) instead of NUL-terminated strings, so binary payloads survive
+// and each direction is copied once: socket to buffer, or buffer to socket.
+
+// getRequestBodyLength returns these instead of a Content-Length
+const (
+	bodyLengthUnknown   = -1 // chunked or otherwise unannounced; read until 0
+	bodyLengthNoRequest = -2
+)
+
+// The request's Content-Length, bodyLengthUnknown when it has none, or
+// bodyLengthNoRequest if the request id is not live
+//
+//export getRequestBodyLength
+func getRequestBodyLength(requestId int) int {
+	request, exists := lookupRequest(requestId)
+	if !exists {
+		return bodyLengthNoRequest
+	}
+	if request.r.ContentLength < 0 {
+		return bodyLengthUnknown
+	}
+
+	return int(request.r.ContentLength)
+}
+
+// Read up to capacity body bytes into dst; returns the count, 0 at end of
+// body, or -1 if the request is unknown or the read failed
+//
+//export readRequestBody
+func readRequestBody(requestId int, dst unsafe.Pointer, capacity int) int {
+	request, exists := lookupRequest(requestId)
+	if !exists || dst == nil || capacity <= 0 {
+		return -1
+	}
+
+	n, err := io.ReadFull(request.r.Body, unsafe.Slice((*byte)(dst), capacity))
+	if err != nil && err != io.EOF && err != io.ErrUnexpectedEOF {
+		return -1
+	}
+	return n
+}
+
+//export sendResponseBytes
+func sendResponseBytes(requestId int, statusCode int, contentType *C.char, body unsafe.Pointer, length int) {
+	request, exists := lookupRequest(requestId)
+	if !exists || !request.claimResponse() {
+		return
+	}
+
+	contentTypeStr := C.GoString(contentType)
+	defer request.finish()
+
+	var bodyBytes []byte
+	if body != nil && length > 0 {
+		bodyBytes = unsafe.Slice((*byte)(body), length)
+	}
+
+	request.w.Header().Set("Content-Type", contentTypeStr)
+	request.writeBody(statusCode, bodyBytes)
+}
+
 // Middleware
 //
 //export useMiddleware
 func useMiddleware(serverHandle int, middlewareName *C.char) {
-	// This would normally register middleware with the server
-	// For simplicity, this is a placeholder
+	server, exists := lookupServer(serverHandle)
+	if !exists {
+		return
+	}
+
+	middlewareNameStr := C.GoString(middlewareName)
+	middleware, known := builtinMiddleware[middlewareNameStr]
+	if !known {
+		log.Printf("Unknown middleware: %s", middlewareNameStr)
+		return
+	}
+	middleware(server)
 }
 
 // Utility functions
@@ -466,32 +829,33 @@ func createWebSocketEndpoint(serverHandle int, path *C.char) int {
 
 	wsEndpoint := &WebSocketEndpoint{
 		path:    pathStr,
-		clients: make(map[string]*websocket.Conn),
+		clients: make(map[string]*wsClient),
 	}
 
 	server.wsEndpoints[endpointID] = wsEndpoint
+	indexWebSocketEndpoint(endpointID, wsEndpoint)
 
 	// Handle WebSocket connections
-	server.router.HandleFunc(pathStr, func(w http.ResponseWriter, r *http.Request) {
+	server.router.handle("", pathStr, func(w http.ResponseWriter, r *http.Request) {
 		conn, err := upgrader.Upgrade(w, r, nil)
 		if err != nil {
 			log.Printf("WebSocket upgrade error: %v", err)
 			return
 		}
 
-		// Generate client ID
-		clientID := uuid.New().String()
+		// Generate client ID and start its writer
+		client := newWsClient(uuid.New().String(), conn, wsEndpoint)
 
 		// Store connection
 		wsEndpoint.clientsMu.Lock()
-		wsEndpoint.clients[clientID] = conn
+		wsEndpoint.clients[client.id] = client
 		wsEndpoint.clientsMu.Unlock()
 
 		// Handle disconnect
 		defer func() {
-			conn.Close()
+			client.close()
 			wsEndpoint.clientsMu.Lock()
-			delete(wsEndpoint.clients, clientID)
+			delete(wsEndpoint.clients, client.id)
 			wsEndpoint.clientsMu.Unlock()
 		}()
 
@@ -503,9 +867,20 @@ func createWebSocketEndpoint(serverHandle int, path *C.char) int {
 			}
 
 			if messageType == websocket.TextMessage {
-				// Handle message (callbacks would be implemented here)
-				// For now, we'll just echo it back
-				conn.WriteMessage(websocket.TextMessage, message)
+				wsEndpoint.messagesIn.Add(1)
+
+				// Hand the message to the script callback when one is registered
+				if inbox := wsEndpoint.inbox.Load(); inbox != nil {
+					if !inbox.push(client.closed, wsInbound{clientID: client.id, payload: message}) {
+						break
+					}
+					continue
+				}
+
+				// Otherwise echo it back through the client's queue
+				if prepared, err := websocket.NewPreparedMessage(websocket.TextMessage, message); err == nil {
+					client.enqueue(prepared)
+				}
 			}
 		}
 	})
@@ -513,66 +888,184 @@ func createWebSocketEndpoint(serverHandle int, path *C.char) int {
 	return endpointID
 }
 
+// Endpoint index
+//
+// Endpoint handles are global, so per-message calls resolve them through one
+// read-mostly index instead of scanning every server under globalMu
+var (
+	wsEndpointIndex   = make(map[int]*WebSocketEndpoint)
+	wsEndpointIndexMu sync.RWMutex
+)
+
+func indexWebSocketEndpoint(endpointHandle int, endpoint *WebSocketEndpoint) {
+	wsEndpointIndexMu.Lock()
+	wsEndpointIndex[endpointHandle] = endpoint
+	wsEndpointIndexMu.Unlock()
+}
+
+func unindexWebSocketEndpoint(endpointHandle int) {
+	wsEndpointIndexMu.Lock()
+	delete(wsEndpointIndex, endpointHandle)
+	wsEndpointIndexMu.Unlock()
+}
+
+func findWebSocketEndpoint(endpointHandle int) (*WebSocketEndpoint, bool) {
+	wsEndpointIndexMu.RLock()
+	endpoint, exists := wsEndpointIndex[endpointHandle]
+	wsEndpointIndexMu.RUnlock()
+	return endpoint, exists
+}
+
+// Disconnect every client of the endpoint and release its script drainers
+func (endpoint *WebSocketEndpoint) closeAll() {
+	if inbox := endpoint.inbox.Load(); inbox != nil {
+		inbox.close()
+	}
+
+	endpoint.clientsMu.Lock()
+	clients := endpoint.clients
+	endpoint.clients = make(map[string]*wsClient)
+	endpoint.clientsMu.Unlock()
+
+	for _, client := range clients {
+		client.close()
+	}
+}
+
+func (endpoint *WebSocketEndpoint) client(clientId string) (*wsClient, bool) {
+	endpoint.clientsMu.RLock()
+	defer endpoint.clientsMu.RUnlock()
+
+	client, exists := endpoint.clients[clientId]
+	return client, exists
+}
+
 //export sendWebSocketMessage
 func sendWebSocketMessage(endpointHandle int, clientId, message *C.char) {
-	globalMu.Lock()
-	defer globalMu.Unlock()
-
 	clientIdStr := C.GoString(clientId)
 	messageStr := C.GoString(message)
 
-	// Find endpoint
-	for _, server := range servers {
-		if endpoint, exists := server.wsEndpoints[endpointHandle]; exists {
-			endpoint.clientsMu.Lock()
-			if conn, exists := endpoint.clients[clientIdStr]; exists {
-				conn.WriteMessage(websocket.TextMessage, []byte(messageStr))
-			}
-			endpoint.clientsMu.Unlock()
-			return
-		}
+	endpoint, exists := findWebSocketEndpoint(endpointHandle)
+	if !exists {
+		return
+	}
+
+	client, exists := endpoint.client(clientIdStr)
+	if !exists {
+		return
 	}
+
+	prepared, err := websocket.NewPreparedMessage(websocket.TextMessage, []byte(messageStr))
+	if err != nil {
+		return
+	}
+	client.enqueue(prepared)
 }
 
 //export broadcastWebSocketMessage
 func broadcastWebSocketMessage(endpointHandle int, message *C.char) {
-	globalMu.Lock()
-	defer globalMu.Unlock()
-
 	messageStr := C.GoString(message)
 
-	// Find endpoint
-	for _, server := range servers {
-		if endpoint, exists := server.wsEndpoints[endpointHandle]; exists {
-			endpoint.clientsMu.Lock()
-			for _, conn := range endpoint.clients {
-				conn.WriteMessage(websocket.TextMessage, []byte(messageStr))
-			}
-			endpoint.clientsMu.Unlock()
-			return
-		}
+	endpoint, exists := findWebSocketEndpoint(endpointHandle)
+	if !exists {
+		return
+	}
+
+	// Encode the frame once for every recipient
+	prepared, err := websocket.NewPreparedMessage(websocket.TextMessage, []byte(messageStr))
+	if err != nil {
+		return
+	}
+
+	// Snapshot the recipients so no lock is held while queueing
+	endpoint.clientsMu.RLock()
+	recipients := make([]*wsClient, 0, len(endpoint.clients))
+	for _, client := range endpoint.clients {
+		recipients = append(recipients, client)
+	}
+	endpoint.clientsMu.RUnlock()
+
+	for _, client := range recipients {
+		client.enqueue(prepared)
 	}
 }
 
 //export closeWebSocketConnection
 func closeWebSocketConnection(endpointHandle int, clientId *C.char) {
-	globalMu.Lock()
-	defer globalMu.Unlock()
-
 	clientIdStr := C.GoString(clientId)
 
-	// Find endpoint
-	for _, server := range servers {
-		if endpoint, exists := server.wsEndpoints[endpointHandle]; exists {
-			endpoint.clientsMu.Lock()
-			if conn, exists := endpoint.clients[clientIdStr]; exists {
-				conn.Close()
-				delete(endpoint.clients, clientIdStr)
-			}
-			endpoint.clientsMu.Unlock()
-			return
-		}
+	endpoint, exists := findWebSocketEndpoint(endpointHandle)
+	if !exists {
+		return
+	}
+
+	endpoint.clientsMu.Lock()
+	client, exists := endpoint.clients[clientIdStr]
+	delete(endpoint.clients, clientIdStr)
+	endpoint.clientsMu.Unlock()
+
+	if exists {
+		client.close()
+	}
+}
+
+// Buffer inbound text frames for a script callback instead of echoing them.
+// capacity bounds the frames waiting to be drained; 0 picks the default.
+//
+//export enableWebSocketInbox
+func enableWebSocketInbox(endpointHandle int, capacity int) {
+	endpoint, exists := findWebSocketEndpoint(endpointHandle)
+	if !exists {
+		return
+	}
+
+	endpoint.inbox.CompareAndSwap(nil, newWsInbox(capacity))
+}
+
+// Drain up to maxMessages buffered frames, waiting up to timeoutMs for the
+// first. The result is a malloc'd buffer in the snapshot encoding:
+//
+//	count, {clientId, message}...
+//
+// length is 0 when the wait timed out and -1 once the endpoint is closed.
+//
+//export drainWebSocketMessages
+func drainWebSocketMessages(endpointHandle int, maxMessages int, timeoutMs int, length *int) *C.char {
+	*length = -1
+
+	endpoint, exists := findWebSocketEndpoint(endpointHandle)
+	if !exists {
+		return nil
+	}
+	inbox := endpoint.inbox.Load()
+	if inbox == nil {
+		return nil
+	}
+
+	batch, ok := inbox.drain(maxMessages, time.Duration(timeoutMs)*time.Millisecond)
+	if !ok {
+		return nil
+	}
+	*length = 0
+	if len(batch) == 0 {
+		return nil
 	}
+
+	size := 4
+	for _, message := range batch {
+		size += 8 + len(message.clientID) + len(message.payload)
+	}
+
+	buf := make([]byte, 0, size)
+	buf = binary.LittleEndian.AppendUint32(buf, uint32(len(batch)))
+	for _, message := range batch {
+		buf = appendSnapshotString(buf, message.clientID)
+		buf = binary.LittleEndian.AppendUint32(buf, uint32(len(message.payload)))
+		buf = append(buf, message.payload...)
+	}
+
+	*length = len(buf)
+	return (*C.char)(C.CBytes(buf))
 }
 
 func main() {}
@@ -0,0 +1,119 @@
+package main
+
+import "C"
+import (
+	"net/textproto"
+	"sync"
+	"sync/atomic"
+	"unsafe"
+)
+
+// Interned strings
+//
+// Header names and content types repeat on nearly every response. The JVM
+// side interns them once and then passes a small ID, so the hot send path
+// neither marshals the string again nor re-canonicalizes the header key.
+// The table only grows and is capped; when full, internString returns 0
+// and callers fall back to passing the string itself.
+const maxInternedStrings = 1024
+
+type internedString struct {
+	value     string
+	headerKey string   // canonical MIME form, for use as a header name
+	values    []string // {value}, shared as a read-only header value
+}
+
+type internTable struct {
+	mu      sync.Mutex
+	ids     map[string]int
+	entries atomic.Pointer[[]*internedString] // index id-1, copy-on-write
+}
+
+var interned internTable
+
+func (table *internTable) intern(value string) int {
+	table.mu.Lock()
+	defer table.mu.Unlock()
+
+	if id, exists := table.ids[value]; exists {
+		return id
+	}
+	if len(table.ids) >= maxInternedStrings {
+		return 0
+	}
+	if table.ids == nil {
+		table.ids = make(map[string]int)
+	}
+
+	var entries []*internedString
+	if current := table.entries.Load(); current != nil {
+		entries = *current
+	}
+	entry := &internedString{
+		value:     value,
+		headerKey: textproto.CanonicalMIMEHeaderKey(value),
+		values:    []string{value},
+	}
+	next := make([]*internedString, len(entries), len(entries)+1)
+	copy(next, entries)
+	next = append(next, entry)
+	table.entries.Store(&next)
+
+	id := len(next)
+	table.ids[value] = id
+	return id
+}
+
+// lookup is lock-free: entries are never removed or modified once published
+func (table *internTable) lookup(id int) (*internedString, bool) {
+	entries := table.entries.Load()
+	if entries == nil || id <= 0 || id > len(*entries) {
+		return nil, false
+	}
+	return (*entries)[id-1], true
+}
+
+//export internString
+func internString(value *C.char) int {
+	return interned.intern(C.GoString(value))
+}
+
+//export setResponseHeaderInterned
+func setResponseHeaderInterned(requestId int, nameId int, value *C.char) {
+	name, known := interned.lookup(nameId)
+	request, exists := lookupRequest(requestId)
+	if !known || !exists {
+		return
+	}
+
+	valueStr := C.GoString(value)
+
+	request.mu.Lock()
+	defer request.mu.Unlock()
+
+	if request.headersSent {
+		return
+	}
+
+	request.w.Header()[name.headerKey] = []string{valueStr}
+}
+
+//export sendResponseInterned
+func sendResponseInterned(requestId int, statusCode int, contentTypeId int, body unsafe.Pointer, length int) {
+	request, exists := lookupRequest(requestId)
+	if !exists || !request.claimResponse() {
+		return
+	}
+	defer request.finish()
+
+	var bodyBytes []byte
+	if body != nil && length > 0 {
+		bodyBytes = unsafe.Slice((*byte)(body), length)
+	}
+
+	// Capacity 1 keeps a later Header().Add from writing into the shared array
+	if contentType, known := interned.lookup(contentTypeId); known {
+		request.w.Header()["Content-Type"] = contentType.values[:1:1]
+	}
+	request.writeBody(statusCode, bodyBytes)
+}
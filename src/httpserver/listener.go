@@ -0,0 +1,51 @@
+package main
+
+import (
+	"net"
+	"sync"
+)
+
+// Connection limiting
+//
+// limitListener caps the number of open connections accepted through it;
+// every listener of a server shares one slot pool, so the cap holds across
+// SO_REUSEPORT listeners too. Accept blocks while the pool is exhausted,
+// leaving further connections in the kernel backlog.
+type connSlots chan struct{}
+
+type limitListener struct {
+	net.Listener
+	slots connSlots
+}
+
+type limitConn struct {
+	net.Conn
+	slots       connSlots
+	releaseOnce sync.Once
+}
+
+func newLimitListener(listener net.Listener, slots connSlots) net.Listener {
+	if slots == nil {
+		return listener
+	}
+	return &limitListener{Listener: listener, slots: slots}
+}
+
+func (listener *limitListener) Accept() (net.Conn, error) {
+	listener.slots <- struct{}{}
+
+	conn, err := listener.Listener.Accept()
+	if err != nil {
+		<-listener.slots
+		return nil, err
+	}
+	return &limitConn{Conn: conn, slots: listener.slots}, nil
+}
+
+func (conn *limitConn) Close() error {
+	err := conn.Conn.Close()
+	conn.releaseOnce.Do(func() {
+		<-conn.slots
+	})
+	return err
+}
@@ -0,0 +1,442 @@
+package main
+
+import "C"
+import (
+	"bufio"
+	"encoding/json"
+	"fmt"
+	"io"
+	"math/bits"
+	"net"
+	"net/http"
+	"sort"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// Metrics
+//
+// Request handling only touches atomics: every route owns its counters and
+// a log-linear latency histogram (HDR style: 8 linear sub-buckets per power
+// of two, so any recorded value is within 12.5% of its bucket bound).
+// Aggregation happens when stats are read, through getServerStats (JSON) or
+// an optional Prometheus text endpoint.
+const (
+	histogramSubBuckets = 8
+	histogramSubBits    = 3
+	histogramBuckets    = histogramSubBuckets + (40-histogramSubBits)*histogramSubBuckets
+)
+
+type latencyHistogram struct {
+	counts [histogramBuckets]atomic.Int64
+	sumUs  atomic.Int64
+	maxUs  atomic.Int64
+}
+
+func histogramIndex(us int64) int {
+	if us < histogramSubBuckets {
+		if us < 0 {
+			return 0
+		}
+		return int(us)
+	}
+	exponent := bits.Len64(uint64(us)) - 1
+	sub := int(us>>(exponent-histogramSubBits)) & (histogramSubBuckets - 1)
+	index := histogramSubBuckets + (exponent-histogramSubBits)*histogramSubBuckets + sub
+	if index >= histogramBuckets {
+		index = histogramBuckets - 1
+	}
+	return index
+}
+
+// Upper bound, in microseconds, of the values counted in a bucket
+func histogramBound(index int) int64 {
+	if index < histogramSubBuckets {
+		return int64(index)
+	}
+	exponent := (index-histogramSubBuckets)/histogramSubBuckets + histogramSubBits
+	sub := int64((index - histogramSubBuckets) % histogramSubBuckets)
+	return (histogramSubBuckets+sub+1)<<(exponent-histogramSubBits) - 1
+}
+
+func (histogram *latencyHistogram) record(elapsed time.Duration) {
+	us := elapsed.Microseconds()
+	histogram.counts[histogramIndex(us)].Add(1)
+	histogram.sumUs.Add(us)
+	for {
+		max := histogram.maxUs.Load()
+		if us <= max || histogram.maxUs.CompareAndSwap(max, us) {
+			return
+		}
+	}
+}
+
+type latencySummary struct {
+	Count  int64   `json:"count"`
+	SumMs  float64 `json:"sumMs"`
+	MeanMs float64 `json:"meanMs"`
+	P50Ms  float64 `json:"p50Ms"`
+	P90Ms  float64 `json:"p90Ms"`
+	P99Ms  float64 `json:"p99Ms"`
+	MaxMs  float64 `json:"maxMs"`
+}
+
+func (histogram *latencyHistogram) summary() latencySummary {
+	var counts [histogramBuckets]int64
+	var total int64
+	for i := range counts {
+		counts[i] = histogram.counts[i].Load()
+		total += counts[i]
+	}
+
+	summary := latencySummary{
+		Count: total,
+		SumMs: float64(histogram.sumUs.Load()) / 1000,
+		MaxMs: float64(histogram.maxUs.Load()) / 1000,
+	}
+	if total == 0 {
+		return summary
+	}
+	summary.MeanMs = summary.SumMs / float64(total)
+
+	quantile := func(q float64) float64 {
+		target := int64(q*float64(total) + 0.5)
+		if target < 1 {
+			target = 1
+		}
+		var seen int64
+		for i, count := range counts {
+			seen += count
+			if seen >= target {
+				return float64(histogramBound(i)) / 1000
+			}
+		}
+		return summary.MaxMs
+	}
+	summary.P50Ms = quantile(0.50)
+	summary.P90Ms = quantile(0.90)
+	summary.P99Ms = quantile(0.99)
+	return summary
+}
+
+type routeMetrics struct {
+	method   string
+	path     string
+	requests atomic.Int64
+	statuses [5]atomic.Int64 // 1xx..5xx
+	bytesIn  atomic.Int64
+	bytesOut atomic.Int64
+	latency  latencyHistogram
+}
+
+func (metrics *routeMetrics) observe(status int, elapsed time.Duration, bytesIn, bytesOut int64) {
+	metrics.requests.Add(1)
+	if class := status/100 - 1; class >= 0 && class < len(metrics.statuses) {
+		metrics.statuses[class].Add(1)
+	}
+	metrics.bytesIn.Add(bytesIn)
+	metrics.bytesOut.Add(bytesOut)
+	metrics.latency.record(elapsed)
+}
+
+type serverMetrics struct {
+	mu       sync.Mutex // guards routes registration only
+	routes   map[string]*routeMetrics
+	inFlight atomic.Int64
+}
+
+// Metrics for a route; re-adding a route keeps its history
+func (metrics *serverMetrics) route(method, path string) *routeMetrics {
+	metrics.mu.Lock()
+	defer metrics.mu.Unlock()
+
+	key := method + " " + path
+	if route, exists := metrics.routes[key]; exists {
+		return route
+	}
+	if metrics.routes == nil {
+		metrics.routes = make(map[string]*routeMetrics)
+	}
+	route := &routeMetrics{method: method, path: path}
+	metrics.routes[key] = route
+	return route
+}
+
+func (metrics *serverMetrics) sortedRoutes() []*routeMetrics {
+	metrics.mu.Lock()
+	routes := make([]*routeMetrics, 0, len(metrics.routes))
+	for _, route := range metrics.routes {
+		routes = append(routes, route)
+	}
+	metrics.mu.Unlock()
+
+	sort.Slice(routes, func(i, j int) bool {
+		if routes[i].path != routes[j].path {
+			return routes[i].path < routes[j].path
+		}
+		return routes[i].method < routes[j].method
+	})
+	return routes
+}
+
+// Counting wrappers
+//
+// meteredWriter records the status and body bytes of a response. It keeps
+// io.ReaderFrom so file responses still reach sendfile, and Flush/Unwrap so
+// http.ResponseController keeps working.
+type meteredWriter struct {
+	http.ResponseWriter
+	status  int
+	written int64
+}
+
+func (writer *meteredWriter) WriteHeader(statusCode int) {
+	if writer.status == 0 {
+		writer.status = statusCode
+	}
+	writer.ResponseWriter.WriteHeader(statusCode)
+}
+
+func (writer *meteredWriter) Write(data []byte) (int, error) {
+	if writer.status == 0 {
+		writer.status = http.StatusOK
+	}
+	n, err := writer.ResponseWriter.Write(data)
+	writer.written += int64(n)
+	return n, err
+}
+
+func (writer *meteredWriter) ReadFrom(src io.Reader) (int64, error) {
+	if writer.status == 0 {
+		writer.status = http.StatusOK
+	}
+	var n int64
+	var err error
+	if readerFrom, ok := writer.ResponseWriter.(io.ReaderFrom); ok {
+		n, err = readerFrom.ReadFrom(src)
+	} else {
+		n, err = io.Copy(writer.ResponseWriter, src)
+	}
+	writer.written += n
+	return n, err
+}
+
+func (writer *meteredWriter) Flush() {
+	if flusher, ok := writer.ResponseWriter.(http.Flusher); ok {
+		flusher.Flush()
+	}
+}
+
+func (writer *meteredWriter) Hijack() (net.Conn, *bufio.ReadWriter, error) {
+	if hijacker, ok := writer.ResponseWriter.(http.Hijacker); ok {
+		return hijacker.Hijack()
+	}
+	return nil, nil, http.ErrNotSupported
+}
+
+func (writer *meteredWriter) Unwrap() http.ResponseWriter {
+	return writer.ResponseWriter
+}
+
+type meteredBody struct {
+	io.ReadCloser
+	read atomic.Int64
+}
+
+func (body *meteredBody) Read(data []byte) (int, error) {
+	n, err := body.ReadCloser.Read(data)
+	body.read.Add(int64(n))
+	return n, err
+}
+
+// Wrap a route handler with request accounting
+func (metrics *serverMetrics) instrument(route *routeMetrics, next http.HandlerFunc) http.HandlerFunc {
+	return func(w http.ResponseWriter, r *http.Request) {
+		start := time.Now()
+		metrics.inFlight.Add(1)
+
+		writer := &meteredWriter{ResponseWriter: w}
+		body := &meteredBody{ReadCloser: r.Body}
+		r.Body = body
+
+		defer func() {
+			metrics.inFlight.Add(-1)
+			status := writer.status
+			if status == 0 {
+				status = http.StatusOK
+			}
+			route.observe(status, time.Since(start), body.read.Load(), writer.written)
+		}()
+
+		next(writer, r)
+	}
+}
+
+// Stats snapshots
+type routeStats struct {
+	Method   string           `json:"method"`
+	Path     string           `json:"path"`
+	Requests int64            `json:"requests"`
+	Statuses map[string]int64 `json:"statuses"`
+	BytesIn  int64            `json:"bytesIn"`
+	BytesOut int64            `json:"bytesOut"`
+	Latency  latencySummary   `json:"latency"`
+}
+
+type webSocketStats struct {
+	Endpoint    int    `json:"endpoint"`
+	Path        string `json:"path"`
+	Clients     int    `json:"clients"`
+	MessagesIn  int64  `json:"messagesIn"`
+	MessagesOut int64  `json:"messagesOut"`
+}
+
+type serverStats struct {
+	Running    bool             `json:"running"`
+	InFlight   int64            `json:"inFlight"`
+	QueueDepth int              `json:"queueDepth"`
+	BytesIn    int64            `json:"bytesIn"`
+	BytesOut   int64            `json:"bytesOut"`
+	Routes     []routeStats     `json:"routes"`
+	WebSockets []webSocketStats `json:"websockets"`
+}
+
+func (server *HttpServer) stats() serverStats {
+	server.mu.Lock()
+	stats := serverStats{Running: server.isRunning, Routes: []routeStats{}, WebSockets: []webSocketStats{}}
+	server.mu.Unlock()
+
+	stats.InFlight = server.metrics.inFlight.Load()
+	if queue := server.dispatch.Load(); queue != nil {
+		stats.QueueDepth = len(queue.requests)
+	}
+
+	for _, route := range server.metrics.sortedRoutes() {
+		entry := routeStats{
+			Method:   route.method,
+			Path:     route.path,
+			Requests: route.requests.Load(),
+			Statuses: make(map[string]int64, len(route.statuses)),
+			BytesIn:  route.bytesIn.Load(),
+			BytesOut: route.bytesOut.Load(),
+			Latency:  route.latency.summary(),
+		}
+		for class := range route.statuses {
+			entry.Statuses[fmt.Sprintf("%dxx", class+1)] = route.statuses[class].Load()
+		}
+		stats.BytesIn += entry.BytesIn
+		stats.BytesOut += entry.BytesOut
+		stats.Routes = append(stats.Routes, entry)
+	}
+
+	globalMu.Lock()
+	endpoints := make(map[int]*WebSocketEndpoint, len(server.wsEndpoints))
+	for endpointID, endpoint := range server.wsEndpoints {
+		endpoints[endpointID] = endpoint
+	}
+	globalMu.Unlock()
+
+	for endpointID, endpoint := range endpoints {
+		endpoint.clientsMu.RLock()
+		clients := len(endpoint.clients)
+		endpoint.clientsMu.RUnlock()
+
+		stats.WebSockets = append(stats.WebSockets, webSocketStats{
+			Endpoint:    endpointID,
+			Path:        endpoint.path,
+			Clients:     clients,
+			MessagesIn:  endpoint.messagesIn.Load(),
+			MessagesOut: endpoint.messagesOut.Load(),
+		})
+	}
+	sort.Slice(stats.WebSockets, func(i, j int) bool {
+		return stats.WebSockets[i].Endpoint < stats.WebSockets[j].Endpoint
+	})
+	return stats
+}
+
+// Render stats in the Prometheus text exposition format
+func (stats serverStats) writePrometheus(w io.Writer) {
+	label := func(value string) string {
+		return strings.NewReplacer(`\`, `\\`, `"`, `\"`, "\n", `\n`).Replace(value)
+	}
+
+	fmt.Fprintf(w, "# TYPE microscript_http_in_flight_requests gauge\nmicroscript_http_in_flight_requests %d\n", stats.InFlight)
+	fmt.Fprintf(w, "# TYPE microscript_http_queue_depth gauge\nmicroscript_http_queue_depth %d\n", stats.QueueDepth)
+
+	fmt.Fprintln(w, "# TYPE microscript_http_requests_total counter")
+	for _, route := range stats.Routes {
+		for class := 1; class <= 5; class++ {
+			code := fmt.Sprintf("%dxx", class)
+			fmt.Fprintf(w, "microscript_http_requests_total{method=\"%s\",route=\"%s\",code=\"%s\"} %d\n",
+				label(route.Method), label(route.Path), code, route.Statuses[code])
+		}
+	}
+
+	fmt.Fprintln(w, "# TYPE microscript_http_request_duration_seconds summary")
+	for _, route := range stats.Routes {
+		labels := fmt.Sprintf("method=\"%s\",route=\"%s\"", label(route.Method), label(route.Path))
+		latency := route.Latency
+		for _, quantile := range []struct {
+			name  string
+			value float64
+		}{{"0.5", latency.P50Ms}, {"0.9", latency.P90Ms}, {"0.99", latency.P99Ms}} {
+			fmt.Fprintf(w, "microscript_http_request_duration_seconds{%s,quantile=\"%s\"} %g\n", labels, quantile.name, quantile.value/1000)
+		}
+		fmt.Fprintf(w, "microscript_http_request_duration_seconds_sum{%s} %g\n", labels, latency.SumMs/1000)
+		fmt.Fprintf(w, "microscript_http_request_duration_seconds_count{%s} %d\n", labels, latency.Count)
+	}
+
+	fmt.Fprintln(w, "# TYPE microscript_http_received_bytes_total counter")
+	for _, route := range stats.Routes {
+		fmt.Fprintf(w, "microscript_http_received_bytes_total{method=\"%s\",route=\"%s\"} %d\n", label(route.Method), label(route.Path), route.BytesIn)
+	}
+	fmt.Fprintln(w, "# TYPE microscript_http_sent_bytes_total counter")
+	for _, route := range stats.Routes {
+		fmt.Fprintf(w, "microscript_http_sent_bytes_total{method=\"%s\",route=\"%s\"} %d\n", label(route.Method), label(route.Path), route.BytesOut)
+	}
+
+	fmt.Fprintln(w, "# TYPE microscript_websocket_clients gauge")
+	for _, endpoint := range stats.WebSockets {
+		fmt.Fprintf(w, "microscript_websocket_clients{path=\"%s\"} %d\n", label(endpoint.Path), endpoint.Clients)
+	}
+	fmt.Fprintln(w, "# TYPE microscript_websocket_messages_total counter")
+	for _, endpoint := range stats.WebSockets {
+		fmt.Fprintf(w, "microscript_websocket_messages_total{path=\"%s\",direction=\"in\"} %d\n", label(endpoint.Path), endpoint.MessagesIn)
+		fmt.Fprintf(w, "microscript_websocket_messages_total{path=\"%s\",direction=\"out\"} %d\n", label(endpoint.Path), endpoint.MessagesOut)
+	}
+}
+
+// Serve Prometheus-format metrics for this server at path (e.g. "/metrics")
+//
+//export enableMetricsEndpoint
+func enableMetricsEndpoint(serverHandle int, path *C.char) {
+	server, exists := lookupServer(serverHandle)
+	if !exists {
+		return
+	}
+
+	server.router.handle("GET", C.GoString(path), func(w http.ResponseWriter, r *http.Request) {
+		w.Header().Set("Content-Type", "text/plain; version=0.0.4")
+		server.stats().writePrometheus(w)
+	})
+}
+
+// Return the server's counters, latency summaries and WebSocket client
+// counts as a JSON document
+//
+//export getServerStats
+func getServerStats(serverHandle int) *C.char {
+	server, exists := lookupServer(serverHandle)
+	if !exists {
+		return C.CString("{}")
+	}
+
+	data, err := json.Marshal(server.stats())
+	if err != nil {
+		return C.CString("{}")
+	}
+	return C.CString(string(data))
+}
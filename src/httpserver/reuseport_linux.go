@@ -0,0 +1,6 @@
+//go:build linux && !(mips || mipsle || mips64 || mips64le)
+
+package main
+
+// The syscall package does not export SO_REUSEPORT for Linux
+const soReusePort = 0xf
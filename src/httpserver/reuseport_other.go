@@ -0,0 +1,14 @@
+//go:build !((linux && !(mips || mipsle || mips64 || mips64le)) || darwin || dragonfly || freebsd || netbsd || openbsd)
+
+package main
+
+import (
+	"syscall"
+)
+
+// SO_REUSEPORT is not available here; servers fall back to one listener
+const reusePortSupported = false
+
+func setReusePort(network, address string, conn syscall.RawConn) error {
+	return nil
+}
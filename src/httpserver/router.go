@@ -0,0 +1,231 @@
+package main
+
+import (
+	"net/http"
+	"sort"
+	"strings"
+	"sync"
+	"sync/atomic"
+)
+
+// Routing
+//
+// Routes live in a tree keyed by path segment, so matching costs one map
+// lookup per segment no matter how many routes are registered. A segment
+// written as {name} (or {name:pattern}, pattern ignored) matches any single
+// segment; static segments win over parameters unless only the parameter
+// route handles the request's method. A trailing slash is a segment of its
+// own, so "/api/" and "/api" are distinct routes. The tree is immutable once
+// published: addRoute and removeRoute copy the nodes along the changed path
+// and swap the root atomically, so in-flight requests never wait on writers.
+// A route registered with an empty method accepts every method.
+type routeNode struct {
+	static   map[string]*routeNode
+	param    *routeNode
+	handlers map[string]http.HandlerFunc
+}
+
+type router struct {
+	mu   sync.Mutex // serializes writers only
+	root atomic.Pointer[routeNode]
+}
+
+func newRouter() *router {
+	return &router{}
+}
+
+func (node *routeNode) clone() *routeNode {
+	copied := &routeNode{}
+	if node == nil {
+		return copied
+	}
+
+	copied.param = node.param
+	if len(node.static) > 0 {
+		copied.static = make(map[string]*routeNode, len(node.static))
+		for segment, child := range node.static {
+			copied.static[segment] = child
+		}
+	}
+	if len(node.handlers) > 0 {
+		copied.handlers = make(map[string]http.HandlerFunc, len(node.handlers))
+		for method, handler := range node.handlers {
+			copied.handlers[method] = handler
+		}
+	}
+	return copied
+}
+
+func (node *routeNode) isEmpty() bool {
+	return len(node.static) == 0 && node.param == nil && len(node.handlers) == 0
+}
+
+func isParamSegment(segment string) bool {
+	return len(segment) >= 2 && segment[0] == '{' && segment[len(segment)-1] == '}'
+}
+
+// "/api/" splits into "api" and an empty trailing segment; "/" into none
+func splitRoutePath(path string) []string {
+	path = strings.TrimPrefix(path, "/")
+	if path == "" {
+		return nil
+	}
+	return strings.Split(path, "/")
+}
+
+// Return a copy of node with handler set at the end of segments
+func insertRoute(node *routeNode, segments []string, method string, handler http.HandlerFunc) *routeNode {
+	copied := node.clone()
+	if len(segments) == 0 {
+		if copied.handlers == nil {
+			copied.handlers = make(map[string]http.HandlerFunc)
+		}
+		copied.handlers[method] = handler
+		return copied
+	}
+
+	segment, rest := segments[0], segments[1:]
+	if isParamSegment(segment) {
+		copied.param = insertRoute(copied.param, rest, method, handler)
+		return copied
+	}
+
+	if copied.static == nil {
+		copied.static = make(map[string]*routeNode)
+	}
+	copied.static[segment] = insertRoute(copied.static[segment], rest, method, handler)
+	return copied
+}
+
+// Return a copy of node without the route, pruning branches left empty.
+// removed reports whether the route existed; if not, node is returned as-is.
+func deleteRoute(node *routeNode, segments []string, method string) (result *routeNode, removed bool) {
+	if node == nil {
+		return nil, false
+	}
+
+	if len(segments) == 0 {
+		if _, exists := node.handlers[method]; !exists {
+			return node, false
+		}
+		copied := node.clone()
+		delete(copied.handlers, method)
+		return pruneRoute(copied), true
+	}
+
+	segment, rest := segments[0], segments[1:]
+	if isParamSegment(segment) {
+		child, removed := deleteRoute(node.param, rest, method)
+		if !removed {
+			return node, false
+		}
+		copied := node.clone()
+		copied.param = child
+		return pruneRoute(copied), true
+	}
+
+	child, removed := deleteRoute(node.static[segment], rest, method)
+	if !removed {
+		return node, false
+	}
+	copied := node.clone()
+	if child == nil {
+		delete(copied.static, segment)
+	} else {
+		copied.static[segment] = child
+	}
+	return pruneRoute(copied), true
+}
+
+func pruneRoute(node *routeNode) *routeNode {
+	if node.isEmpty() {
+		return nil
+	}
+	return node
+}
+
+// Find the node for path (without its leading slash); end reports that no
+// segments remain, as opposed to one empty segment after a trailing slash.
+// Static segments are preferred, falling back to a parameter when the static
+// branch dead-ends or has no handler for method. handles reports whether the
+// node found accepts method; if none does, the static-first match is returned
+// so the caller can answer 405 with its methods.
+func (node *routeNode) match(path string, end bool, method string) (found *routeNode, handles bool) {
+	if node == nil {
+		return nil, false
+	}
+	if end {
+		if len(node.handlers) == 0 {
+			return nil, false
+		}
+		return node, node.handles(method)
+	}
+
+	segment, rest, last := path, "", true
+	if slash := strings.IndexByte(path, '/'); slash >= 0 {
+		segment, rest, last = path[:slash], path[slash+1:], false
+	}
+
+	found, handles = node.static[segment].match(rest, last, method)
+	if handles {
+		return found, true
+	}
+	if node.param != nil && segment != "" {
+		if paramFound, paramHandles := node.param.match(rest, last, method); paramHandles || found == nil {
+			return paramFound, paramHandles
+		}
+	}
+	return found, false
+}
+
+func (node *routeNode) handles(method string) bool {
+	if _, exists := node.handlers[method]; exists {
+		return true
+	}
+	_, exists := node.handlers[""]
+	return exists
+}
+
+func (rt *router) handle(method, path string, handler http.HandlerFunc) {
+	rt.mu.Lock()
+	defer rt.mu.Unlock()
+
+	rt.root.Store(insertRoute(rt.root.Load(), splitRoutePath(path), method, handler))
+}
+
+func (rt *router) remove(method, path string) bool {
+	rt.mu.Lock()
+	defer rt.mu.Unlock()
+
+	root, removed := deleteRoute(rt.root.Load(), splitRoutePath(path), method)
+	if removed {
+		rt.root.Store(root)
+	}
+	return removed
+}
+
+func (rt *router) ServeHTTP(w http.ResponseWriter, r *http.Request) {
+	path := strings.TrimPrefix(r.URL.Path, "/")
+	node, _ := rt.root.Load().match(path, path == "", r.Method)
+	if node == nil {
+		http.NotFound(w, r)
+		return
+	}
+
+	if handler, exists := node.handlers[r.Method]; exists {
+		handler(w, r)
+		return
+	}
+	if handler, exists := node.handlers[""]; exists {
+		handler(w, r)
+		return
+	}
+
+	allowed := make([]string, 0, len(node.handlers))
+	for method := range node.handlers {
+		allowed = append(allowed, method)
+	}
+	sort.Strings(allowed)
+	w.Header().Set("Allow", strings.Join(allowed, ", "))
+	http.Error(w, http.StatusText(http.StatusMethodNotAllowed), http.StatusMethodNotAllowed)
+}
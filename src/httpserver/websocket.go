@@ -0,0 +1,202 @@
+package main
+
+import (
+	"sync"
+	"time"
+
+	"github.com/gorilla/websocket"
+)
+
+// WebSocket clients
+//
+// Every connection owns a bounded outbound queue drained by its own writer
+// goroutine, so senders never touch the socket and one slow consumer cannot
+// stall a broadcast. A client whose queue is full is disconnected rather
+// than silently losing frames from the middle of its stream.
+const (
+	wsSendQueueSize = 256
+	wsWriteTimeout  = 10 * time.Second
+)
+
+type wsClient struct {
+	id        string
+	conn      *websocket.Conn
+	endpoint  *WebSocketEndpoint
+	send      chan *websocket.PreparedMessage
+	closed    chan struct{}
+	closeOnce sync.Once
+}
+
+func newWsClient(id string, conn *websocket.Conn, endpoint *WebSocketEndpoint) *wsClient {
+	client := &wsClient{
+		id:       id,
+		conn:     conn,
+		endpoint: endpoint,
+		send:     make(chan *websocket.PreparedMessage, wsSendQueueSize),
+		closed:   make(chan struct{}),
+	}
+	go client.writeLoop()
+	return client
+}
+
+// Queue a message without blocking; a full queue disconnects the client
+func (client *wsClient) enqueue(message *websocket.PreparedMessage) bool {
+	select {
+	case <-client.closed:
+		return false
+	default:
+	}
+
+	select {
+	case client.send <- message:
+		return true
+	default:
+		client.close()
+		return false
+	}
+}
+
+func (client *wsClient) writeLoop() {
+	for {
+		select {
+		case message := <-client.send:
+			client.conn.SetWriteDeadline(time.Now().Add(wsWriteTimeout))
+			if err := client.conn.WritePreparedMessage(message); err != nil {
+				client.close()
+				return
+			}
+			client.endpoint.messagesOut.Add(1)
+		case <-client.closed:
+			return
+		}
+	}
+}
+
+// Close the connection; the read loop then fails and unregisters the client
+func (client *wsClient) close() {
+	client.closeOnce.Do(func() {
+		close(client.closed)
+		client.conn.Close()
+	})
+}
+
+// Inbound batching
+//
+// When a script callback is registered, the read loops push text frames into
+// a per-endpoint ring buffer instead of echoing them. The Java side drains
+// up to N frames per native call, so the cgo/JNI crossing is paid per batch
+// rather than per frame. A full ring blocks the read loops, which pushes
+// back on clients through TCP flow control instead of dropping messages.
+const defaultWsInboxCapacity = 4096
+
+type wsInbound struct {
+	clientID string
+	payload  []byte
+}
+
+type wsInbox struct {
+	mu        sync.Mutex
+	ring      []wsInbound
+	head      int
+	count     int
+	ready     chan struct{}
+	space     chan struct{}
+	closed    chan struct{}
+	closeOnce sync.Once
+}
+
+func newWsInbox(capacity int) *wsInbox {
+	if capacity <= 0 {
+		capacity = defaultWsInboxCapacity
+	}
+	return &wsInbox{
+		ring:   make([]wsInbound, capacity),
+		ready:  make(chan struct{}, 1),
+		space:  make(chan struct{}, 1),
+		closed: make(chan struct{}),
+	}
+}
+
+func signal(ch chan struct{}) {
+	select {
+	case ch <- struct{}{}:
+	default:
+	}
+}
+
+// Append a frame, waiting for room; false if the inbox or client closed first
+func (inbox *wsInbox) push(clientClosed <-chan struct{}, message wsInbound) bool {
+	for {
+		inbox.mu.Lock()
+		if inbox.count < len(inbox.ring) {
+			inbox.ring[(inbox.head+inbox.count)%len(inbox.ring)] = message
+			inbox.count++
+			room := inbox.count < len(inbox.ring)
+			inbox.mu.Unlock()
+
+			signal(inbox.ready)
+			// A drain wakes one waiting pusher; pass the wakeup on while room remains
+			if room {
+				signal(inbox.space)
+			}
+			return true
+		}
+		inbox.mu.Unlock()
+
+		select {
+		case <-inbox.space:
+		case <-inbox.closed:
+			return false
+		case <-clientClosed:
+			return false
+		}
+	}
+}
+
+// Take up to max frames, waiting up to timeout for the first one. ok is
+// false once the inbox has been closed and fully drained.
+func (inbox *wsInbox) drain(max int, timeout time.Duration) (batch []wsInbound, ok bool) {
+	timer := time.NewTimer(timeout)
+	defer timer.Stop()
+
+	for {
+		inbox.mu.Lock()
+		if inbox.count > 0 {
+			n := inbox.count
+			if max > 0 && n > max {
+				n = max
+			}
+			batch = make([]wsInbound, n)
+			for i := range batch {
+				slot := (inbox.head + i) % len(inbox.ring)
+				batch[i] = inbox.ring[slot]
+				inbox.ring[slot] = wsInbound{}
+			}
+			inbox.head = (inbox.head + n) % len(inbox.ring)
+			inbox.count -= n
+			remaining := inbox.count
+			inbox.mu.Unlock()
+
+			signal(inbox.space)
+			if remaining > 0 {
+				signal(inbox.ready)
+			}
+			return batch, true
+		}
+		inbox.mu.Unlock()
+
+		select {
+		case <-inbox.ready:
+		case <-inbox.closed:
+			return nil, false
+		case <-timer.C:
+			return nil, true
+		}
+	}
+}
+
+func (inbox *wsInbox) close() {
+	inbox.closeOnce.Do(func() {
+		close(inbox.closed)
+	})
+}
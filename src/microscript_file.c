@@ -0,0 +1,521 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * Native file access for the io:: module. Readers memory-map the file and
+ * hand lines to the JVM in batches, so a multi-gigabyte log costs a few
+ * JNI crossings per thousand lines and no per-line syscalls. Files that
+ * cannot be mapped (pipes, special files) are read through a growing
+ * buffer instead. Writers are stdio streams with a large buffer.
+ *
+ * A handle belongs to one script thread at a time; only opening and
+ * closing handles is synchronized. Writers still open when the process
+ * exits are flushed then, so an unclosed writer loses nothing.
+ */
+#include <jni.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "microscript_jni.h"
+
+#ifdef _WIN32
+#include <windows.h>
+static SRWLOCK ms_file_lock = SRWLOCK_INIT;
+#define MS_FILE_LOCK() AcquireSRWLockExclusive(&ms_file_lock)
+#define MS_FILE_UNLOCK() ReleaseSRWLockExclusive(&ms_file_lock)
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+static pthread_mutex_t ms_file_lock = PTHREAD_MUTEX_INITIALIZER;
+#define MS_FILE_LOCK() pthread_mutex_lock(&ms_file_lock)
+#define MS_FILE_UNLOCK() pthread_mutex_unlock(&ms_file_lock)
+#endif
+
+#define MS_MAX_FILES 256
+#define MS_STREAM_CHUNK (64 * 1024)
+#define MS_WRITE_BUFFER (1024 * 1024)
+#define MS_BATCH_MAX_BYTES (1024 * 1024)
+#define MS_RELEASE_STRIDE ((size_t)64 * 1024 * 1024)
+
+typedef struct {
+    int used;
+    int writer;
+
+    // Mapped reader
+    const char *map;
+    size_t size;
+    size_t pos;
+    size_t released;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    // Streamed reader, or writer
+    FILE *stream;
+    char *buffer;
+    size_t length;
+    size_t start;
+    size_t capacity;
+    int eof;
+} ms_file;
+
+static ms_file ms_files[MS_MAX_FILES];
+static int ms_file_atexit_registered = 0;
+
+static int ms_file_alloc(void) {
+    int handle = -1;
+    MS_FILE_LOCK();
+    for (int i = 0; i < MS_MAX_FILES; i++) {
+        if (!ms_files[i].used) {
+            memset(&ms_files[i], 0, sizeof(ms_file));
+            ms_files[i].used = 1;
+            handle = i;
+            break;
+        }
+    }
+    MS_FILE_UNLOCK();
+    return handle;
+}
+
+static ms_file *ms_file_get(jint handle, int writer) {
+    if (handle < 0 || handle >= MS_MAX_FILES || !ms_files[handle].used || ms_files[handle].writer != writer) {
+        return NULL;
+    }
+    return &ms_files[handle];
+}
+
+static void ms_file_release(ms_file *file) {
+    if (file->map != NULL) {
+#ifdef _WIN32
+        UnmapViewOfFile(file->map);
+        CloseHandle(file->mapping);
+        CloseHandle(file->file);
+#else
+        munmap((void*)file->map, file->size);
+#endif
+    }
+    // Detached under the lock so ms_file_flush_writers never sees a closing stream
+    MS_FILE_LOCK();
+    FILE *stream = file->stream;
+    file->stream = NULL;
+    MS_FILE_UNLOCK();
+    if (stream != NULL) {
+        fclose(stream);
+    }
+    free(file->buffer);
+
+    MS_FILE_LOCK();
+    file->used = 0;
+    MS_FILE_UNLOCK();
+}
+
+// Flush every open writer; runs at exit and from the JVM shutdown hook
+static void ms_file_flush_writers(void) {
+    MS_FILE_LOCK();
+    for (int i = 0; i < MS_MAX_FILES; i++) {
+        if (ms_files[i].used && ms_files[i].writer && ms_files[i].stream != NULL) {
+            fflush(ms_files[i].stream);
+        }
+    }
+    MS_FILE_UNLOCK();
+}
+
+// Map a whole file read-only; returns 0 when it cannot be mapped
+static int ms_file_map(ms_file *file, const char *path) {
+#ifdef _WIN32
+    int wide_length = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
+    wchar_t *wide = (wchar_t*)malloc(sizeof(wchar_t) * (wide_length > 0 ? wide_length : 1));
+    if (wide == NULL || MultiByteToWideChar(CP_UTF8, 0, path, -1, wide, wide_length) == 0) {
+        free(wide);
+        return 0;
+    }
+    HANDLE handle = CreateFileW(wide, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    free(wide);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0 || (uint64_t)size.QuadPart > SIZE_MAX) {
+        CloseHandle(handle);
+        return 0;
+    }
+    HANDLE mapping = CreateFileMappingW(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    const char *map = mapping != NULL ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (map == NULL) {
+        if (mapping != NULL) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(handle);
+        return 0;
+    }
+    file->file = handle;
+    file->mapping = mapping;
+    file->map = map;
+    file->size = (size_t)size.QuadPart;
+    return 1;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0
+        || (uint64_t)info.st_size > SIZE_MAX) {
+        close(fd);
+        return 0;
+    }
+    void *map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (map == MAP_FAILED) {
+        return 0;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(map, (size_t)info.st_size, MADV_SEQUENTIAL);
+#endif
+    file->map = (const char*)map;
+    file->size = (size_t)info.st_size;
+    return 1;
+#endif
+}
+
+static FILE *ms_file_fopen(const char *path, const char *mode) {
+#ifdef _WIN32
+    wchar_t wide_path[MAX_PATH];
+    wchar_t wide_mode[8];
+    if (MultiByteToWideChar(CP_UTF8, 0, path, -1, wide_path, MAX_PATH) == 0
+        || MultiByteToWideChar(CP_UTF8, 0, mode, -1, wide_mode, 8) == 0) {
+        return NULL;
+    }
+    return _wfopen(wide_path, wide_mode);
+#else
+    return fopen(path, mode);
+#endif
+}
+
+// After a mapped reader passes each stride, drop the pages it has consumed,
+// so resident memory stays flat however large the file is
+static void ms_file_release_consumed(ms_file *file) {
+#if !defined(_WIN32) && defined(MADV_DONTNEED)
+    if (file->pos - file->released >= MS_RELEASE_STRIDE) {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t end = file->pos / page * page;
+        if (end > file->released) {
+            madvise((void*)(file->map + file->released), end - file->released, MADV_DONTNEED);
+            file->released = end;
+        }
+    }
+#else
+    (void)file;
+#endif
+}
+
+// Next line without its terminator; returns 0 at end of file and -1 if the
+// buffer could not grow to hold the line. For streamed readers the line
+// points into the buffer and stays valid until the next call.
+static int ms_file_next_line(ms_file *file, const char **line, size_t *length) {
+    if (file->map != NULL) {
+        if (file->pos >= file->size) {
+            return 0;
+        }
+        const char *begin = file->map + file->pos;
+        const char *newline = (const char*)memchr(begin, '\n', file->size - file->pos);
+        size_t span = newline != NULL ? (size_t)(newline - begin) : file->size - file->pos;
+        file->pos += span + (newline != NULL ? 1 : 0);
+        *line = begin;
+        *length = span;
+    } else {
+        while (1) {
+            char *begin = file->buffer + file->start;
+            size_t available = file->length - file->start;
+            char *newline = (char*)memchr(begin, '\n', available);
+            if (newline != NULL) {
+                *line = begin;
+                *length = (size_t)(newline - begin);
+                file->start += *length + 1;
+                break;
+            }
+            if (file->eof) {
+                if (available == 0) {
+                    return 0;
+                }
+                *line = begin;
+                *length = available;
+                file->start = file->length;
+                break;
+            }
+
+            // Keep the partial line, make room and read more
+            memmove(file->buffer, begin, available);
+            file->length = available;
+            file->start = 0;
+            if (file->capacity - file->length < MS_STREAM_CHUNK) {
+                size_t capacity = file->capacity * 2;
+                char *grown = (char*)realloc(file->buffer, capacity);
+                if (grown == NULL) {
+                    return -1;
+                }
+                file->buffer = grown;
+                file->capacity = capacity;
+            }
+            size_t n = fread(file->buffer + file->length, 1, file->capacity - file->length, file->stream);
+            file->length += n;
+            if (n == 0) {
+                file->eof = 1;
+            }
+        }
+    }
+
+    if (*length > 0 && (*line)[*length - 1] == '\r') {
+        (*length)--;
+    }
+    return 1;
+}
+
+static int ms_append_u32(char **batch, size_t *length, size_t *capacity, const char *data, size_t size) {
+    size_t needed = *length + 4 + size;
+    if (needed > *capacity) {
+        size_t grown = *capacity * 2 > needed ? *capacity * 2 : needed;
+        char *larger = (char*)realloc(*batch, grown);
+        if (larger == NULL) {
+            return 0;
+        }
+        *batch = larger;
+        *capacity = grown;
+    }
+    uint32_t n = (uint32_t)size;
+    unsigned char *out = (unsigned char*)*batch + *length;
+    out[0] = (unsigned char)(n & 0xFF);
+    out[1] = (unsigned char)((n >> 8) & 0xFF);
+    out[2] = (unsigned char)((n >> 16) & 0xFF);
+    out[3] = (unsigned char)((n >> 24) & 0xFF);
+    if (size > 0) {
+        memcpy(out + 4, data, size);
+    }
+    *length = needed;
+    return 1;
+}
+
+// Open a file for line reading; -1 if it cannot be opened
+JNIEXPORT jint JNICALL Java_com_magayaga_microscript_NativeFile_openReader
+  (JNIEnv *env, jclass cls, jstring path) {
+    int handle = ms_file_alloc();
+    if (handle < 0) {
+        return -1;
+    }
+
+    ms_string pathStr;
+    ms_string_get(env, path, &pathStr);
+
+    ms_file *file = &ms_files[handle];
+    if (!ms_file_map(file, pathStr.chars)) {
+        file->stream = ms_file_fopen(pathStr.chars, "rb");
+        file->capacity = MS_STREAM_CHUNK * 2;
+        file->buffer = (char*)malloc(file->capacity);
+        if (file->stream == NULL || file->buffer == NULL) {
+            ms_file_release(file);
+            handle = -1;
+        }
+    }
+
+    ms_string_release(&pathStr);
+    return handle;
+}
+
+// Up to maxLines lines (and about 1 MiB) packed as a little-endian uint32
+// count followed by length-prefixed UTF-8 lines; null at end of file, or
+// with an OutOfMemoryError pending if a line did not fit in memory
+JNIEXPORT jbyteArray JNICALL Java_com_magayaga_microscript_NativeFile_readLines
+  (JNIEnv *env, jclass cls, jint handle, jint maxLines) {
+    ms_file *file = ms_file_get(handle, 0);
+    if (file == NULL) {
+        return NULL;
+    }
+
+    size_t capacity = 64 * 1024;
+    size_t length = 4;
+    char *batch = (char*)malloc(capacity);
+    if (batch == NULL) {
+        ms_throw(env, "java/lang/OutOfMemoryError", "cannot allocate a line batch");
+        return NULL;
+    }
+
+    uint32_t count = 0;
+    const char *line;
+    size_t line_length;
+    int status = 1;
+    while ((jint)count < maxLines && length < MS_BATCH_MAX_BYTES
+           && (status = ms_file_next_line(file, &line, &line_length)) > 0) {
+        if (!ms_append_u32(&batch, &length, &capacity, line, line_length)) {
+            status = -1;
+            break;
+        }
+        count++;
+    }
+    if (file->map != NULL) {
+        ms_file_release_consumed(file);
+    }
+    if (status < 0) {
+        free(batch);
+        ms_throw(env, "java/lang/OutOfMemoryError", "line too long to buffer");
+        return NULL;
+    }
+
+    jbyteArray result = NULL;
+    if (count > 0) {
+        batch[0] = (char)(count & 0xFF);
+        batch[1] = (char)((count >> 8) & 0xFF);
+        batch[2] = (char)((count >> 16) & 0xFF);
+        batch[3] = (char)((count >> 24) & 0xFF);
+        result = (*env)->NewByteArray(env, (jsize)length);
+        if (result != NULL) {
+            (*env)->SetByteArrayRegion(env, result, 0, (jsize)length, (const jbyte*)batch);
+        }
+    }
+
+    free(batch);
+    return result;
+}
+
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeFile_closeReader
+  (JNIEnv *env, jclass cls, jint handle) {
+    ms_file *file = ms_file_get(handle, 0);
+    if (file != NULL) {
+        ms_file_release(file);
+    }
+}
+
+// Whole file contents as UTF-8 bytes, copied once out of the mapping; null on
+// failure, with an OutOfMemoryError pending if an unmappable file outgrew memory
+JNIEXPORT jbyteArray JNICALL Java_com_magayaga_microscript_NativeFile_readAll
+  (JNIEnv *env, jclass cls, jstring path) {
+    jint handle = Java_com_magayaga_microscript_NativeFile_openReader(env, cls, path);
+    ms_file *file = ms_file_get(handle, 0);
+    if (file == NULL) {
+        return NULL;
+    }
+
+    jbyteArray result = NULL;
+    if (file->map != NULL) {
+        if (file->size <= 0x7FFFFFFF) {
+            result = (*env)->NewByteArray(env, (jsize)file->size);
+            if (result != NULL) {
+                (*env)->SetByteArrayRegion(env, result, 0, (jsize)file->size, (const jbyte*)file->map);
+            }
+        }
+    } else {
+        size_t n;
+        while ((n = fread(file->buffer + file->length, 1, file->capacity - file->length, file->stream)) > 0) {
+            file->length += n;
+            if (file->capacity - file->length < MS_STREAM_CHUNK) {
+                char *grown = (char*)realloc(file->buffer, file->capacity * 2);
+                if (grown == NULL) {
+                    ms_file_release(file);
+                    ms_throw(env, "java/lang/OutOfMemoryError", "file too large to buffer");
+                    return NULL;
+                }
+                file->buffer = grown;
+                file->capacity *= 2;
+            }
+        }
+        if (file->length <= 0x7FFFFFFF) {
+            result = (*env)->NewByteArray(env, (jsize)file->length);
+            if (result != NULL) {
+                (*env)->SetByteArrayRegion(env, result, 0, (jsize)file->length, (const jbyte*)file->buffer);
+            }
+        }
+    }
+
+    ms_file_release(file);
+    return result;
+}
+
+// Open a file for writing, truncating it unless append is true; -1 on failure
+JNIEXPORT jint JNICALL Java_com_magayaga_microscript_NativeFile_openWriter
+  (JNIEnv *env, jclass cls, jstring path, jboolean append) {
+    int handle = ms_file_alloc();
+    if (handle < 0) {
+        return -1;
+    }
+
+    ms_string pathStr;
+    ms_string_get(env, path, &pathStr);
+
+    ms_file *file = &ms_files[handle];
+    file->writer = 1;
+    file->stream = ms_file_fopen(pathStr.chars, append ? "ab" : "wb");
+    file->buffer = (char*)malloc(MS_WRITE_BUFFER);
+    if (file->stream == NULL || file->buffer == NULL) {
+        ms_file_release(file);
+        handle = -1;
+    } else {
+        setvbuf(file->stream, file->buffer, _IOFBF, MS_WRITE_BUFFER);
+        MS_FILE_LOCK();
+        if (!ms_file_atexit_registered) {
+            ms_file_atexit_registered = 1;
+            atexit(ms_file_flush_writers);
+        }
+        MS_FILE_UNLOCK();
+    }
+
+    ms_string_release(&pathStr);
+    return handle;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_magayaga_microscript_NativeFile_write
+  (JNIEnv *env, jclass cls, jint handle, jstring text) {
+    ms_file *file = ms_file_get(handle, 1);
+    if (file == NULL) {
+        return JNI_FALSE;
+    }
+
+    ms_string textStr;
+    ms_string_get(env, text, &textStr);
+    int ok = fwrite(textStr.chars, 1, textStr.length, file->stream) == textStr.length;
+    ms_string_release(&textStr);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+// Write each string followed by a newline in one crossing
+JNIEXPORT jboolean JNICALL Java_com_magayaga_microscript_NativeFile_writeLines
+  (JNIEnv *env, jclass cls, jint handle, jobjectArray lines) {
+    ms_file *file = ms_file_get(handle, 1);
+    if (file == NULL || lines == NULL) {
+        return JNI_FALSE;
+    }
+
+    int ok = 1;
+    jsize count = (*env)->GetArrayLength(env, lines);
+    for (jsize i = 0; i < count && ok; i++) {
+        jstring line = (jstring)(*env)->GetObjectArrayElement(env, lines, i);
+        ms_string lineStr;
+        ms_string_get(env, line, &lineStr);
+        ok = fwrite(lineStr.chars, 1, lineStr.length, file->stream) == lineStr.length
+             && fputc('\n', file->stream) != EOF;
+        ms_string_release(&lineStr);
+        (*env)->DeleteLocalRef(env, line);
+    }
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT jboolean JNICALL Java_com_magayaga_microscript_NativeFile_closeWriter
+  (JNIEnv *env, jclass cls, jint handle) {
+    ms_file *file = ms_file_get(handle, 1);
+    if (file == NULL) {
+        return JNI_FALSE;
+    }
+
+    int ok = fflush(file->stream) == 0;
+    ms_file_release(file);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeFile_flushWriters
+  (JNIEnv *env, jclass cls) {
+    ms_file_flush_writers();
+}
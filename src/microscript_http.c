@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "httpserver.h" // Go functions exported via CGO
+#include "microscript_jni.h"
 
 // JNI function naming convention: Java_packagename_classname_methodname
 // For com.magayaga.microscript.NativeHttp
@@ -17,6 +18,13 @@ JNIEXPORT jint JNICALL Java_com_magayaga_microscript_NativeHttp_createServer
     return createServer((int)port);
 }
 
+JNIEXPORT jint JNICALL Java_com_magayaga_microscript_NativeHttp_createServerWithOptions
+  (JNIEnv *env, jclass cls, jint port, jint readTimeoutMs, jint writeTimeoutMs, jint idleTimeoutMs,
+   jint maxHeaderBytes, jint maxConnections, jboolean h2c, jint listeners) {
+    return createServerWithOptions((int)port, (int)readTimeoutMs, (int)writeTimeoutMs, (int)idleTimeoutMs,
+                                   (int)maxHeaderBytes, (int)maxConnections, h2c == JNI_TRUE ? 1 : 0, (int)listeners);
+}
+
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_stopServer
   (JNIEnv *env, jclass cls, jint serverHandle) {
     stopServer((int)serverHandle);
@@ -29,66 +37,143 @@ JNIEXPORT jboolean JNICALL Java_com_magayaga_microscript_NativeHttp_isRunning
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_addRoute
   (JNIEnv *env, jclass cls, jint serverHandle, jstring method, jstring path, jstring handlerName) {
-    const char *methodStr = (*env)->GetStringUTFChars(env, method, NULL);
-    const char *pathStr = (*env)->GetStringUTFChars(env, path, NULL);
-    const char *handlerNameStr = (*env)->GetStringUTFChars(env, handlerName, NULL);
+    ms_string methodStr;
+    ms_string_get(env, method, &methodStr);
+    ms_string pathStr;
+    ms_string_get(env, path, &pathStr);
+    ms_string handlerNameStr;
+    ms_string_get(env, handlerName, &handlerNameStr);
     
-    addRoute((int)serverHandle, (char*)methodStr, (char*)pathStr, (char*)handlerNameStr);
+    addRoute((int)serverHandle, methodStr.chars, pathStr.chars, handlerNameStr.chars);
     
-    (*env)->ReleaseStringUTFChars(env, method, methodStr);
-    (*env)->ReleaseStringUTFChars(env, path, pathStr);
-    (*env)->ReleaseStringUTFChars(env, handlerName, handlerNameStr);
+    ms_string_release(&methodStr);
+    ms_string_release(&pathStr);
+    ms_string_release(&handlerNameStr);
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_removeRoute
   (JNIEnv *env, jclass cls, jint serverHandle, jstring method, jstring path) {
-    const char *methodStr = (*env)->GetStringUTFChars(env, method, NULL);
-    const char *pathStr = (*env)->GetStringUTFChars(env, path, NULL);
+    ms_string methodStr;
+    ms_string_get(env, method, &methodStr);
+    ms_string pathStr;
+    ms_string_get(env, path, &pathStr);
     
-    removeRoute((int)serverHandle, (char*)methodStr, (char*)pathStr);
+    removeRoute((int)serverHandle, methodStr.chars, pathStr.chars);
+    
+    ms_string_release(&methodStr);
+    ms_string_release(&pathStr);
+}
+
+// Script dispatch: worker threads block in awaitRequest for the next request
+
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_startDispatch
+  (JNIEnv *env, jclass cls, jint serverHandle, jint queueCapacity) {
+    startDispatch((int)serverHandle, (int)queueCapacity);
+}
+
+JNIEXPORT jlong JNICALL Java_com_magayaga_microscript_NativeHttp_awaitRequest
+  (JNIEnv *env, jclass cls, jint serverHandle, jint timeoutMs) {
+    GoInt handlerSlot = 0;
+    GoInt requestId = awaitRequest((int)serverHandle, (int)timeoutMs, &handlerSlot);
+    if (requestId < 0) {
+        return (jlong)requestId;
+    }
     
-    (*env)->ReleaseStringUTFChars(env, method, methodStr);
-    (*env)->ReleaseStringUTFChars(env, path, pathStr);
+    // Pack the handler slot into the high word and the request id into the low word
+    return ((jlong)handlerSlot << 32) | ((jlong)requestId & 0xFFFFFFFFL);
+}
+
+JNIEXPORT jstring JNICALL Java_com_magayaga_microscript_NativeHttp_getHandlerName
+  (JNIEnv *env, jclass cls, jint serverHandle, jint handlerSlot) {
+    char *name = getHandlerName((int)serverHandle, (int)handlerSlot);
+    jstring result = (*env)->NewStringUTF(env, name);
+    free(name);
+    return result;
+}
+
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_finishRequest
+  (JNIEnv *env, jclass cls, jint requestId) {
+    finishRequest((int)requestId);
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_setResponseHeader
   (JNIEnv *env, jclass cls, jint requestId, jstring name, jstring value) {
-    const char *nameStr = (*env)->GetStringUTFChars(env, name, NULL);
-    const char *valueStr = (*env)->GetStringUTFChars(env, value, NULL);
+    ms_string nameStr;
+    ms_string_get(env, name, &nameStr);
+    ms_string valueStr;
+    ms_string_get(env, value, &valueStr);
     
-    setResponseHeader((int)requestId, (char*)nameStr, (char*)valueStr);
+    setResponseHeader((int)requestId, nameStr.chars, valueStr.chars);
     
-    (*env)->ReleaseStringUTFChars(env, name, nameStr);
-    (*env)->ReleaseStringUTFChars(env, value, valueStr);
+    ms_string_release(&nameStr);
+    ms_string_release(&valueStr);
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_sendResponse
   (JNIEnv *env, jclass cls, jint requestId, jint statusCode, jstring contentType, jstring body) {
-    const char *contentTypeStr = (*env)->GetStringUTFChars(env, contentType, NULL);
-    const char *bodyStr = (*env)->GetStringUTFChars(env, body, NULL);
+    ms_string contentTypeStr;
+    ms_string_get(env, contentType, &contentTypeStr);
+    ms_string bodyStr;
+    ms_string_get(env, body, &bodyStr);
     
-    sendResponse((int)requestId, (int)statusCode, (char*)contentTypeStr, (char*)bodyStr);
+    sendResponseBytes((int)requestId, (int)statusCode, contentTypeStr.chars, bodyStr.chars, (int)bodyStr.length);
     
-    (*env)->ReleaseStringUTFChars(env, contentType, contentTypeStr);
-    (*env)->ReleaseStringUTFChars(env, body, bodyStr);
+    ms_string_release(&contentTypeStr);
+    ms_string_release(&bodyStr);
+}
+
+// Interned header names and content types: the string crosses once, then
+// hot calls pass its ID
+
+JNIEXPORT jint JNICALL Java_com_magayaga_microscript_NativeHttp_internString
+  (JNIEnv *env, jclass cls, jstring value) {
+    ms_string valueStr;
+    ms_string_get(env, value, &valueStr);
+    
+    int id = internString(valueStr.chars);
+    
+    ms_string_release(&valueStr);
+    return (jint)id;
+}
+
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_setResponseHeaderInterned
+  (JNIEnv *env, jclass cls, jint requestId, jint nameId, jstring value) {
+    ms_string valueStr;
+    ms_string_get(env, value, &valueStr);
+    
+    setResponseHeaderInterned((int)requestId, (int)nameId, valueStr.chars);
+    
+    ms_string_release(&valueStr);
+}
+
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_sendResponseInterned
+  (JNIEnv *env, jclass cls, jint requestId, jint statusCode, jint contentTypeId, jstring body) {
+    ms_string bodyStr;
+    ms_string_get(env, body, &bodyStr);
+    
+    sendResponseInterned((int)requestId, (int)statusCode, (int)contentTypeId, bodyStr.chars, (int)bodyStr.length);
+    
+    ms_string_release(&bodyStr);
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_sendJsonResponse
   (JNIEnv *env, jclass cls, jint requestId, jint statusCode, jstring jsonBody) {
-    const char *jsonBodyStr = (*env)->GetStringUTFChars(env, jsonBody, NULL);
+    ms_string jsonBodyStr;
+    ms_string_get(env, jsonBody, &jsonBodyStr);
     
-    sendJsonResponse((int)requestId, (int)statusCode, (char*)jsonBodyStr);
+    sendResponseBytes((int)requestId, (int)statusCode, "application/json", jsonBodyStr.chars, (int)jsonBodyStr.length);
     
-    (*env)->ReleaseStringUTFChars(env, jsonBody, jsonBodyStr);
+    ms_string_release(&jsonBodyStr);
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_sendFileResponse
   (JNIEnv *env, jclass cls, jint requestId, jstring filePath) {
-    const char *filePathStr = (*env)->GetStringUTFChars(env, filePath, NULL);
+    ms_string filePathStr;
+    ms_string_get(env, filePath, &filePathStr);
     
-    sendFileResponse((int)requestId, (char*)filePathStr);
+    sendFileResponse((int)requestId, filePathStr.chars);
     
-    (*env)->ReleaseStringUTFChars(env, filePath, filePathStr);
+    ms_string_release(&filePathStr);
 }
 
 JNIEXPORT jstring JNICALL Java_com_magayaga_microscript_NativeHttp_getRequestPath
@@ -109,12 +194,13 @@ JNIEXPORT jstring JNICALL Java_com_magayaga_microscript_NativeHttp_getRequestMet
 
 JNIEXPORT jstring JNICALL Java_com_magayaga_microscript_NativeHttp_getRequestHeader
   (JNIEnv *env, jclass cls, jint requestId, jstring headerName) {
-    const char *headerNameStr = (*env)->GetStringUTFChars(env, headerName, NULL);
+    ms_string headerNameStr;
+    ms_string_get(env, headerName, &headerNameStr);
     
-    char *headerValue = getRequestHeader((int)requestId, (char*)headerNameStr);
+    char *headerValue = getRequestHeader((int)requestId, headerNameStr.chars);
     jstring result = (*env)->NewStringUTF(env, headerValue);
     
-    (*env)->ReleaseStringUTFChars(env, headerName, headerNameStr);
+    ms_string_release(&headerNameStr);
     free(headerValue);
     return result;
 }
@@ -129,45 +215,97 @@ JNIEXPORT jstring JNICALL Java_com_magayaga_microscript_NativeHttp_getRequestBod
 
 JNIEXPORT jstring JNICALL Java_com_magayaga_microscript_NativeHttp_getQueryParam
   (JNIEnv *env, jclass cls, jint requestId, jstring paramName) {
-    const char *paramNameStr = (*env)->GetStringUTFChars(env, paramName, NULL);
+    ms_string paramNameStr;
+    ms_string_get(env, paramName, &paramNameStr);
     
-    char *paramValue = getQueryParam((int)requestId, (char*)paramNameStr);
+    char *paramValue = getQueryParam((int)requestId, paramNameStr.chars);
     jstring result = (*env)->NewStringUTF(env, paramValue);
     
-    (*env)->ReleaseStringUTFChars(env, paramName, paramNameStr);
+    ms_string_release(&paramNameStr);
     free(paramValue);
     return result;
 }
 
+JNIEXPORT jbyteArray JNICALL Java_com_magayaga_microscript_NativeHttp_getRequestSnapshot
+  (JNIEnv *env, jclass cls, jint requestId) {
+    GoInt length = 0;
+    char *snapshot = getRequestSnapshot((int)requestId, &length);
+    
+    jbyteArray result = (*env)->NewByteArray(env, (jsize)length);
+    if (result != NULL && length > 0) {
+        (*env)->SetByteArrayRegion(env, result, 0, (jsize)length, (const jbyte*)snapshot);
+    }
+    
+    free(snapshot);
+    return result;
+}
+
+// Byte-oriented bodies over direct ByteBuffers: Go reads from the socket
+// straight into the buffer's memory and writes responses straight from it
+
+JNIEXPORT jint JNICALL Java_com_magayaga_microscript_NativeHttp_getRequestBodyLength
+  (JNIEnv *env, jclass cls, jint requestId) {
+    return (jint)getRequestBodyLength((int)requestId);
+}
+
+JNIEXPORT jint JNICALL Java_com_magayaga_microscript_NativeHttp_readRequestBody
+  (JNIEnv *env, jclass cls, jint requestId, jobject buffer, jint offset, jint length) {
+    char *address = ms_direct_range(env, buffer, offset, length);
+    if (address == NULL) {
+        return -1; // IllegalArgumentException pending
+    }
+    
+    return (jint)readRequestBody((int)requestId, address + offset, (int)length);
+}
+
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_sendResponseBytes
+  (JNIEnv *env, jclass cls, jint requestId, jint statusCode, jstring contentType, jobject body, jint offset, jint length) {
+    char *address = ms_direct_range(env, body, offset, length);
+    if (address == NULL) {
+        return; // IllegalArgumentException pending
+    }
+    
+    ms_string contentTypeStr;
+    ms_string_get(env, contentType, &contentTypeStr);
+    
+    sendResponseBytes((int)requestId, (int)statusCode, contentTypeStr.chars,
+                      address + offset, (int)length);
+    
+    ms_string_release(&contentTypeStr);
+}
+
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_useMiddleware
   (JNIEnv *env, jclass cls, jint serverHandle, jstring middlewareName) {
-    const char *middlewareNameStr = (*env)->GetStringUTFChars(env, middlewareName, NULL);
+    ms_string middlewareNameStr;
+    ms_string_get(env, middlewareName, &middlewareNameStr);
     
-    useMiddleware((int)serverHandle, (char*)middlewareNameStr);
+    useMiddleware((int)serverHandle, middlewareNameStr.chars);
     
-    (*env)->ReleaseStringUTFChars(env, middlewareName, middlewareNameStr);
+    ms_string_release(&middlewareNameStr);
 }
 
 JNIEXPORT jstring JNICALL Java_com_magayaga_microscript_NativeHttp_urlEncode
   (JNIEnv *env, jclass cls, jstring input) {
-    const char *inputStr = (*env)->GetStringUTFChars(env, input, NULL);
+    ms_string inputStr;
+    ms_string_get(env, input, &inputStr);
     
-    char *encoded = urlEncode((char*)inputStr);
+    char *encoded = urlEncode(inputStr.chars);
     jstring result = (*env)->NewStringUTF(env, encoded);
     
-    (*env)->ReleaseStringUTFChars(env, input, inputStr);
+    ms_string_release(&inputStr);
     free(encoded);
     return result;
 }
 
 JNIEXPORT jstring JNICALL Java_com_magayaga_microscript_NativeHttp_urlDecode
   (JNIEnv *env, jclass cls, jstring input) {
-    const char *inputStr = (*env)->GetStringUTFChars(env, input, NULL);
+    ms_string inputStr;
+    ms_string_get(env, input, &inputStr);
     
-    char *decoded = urlDecode((char*)inputStr);
+    char *decoded = urlDecode(inputStr.chars);
     jstring result = (*env)->NewStringUTF(env, decoded);
     
-    (*env)->ReleaseStringUTFChars(env, input, inputStr);
+    ms_string_release(&inputStr);
     free(decoded);
     return result;
 }
@@ -182,39 +320,86 @@ JNIEXPORT jstring JNICALL Java_com_magayaga_microscript_NativeHttp_generateUuid
 
 JNIEXPORT jint JNICALL Java_com_magayaga_microscript_NativeHttp_createWebSocketEndpoint
   (JNIEnv *env, jclass cls, jint serverHandle, jstring path) {
-    const char *pathStr = (*env)->GetStringUTFChars(env, path, NULL);
+    ms_string pathStr;
+    ms_string_get(env, path, &pathStr);
     
-    int result = createWebSocketEndpoint((int)serverHandle, (char*)pathStr);
+    int result = createWebSocketEndpoint((int)serverHandle, pathStr.chars);
     
-    (*env)->ReleaseStringUTFChars(env, path, pathStr);
+    ms_string_release(&pathStr);
     return result;
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_sendWebSocketMessage
   (JNIEnv *env, jclass cls, jint endpointHandle, jstring clientId, jstring message) {
-    const char *clientIdStr = (*env)->GetStringUTFChars(env, clientId, NULL);
-    const char *messageStr = (*env)->GetStringUTFChars(env, message, NULL);
+    ms_string clientIdStr;
+    ms_string_get(env, clientId, &clientIdStr);
+    ms_string messageStr;
+    ms_string_get(env, message, &messageStr);
     
-    sendWebSocketMessage((int)endpointHandle, (char*)clientIdStr, (char*)messageStr);
+    sendWebSocketMessage((int)endpointHandle, clientIdStr.chars, messageStr.chars);
     
-    (*env)->ReleaseStringUTFChars(env, clientId, clientIdStr);
-    (*env)->ReleaseStringUTFChars(env, message, messageStr);
+    ms_string_release(&clientIdStr);
+    ms_string_release(&messageStr);
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_broadcastWebSocketMessage
   (JNIEnv *env, jclass cls, jint endpointHandle, jstring message) {
-    const char *messageStr = (*env)->GetStringUTFChars(env, message, NULL);
+    ms_string messageStr;
+    ms_string_get(env, message, &messageStr);
     
-    broadcastWebSocketMessage((int)endpointHandle, (char*)messageStr);
+    broadcastWebSocketMessage((int)endpointHandle, messageStr.chars);
     
-    (*env)->ReleaseStringUTFChars(env, message, messageStr);
+    ms_string_release(&messageStr);
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_closeWebSocketConnection
   (JNIEnv *env, jclass cls, jint endpointHandle, jstring clientId) {
-    const char *clientIdStr = (*env)->GetStringUTFChars(env, clientId, NULL);
+    ms_string clientIdStr;
+    ms_string_get(env, clientId, &clientIdStr);
     
-    closeWebSocketConnection((int)endpointHandle, (char*)clientIdStr);
+    closeWebSocketConnection((int)endpointHandle, clientIdStr.chars);
     
-    (*env)->ReleaseStringUTFChars(env, clientId, clientIdStr);
+    ms_string_release(&clientIdStr);
+}
+
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_enableWebSocketInbox
+  (JNIEnv *env, jclass cls, jint endpointHandle, jint capacity) {
+    enableWebSocketInbox((int)endpointHandle, (int)capacity);
+}
+
+JNIEXPORT jbyteArray JNICALL Java_com_magayaga_microscript_NativeHttp_drainWebSocketMessages
+  (JNIEnv *env, jclass cls, jint endpointHandle, jint maxMessages, jint timeoutMs) {
+    GoInt length = 0;
+    char *batch = drainWebSocketMessages((int)endpointHandle, (int)maxMessages, (int)timeoutMs, &length);
+    
+    // A negative length means the endpoint is gone
+    if (length < 0) {
+        return NULL;
+    }
+    
+    jbyteArray result = (*env)->NewByteArray(env, (jsize)length);
+    if (result != NULL && length > 0) {
+        (*env)->SetByteArrayRegion(env, result, 0, (jsize)length, (const jbyte*)batch);
+    }
+    
+    free(batch);
+    return result;
+}
+
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeHttp_enableMetricsEndpoint
+  (JNIEnv *env, jclass cls, jint serverHandle, jstring path) {
+    ms_string pathStr;
+    ms_string_get(env, path, &pathStr);
+    
+    enableMetricsEndpoint((int)serverHandle, pathStr.chars);
+    
+    ms_string_release(&pathStr);
+}
+
+JNIEXPORT jstring JNICALL Java_com_magayaga_microscript_NativeHttp_getServerStats
+  (JNIEnv *env, jclass cls, jint serverHandle) {
+    char *stats = getServerStats((int)serverHandle);
+    jstring result = (*env)->NewStringUTF(env, stats);
+    free(stats);
+    return result;
 }
@@ -1,48 +1,184 @@
 /**
  * MicroScript — The programming language
- * Copyright (c) 2025 Cyril John Magayaga
- * 
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
  * It was originally written in C programming language.
  */
 #include <jni.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "microscript_jni.h"
 
+#ifdef _WIN32
+#include <windows.h>
+static SRWLOCK ms_io_lock = SRWLOCK_INIT;
+#define MS_IO_LOCK() AcquireSRWLockExclusive(&ms_io_lock)
+#define MS_IO_UNLOCK() ReleaseSRWLockExclusive(&ms_io_lock)
+#else
+#include <pthread.h>
+static pthread_mutex_t ms_io_lock = PTHREAD_MUTEX_INITIALIZER;
+#define MS_IO_LOCK() pthread_mutex_lock(&ms_io_lock)
+#define MS_IO_UNLOCK() pthread_mutex_unlock(&ms_io_lock)
+#endif
+
+// Output buffering
+//
+// Output is collected in one native buffer and handed to stdout with a
+// single fwrite + fflush. The mode decides when that happens:
+//   MS_IO_UNBUFFERED  after every call (the historical behaviour)
+//   MS_IO_LINE        whenever a call ends a line
+//   MS_IO_FULL        when the buffer fills, after flush_lines newlines,
+//                     on NativeIo.flush, or at exit
+#define MS_IO_UNBUFFERED 0
+#define MS_IO_LINE 1
+#define MS_IO_FULL 2
+
+#define MS_IO_BUFFER_SIZE (64 * 1024)
+#define MS_IO_DEFAULT_FLUSH_LINES 1024
+
+static char ms_io_buffer[MS_IO_BUFFER_SIZE];
+static size_t ms_io_length = 0;
+static int ms_io_mode = MS_IO_UNBUFFERED;
+static int ms_io_flush_lines = MS_IO_DEFAULT_FLUSH_LINES;
+static int ms_io_pending_lines = 0;
+static int ms_io_atexit_registered = 0;
+
+// Callers hold ms_io_lock
+static void ms_io_flush_locked(void) {
+    if (ms_io_length > 0) {
+        fwrite(ms_io_buffer, 1, ms_io_length, stdout);
+        ms_io_length = 0;
+    }
+    ms_io_pending_lines = 0;
+    fflush(stdout);
+}
+
+static void ms_io_write_locked(const char *data, size_t length) {
+    if (ms_io_length + length > MS_IO_BUFFER_SIZE) {
+        ms_io_flush_locked();
+    }
+    if (length > MS_IO_BUFFER_SIZE) {
+        fwrite(data, 1, length, stdout); // too large to stage
+        return;
+    }
+    memcpy(ms_io_buffer + ms_io_length, data, length);
+    ms_io_length += length;
+}
+
+static void ms_io_newline_locked(void) {
+    ms_io_write_locked("\n", 1);
+    ms_io_pending_lines++;
+}
+
+// End of one print call: flush if the mode asks for it
+static void ms_io_commit_locked(int ended_line) {
+    if (ms_io_mode == MS_IO_UNBUFFERED
+        || (ms_io_mode == MS_IO_LINE && ended_line)
+        || (ms_io_mode == MS_IO_FULL && ms_io_pending_lines >= ms_io_flush_lines)) {
+        ms_io_flush_locked();
+    }
+}
+
+static void ms_io_flush(void) {
+    MS_IO_LOCK();
+    ms_io_flush_locked();
+    MS_IO_UNLOCK();
+}
+
+static void ms_io_write_string(JNIEnv *env, jstring message, int newline) {
+    ms_string msg;
+    ms_string_get(env, message, &msg);
+
+    MS_IO_LOCK();
+    ms_io_write_locked(msg.chars, msg.length);
+    if (newline) {
+        ms_io_newline_locked();
+    }
+    ms_io_commit_locked(newline || (msg.length > 0 && msg.chars[msg.length - 1] == '\n'));
+    MS_IO_UNLOCK();
+
+    ms_string_release(&msg);
+}
+
+static void ms_io_write_char(jint code, int newline) {
+    char c = (char)(unsigned char)code;
+
+    MS_IO_LOCK();
+    ms_io_write_locked(&c, 1);
+    if (newline) {
+        ms_io_newline_locked();
+    }
+    ms_io_commit_locked(newline || c == '\n');
+    MS_IO_UNLOCK();
+}
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeIo_print__Ljava_lang_String_2
   (JNIEnv *env, jclass cls, jstring message)
 {
-    const char *msg = (*env)->GetStringUTFChars(env, message, NULL);
-    if (msg == NULL) return; // JVM threw OutOfMemoryError
-
-    printf("%s", msg);
-    fflush(stdout);
-    (*env)->ReleaseStringUTFChars(env, message, msg);
+    ms_io_write_string(env, message, 0);
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeIo_println__Ljava_lang_String_2
   (JNIEnv *env, jclass cls, jstring message)
 {
-    const char *msg = (*env)->GetStringUTFChars(env, message, NULL);
-    if (msg == NULL) return;
-
-    printf("%s\n", msg);
-    fflush(stdout);
-    (*env)->ReleaseStringUTFChars(env, message, msg);
+    ms_io_write_string(env, message, 1);
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeIo_print__I
   (JNIEnv *env, jclass cls, jint code)
 {
-    unsigned char c = (unsigned char) code;
-    putchar(c);
-    fflush(stdout);
+    ms_io_write_char(code, 0);
 }
 
 JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeIo_println__I
   (JNIEnv *env, jclass cls, jint code)
 {
-    unsigned char c = (unsigned char) code;
-    putchar(c);
-    putchar('\n');
-    fflush(stdout);
+    ms_io_write_char(code, 1);
+}
+
+// Write each string followed by a newline, in one crossing and one flush
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeIo_printBatch
+  (JNIEnv *env, jclass cls, jobjectArray lines)
+{
+    if (lines == NULL) return;
+    jsize count = (*env)->GetArrayLength(env, lines);
+
+    MS_IO_LOCK();
+    for (jsize i = 0; i < count; i++) {
+        jstring line = (jstring)(*env)->GetObjectArrayElement(env, lines, i);
+        ms_string msg;
+        ms_string_get(env, line, &msg);
+        ms_io_write_locked(msg.chars, msg.length);
+        ms_io_newline_locked();
+        ms_string_release(&msg);
+        (*env)->DeleteLocalRef(env, line);
+
+        if (ms_io_mode == MS_IO_FULL && ms_io_pending_lines >= ms_io_flush_lines) {
+            ms_io_flush_locked();
+        }
+    }
+    ms_io_commit_locked(count > 0);
+    MS_IO_UNLOCK();
+}
+
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeIo_flush
+  (JNIEnv *env, jclass cls)
+{
+    ms_io_flush();
+}
+
+// Select MS_IO_UNBUFFERED, MS_IO_LINE or MS_IO_FULL; flushLines <= 0 keeps the default
+JNIEXPORT void JNICALL Java_com_magayaga_microscript_NativeIo_setBufferMode
+  (JNIEnv *env, jclass cls, jint mode, jint flushLines)
+{
+    MS_IO_LOCK();
+    ms_io_flush_locked();
+    ms_io_mode = mode == MS_IO_LINE || mode == MS_IO_FULL ? (int)mode : MS_IO_UNBUFFERED;
+    ms_io_flush_lines = flushLines > 0 ? (int)flushLines : MS_IO_DEFAULT_FLUSH_LINES;
+    if (!ms_io_atexit_registered) {
+        ms_io_atexit_registered = 1;
+        atexit(ms_io_flush);
+    }
+    MS_IO_UNLOCK();
 }
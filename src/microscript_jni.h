@@ -0,0 +1,129 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * JNI helpers shared by the native libraries
+ */
+#ifndef MICROSCRIPT_JNI_H
+#define MICROSCRIPT_JNI_H
+
+#include <jni.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+// String marshalling
+//
+// Arguments are encoded to standard UTF-8 directly from the string's UTF-16
+// contents inside a critical region, instead of GetStringUTFChars building
+// (and usually allocating) a modified-UTF-8 copy. Strings that fit in
+// MS_STRING_STACK bytes stay in the caller's stack frame; longer ones take a
+// single malloc. A null jstring marshals as "".
+#define MS_STRING_STACK 256
+
+typedef struct {
+    char *chars;
+    size_t length;
+    char stack[MS_STRING_STACK];
+} ms_string;
+
+static inline size_t ms_encode_utf8(const jchar *units, jsize count, char *out) {
+    size_t n = 0;
+    for (jsize i = 0; i < count; i++) {
+        unsigned int c = units[i];
+        if (c >= 0xD800 && c <= 0xDBFF && i + 1 < count && units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+            c = 0x10000 + ((c - 0xD800) << 10) + (units[++i] - 0xDC00);
+        } else if (c >= 0xD800 && c <= 0xDFFF) {
+            c = 0xFFFD; // unpaired surrogate
+        }
+        
+        if (c < 0x80) {
+            out[n++] = (char)c;
+        } else if (c < 0x800) {
+            out[n++] = (char)(0xC0 | (c >> 6));
+            out[n++] = (char)(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            out[n++] = (char)(0xE0 | (c >> 12));
+            out[n++] = (char)(0x80 | ((c >> 6) & 0x3F));
+            out[n++] = (char)(0x80 | (c & 0x3F));
+        } else {
+            out[n++] = (char)(0xF0 | (c >> 18));
+            out[n++] = (char)(0x80 | ((c >> 12) & 0x3F));
+            out[n++] = (char)(0x80 | ((c >> 6) & 0x3F));
+            out[n++] = (char)(0x80 | (c & 0x3F));
+        }
+    }
+    return n;
+}
+
+static inline void ms_string_get(JNIEnv *env, jstring value, ms_string *str) {
+    str->chars = str->stack;
+    str->length = 0;
+    str->stack[0] = '\0';
+    if (value == NULL) {
+        return;
+    }
+    
+    // A UTF-16 unit never needs more than three UTF-8 bytes
+    jsize count = (*env)->GetStringLength(env, value);
+    size_t capacity = (size_t)count * 3 + 1;
+    if (capacity > MS_STRING_STACK) {
+        char *heap = (char*)malloc(capacity);
+        if (heap == NULL) {
+            return;
+        }
+        str->chars = heap;
+    }
+    
+    const jchar *units = (*env)->GetStringCritical(env, value, NULL);
+    if (units != NULL) {
+        str->length = ms_encode_utf8(units, count, str->chars);
+        (*env)->ReleaseStringCritical(env, value, units);
+    }
+    str->chars[str->length] = '\0';
+}
+
+static inline void ms_string_release(ms_string *str) {
+    if (str->chars != str->stack) {
+        free(str->chars);
+    }
+}
+
+// Leave a pending exception of the named class, e.g. "java/lang/OutOfMemoryError"
+static inline void ms_throw(JNIEnv *env, const char *className, const char *message) {
+    jclass exception = (*env)->FindClass(env, className);
+    if (exception != NULL) {
+        (*env)->ThrowNew(env, exception, message);
+    }
+}
+
+// Whether value is non-null; otherwise a NullPointerException naming it is pending
+static inline int ms_require(JNIEnv *env, jobject value, const char *name) {
+    if (value == NULL) {
+        ms_throw(env, "java/lang/NullPointerException", name);
+        return 0;
+    }
+    return 1;
+}
+
+// Address of bytes [offset, offset + length) of a direct ByteBuffer. Returns
+// NULL with an IllegalArgumentException pending when the buffer is not a
+// direct one or the range does not lie within its capacity, so a bad offset
+// from a script can never become an out-of-bounds native access
+static inline char *ms_direct_range(JNIEnv *env, jobject buffer, jint offset, jint length) {
+    char *address = buffer != NULL ? (char*)(*env)->GetDirectBufferAddress(env, buffer) : NULL;
+    const char *problem = NULL;
+    if (address == NULL) {
+        problem = "buffer must be a direct ByteBuffer";
+    } else if (offset < 0 || length < 0 ||
+               (jlong)offset + (jlong)length > (*env)->GetDirectBufferCapacity(env, buffer)) {
+        problem = "offset and length must lie within the buffer";
+    }
+    
+    if (problem != NULL) {
+        ms_throw(env, "java/lang/IllegalArgumentException", problem);
+        return NULL;
+    }
+    return address;
+}
+
+#endif // MICROSCRIPT_JNI_H
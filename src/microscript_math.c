@@ -7,6 +7,7 @@
 #include <jni.h>
 #include <math.h>
 #include <stdio.h>
+#include "microscript_simd.h"
 
 // Square root
 JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_sqrt(JNIEnv *env, jclass cls, jdouble value) {
@@ -73,6 +74,31 @@ JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_TWINPRIME(JNI
     return 0.66016181584686957392;
 }
 
+// All of the constants above in one call, in the order NativeMath.CONSTANT_NAMES lists them
+static const double ms_constants[] = {
+    M_PI,
+    M_E,
+    6.28318530717958647692,  // tau
+    1.61803398874989484820,  // phi
+    2.41421356237309504880,  // silver ratio
+    0.57721566490153286060,  // Euler's constant
+    0.91596559417721901505,  // Catalan's constant
+    1.20205690315959428540,  // Apéry's constant
+    4.66920160910299067185,  // Feigenbaum delta
+    2.50290787509589282228,  // Feigenbaum alpha
+    1.32471795724474602596,  // plastic constant
+    0.66016181584686957392   // twin prime constant
+};
+
+JNIEXPORT jdoubleArray JNICALL Java_com_magayaga_microscript_NativeMath_constants(JNIEnv *env, jclass cls) {
+    jsize count = (jsize)(sizeof(ms_constants) / sizeof(ms_constants[0]));
+    jdoubleArray result = (*env)->NewDoubleArray(env, count);
+    if (result != NULL) {
+        (*env)->SetDoubleArrayRegion(env, result, 0, count, ms_constants);
+    }
+    return result;
+}
+
 // Square
 JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_square
   (JNIEnv *env, jclass cls, jdouble value) {
@@ -217,3 +243,137 @@ JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_min(JNIEnv *e
 JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_max(JNIEnv *env, jclass cls, jdouble a, jdouble b) {
     return fmax(a, b);
 }
+
+// Array kernels
+//
+// Each entry point maps a whole double[] in one JNI crossing. The arrays are
+// pinned with GetPrimitiveArrayCritical while the kernel runs, so the loop
+// must not call back into the JVM. sqrt, square, abs and fma use explicit
+// SIMD (see microscript_simd.h); the libm-based kernels are plain loops the
+// compiler may vectorize where a vector math library is available.
+typedef void (*ms_unary_kernel)(const double *in, double *out, size_t n);
+
+#define MS_LIBM_KERNEL(name, expr) \
+    static void ms_##name##_kernel(const double *in, double *out, size_t n) { \
+        for (size_t i = 0; i < n; i++) { \
+            double x = in[i]; \
+            out[i] = (expr); \
+        } \
+    }
+
+MS_LIBM_KERNEL(cube, x * x * x)
+MS_LIBM_KERNEL(cbrt, cbrt(x))
+MS_LIBM_KERNEL(log, log(x))
+MS_LIBM_KERNEL(log2, log2(x))
+MS_LIBM_KERNEL(log10, log10(x))
+MS_LIBM_KERNEL(sin, sin(x))
+MS_LIBM_KERNEL(cos, cos(x))
+MS_LIBM_KERNEL(tan, tan(x))
+
+static jdoubleArray ms_map_unary(JNIEnv *env, jdoubleArray values, ms_unary_kernel kernel) {
+    if (values == NULL) {
+        return NULL;
+    }
+    
+    jsize length = (*env)->GetArrayLength(env, values);
+    jdoubleArray result = (*env)->NewDoubleArray(env, length);
+    if (result == NULL || length == 0) {
+        return result;
+    }
+    
+    double *in = (double*)(*env)->GetPrimitiveArrayCritical(env, values, NULL);
+    double *out = in != NULL ? (double*)(*env)->GetPrimitiveArrayCritical(env, result, NULL) : NULL;
+    if (out != NULL) {
+        kernel(in, out, (size_t)length);
+        (*env)->ReleasePrimitiveArrayCritical(env, result, out, 0);
+    }
+    if (in != NULL) {
+        (*env)->ReleasePrimitiveArrayCritical(env, values, in, JNI_ABORT);
+    }
+    return result;
+}
+
+#define MS_ARRAY_ENTRY(name, kernel) \
+    JNIEXPORT jdoubleArray JNICALL Java_com_magayaga_microscript_NativeMath_##name##Array \
+      (JNIEnv *env, jclass cls, jdoubleArray values) { \
+        return ms_map_unary(env, values, kernel); \
+    }
+
+MS_ARRAY_ENTRY(sqrt, ms_simd_sqrt)
+MS_ARRAY_ENTRY(square, ms_simd_square)
+MS_ARRAY_ENTRY(abs, ms_simd_abs)
+MS_ARRAY_ENTRY(cube, ms_cube_kernel)
+MS_ARRAY_ENTRY(cbrt, ms_cbrt_kernel)
+MS_ARRAY_ENTRY(log, ms_log_kernel)
+MS_ARRAY_ENTRY(log2, ms_log2_kernel)
+MS_ARRAY_ENTRY(log10, ms_log10_kernel)
+MS_ARRAY_ENTRY(sin, ms_sin_kernel)
+MS_ARRAY_ENTRY(cos, ms_cos_kernel)
+MS_ARRAY_ENTRY(tan, ms_tan_kernel)
+
+// Power of every element to one exponent
+JNIEXPORT jdoubleArray JNICALL Java_com_magayaga_microscript_NativeMath_powArray
+  (JNIEnv *env, jclass cls, jdoubleArray values, jdouble exponent) {
+    if (exponent == 2.0) {
+        return ms_map_unary(env, values, ms_simd_square);
+    }
+    if (values == NULL) {
+        return NULL;
+    }
+    
+    jsize length = (*env)->GetArrayLength(env, values);
+    jdoubleArray result = (*env)->NewDoubleArray(env, length);
+    if (result == NULL || length == 0) {
+        return result;
+    }
+    
+    double *in = (double*)(*env)->GetPrimitiveArrayCritical(env, values, NULL);
+    double *out = in != NULL ? (double*)(*env)->GetPrimitiveArrayCritical(env, result, NULL) : NULL;
+    if (out != NULL) {
+        for (jsize i = 0; i < length; i++) {
+            out[i] = pow(in[i], exponent);
+        }
+        (*env)->ReleasePrimitiveArrayCritical(env, result, out, 0);
+    }
+    if (in != NULL) {
+        (*env)->ReleasePrimitiveArrayCritical(env, values, in, JNI_ABORT);
+    }
+    return result;
+}
+
+// Element-wise a * b + c over three arrays of the same length
+JNIEXPORT jdoubleArray JNICALL Java_com_magayaga_microscript_NativeMath_fmaArray
+  (JNIEnv *env, jclass cls, jdoubleArray a, jdoubleArray b, jdoubleArray c) {
+    if (a == NULL || b == NULL || c == NULL) {
+        return NULL;
+    }
+    
+    jsize length = (*env)->GetArrayLength(env, a);
+    if ((*env)->GetArrayLength(env, b) != length || (*env)->GetArrayLength(env, c) != length) {
+        return NULL;
+    }
+    
+    jdoubleArray result = (*env)->NewDoubleArray(env, length);
+    if (result == NULL || length == 0) {
+        return result;
+    }
+    
+    double *va = (double*)(*env)->GetPrimitiveArrayCritical(env, a, NULL);
+    double *vb = va != NULL ? (double*)(*env)->GetPrimitiveArrayCritical(env, b, NULL) : NULL;
+    double *vc = vb != NULL ? (double*)(*env)->GetPrimitiveArrayCritical(env, c, NULL) : NULL;
+    double *out = vc != NULL ? (double*)(*env)->GetPrimitiveArrayCritical(env, result, NULL) : NULL;
+    if (out != NULL) {
+        ms_simd_fma(va, vb, vc, out, (size_t)length);
+        (*env)->ReleasePrimitiveArrayCritical(env, result, out, 0);
+    }
+    if (vc != NULL) {
+        (*env)->ReleasePrimitiveArrayCritical(env, c, vc, JNI_ABORT);
+    }
+    if (vb != NULL) {
+        (*env)->ReleasePrimitiveArrayCritical(env, b, vb, JNI_ABORT);
+    }
+    if (va != NULL) {
+        (*env)->ReleasePrimitiveArrayCritical(env, a, va, JNI_ABORT);
+    }
+    return result;
+}
@@ -0,0 +1,315 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * Portable SIMD helpers shared by the native math libraries. Each kernel
+ * picks the widest vector unit the compiler was told it may use (AVX,
+ * SSE2 or NEON) and finishes the tail, or the whole array on other
+ * targets, with scalar code.
+ */
+#ifndef MICROSCRIPT_SIMD_H
+#define MICROSCRIPT_SIMD_H
+
+#include <math.h>
+#include <stddef.h>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define MS_SIMD_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MS_SIMD_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define MS_SIMD_NEON 1
+#endif
+
+// Lanes of double per vector, for callers that split work into blocks
+#if defined(MS_SIMD_AVX)
+#define MS_SIMD_WIDTH 4
+#elif defined(MS_SIMD_SSE2) || defined(MS_SIMD_NEON)
+#define MS_SIMD_WIDTH 2
+#else
+#define MS_SIMD_WIDTH 1
+#endif
+
+static inline void ms_simd_sqrt(const double *in, double *out, size_t n) {
+    size_t i = 0;
+#if defined(MS_SIMD_AVX)
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(in + i)));
+    }
+#elif defined(MS_SIMD_SSE2)
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_loadu_pd(in + i)));
+    }
+#elif defined(MS_SIMD_NEON)
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(out + i, vsqrtq_f64(vld1q_f64(in + i)));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = sqrt(in[i]);
+    }
+}
+
+static inline void ms_simd_square(const double *in, double *out, size_t n) {
+    size_t i = 0;
+#if defined(MS_SIMD_AVX)
+    for (; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(in + i);
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(v, v));
+    }
+#elif defined(MS_SIMD_SSE2)
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_loadu_pd(in + i);
+        _mm_storeu_pd(out + i, _mm_mul_pd(v, v));
+    }
+#elif defined(MS_SIMD_NEON)
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t v = vld1q_f64(in + i);
+        vst1q_f64(out + i, vmulq_f64(v, v));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = in[i] * in[i];
+    }
+}
+
+static inline void ms_simd_abs(const double *in, double *out, size_t n) {
+    size_t i = 0;
+#if defined(MS_SIMD_AVX)
+    const __m256d mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(out + i, _mm256_and_pd(_mm256_loadu_pd(in + i), mask));
+    }
+#elif defined(MS_SIMD_SSE2)
+    const __m128d mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(out + i, _mm_and_pd(_mm_loadu_pd(in + i), mask));
+    }
+#elif defined(MS_SIMD_NEON)
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(out + i, vabsq_f64(vld1q_f64(in + i)));
+    }
+#endif
+    for (; i < n; i++) {
+        out[i] = fabs(in[i]);
+    }
+}
+
+// out = a * b + c, fused where the hardware has FMA
+static inline void ms_simd_fma(const double *a, const double *b, const double *c, double *out, size_t n) {
+    size_t i = 0;
+#if defined(MS_SIMD_AVX)
+    for (; i + 4 <= n; i += 4) {
+        __m256d va = _mm256_loadu_pd(a + i);
+        __m256d vb = _mm256_loadu_pd(b + i);
+        __m256d vc = _mm256_loadu_pd(c + i);
+#if defined(__FMA__)
+        _mm256_storeu_pd(out + i, _mm256_fmadd_pd(va, vb, vc));
+#else
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(va, vb), vc));
+#endif
+    }
+#elif defined(MS_SIMD_SSE2)
+    for (; i + 2 <= n; i += 2) {
+        __m128d product = _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+        _mm_storeu_pd(out + i, _mm_add_pd(product, _mm_loadu_pd(c + i)));
+    }
+#elif defined(MS_SIMD_NEON)
+    for (; i + 2 <= n; i += 2) {
+        vst1q_f64(out + i, vfmaq_f64(vld1q_f64(c + i), vld1q_f64(a + i), vld1q_f64(b + i)));
+    }
+#endif
+    for (; i < n; i++) {
+#if defined(__FMA__) || defined(MS_SIMD_NEON)
+        out[i] = fma(a[i], b[i], c[i]);
+#else
+        out[i] = a[i] * b[i] + c[i]; // round like the unfused vector lanes
+#endif
+    }
+}
+
+// Reductions
+//
+// These use several independent vector accumulators so consecutive adds do
+// not wait on each other. Callers keep n modest (a pairwise leaf) and
+// combine the partial results themselves.
+
+static inline double ms_simd_sum(const double *in, size_t n) {
+    size_t i = 0;
+    double total = 0.0;
+#if defined(MS_SIMD_AVX)
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(in + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(in + i + 4));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(MS_SIMD_SSE2)
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(in + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(in + i + 2));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+    total = lanes[0] + lanes[1];
+#elif defined(MS_SIMD_NEON)
+    float64x2_t acc0 = vdupq_n_f64(0.0), acc1 = vdupq_n_f64(0.0);
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vaddq_f64(acc0, vld1q_f64(in + i));
+        acc1 = vaddq_f64(acc1, vld1q_f64(in + i + 2));
+    }
+    total = vaddvq_f64(vaddq_f64(acc0, acc1));
+#endif
+    for (; i < n; i++) {
+        total += in[i];
+    }
+    return total;
+}
+
+static inline double ms_simd_dot(const double *a, const double *b, size_t n) {
+    size_t i = 0;
+    double total = 0.0;
+#if defined(MS_SIMD_AVX)
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+#if defined(__FMA__)
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+#else
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+#endif
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(MS_SIMD_SSE2)
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+    total = lanes[0] + lanes[1];
+#elif defined(MS_SIMD_NEON)
+    float64x2_t acc0 = vdupq_n_f64(0.0), acc1 = vdupq_n_f64(0.0);
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vfmaq_f64(acc0, vld1q_f64(a + i), vld1q_f64(b + i));
+        acc1 = vfmaq_f64(acc1, vld1q_f64(a + i + 2), vld1q_f64(b + i + 2));
+    }
+    total = vaddvq_f64(vaddq_f64(acc0, acc1));
+#endif
+    for (; i < n; i++) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+// Sum of (x - shift)^2, the second pass of a two-pass variance
+static inline double ms_simd_sum_squared_deviation(const double *in, double shift, size_t n) {
+    size_t i = 0;
+    double total = 0.0;
+#if defined(MS_SIMD_AVX)
+    const __m256d center = _mm256_set1_pd(shift);
+    __m256d acc = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        __m256d d = _mm256_sub_pd(_mm256_loadu_pd(in + i), center);
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(d, d));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(MS_SIMD_SSE2)
+    const __m128d center = _mm_set1_pd(shift);
+    __m128d acc = _mm_setzero_pd();
+    for (; i + 2 <= n; i += 2) {
+        __m128d d = _mm_sub_pd(_mm_loadu_pd(in + i), center);
+        acc = _mm_add_pd(acc, _mm_mul_pd(d, d));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    total = lanes[0] + lanes[1];
+#elif defined(MS_SIMD_NEON)
+    const float64x2_t center = vdupq_n_f64(shift);
+    float64x2_t acc = vdupq_n_f64(0.0);
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t d = vsubq_f64(vld1q_f64(in + i), center);
+        acc = vfmaq_f64(acc, d, d);
+    }
+    total = vaddvq_f64(acc);
+#endif
+    for (; i < n; i++) {
+        double d = in[i] - shift;
+        total += d * d;
+    }
+    return total;
+}
+
+// Smallest (want_max == 0) or largest element; NaN if any element is NaN.
+// n must be at least 1.
+static inline double ms_simd_extreme(const double *in, size_t n, int want_max) {
+    size_t i = 0;
+    double best = in[0];
+    int has_nan = 0;
+#if defined(MS_SIMD_AVX)
+    if (n >= 4) {
+        __m256d acc = _mm256_loadu_pd(in);
+        __m256d nan = _mm256_cmp_pd(acc, acc, _CMP_UNORD_Q);
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m256d v = _mm256_loadu_pd(in + i);
+            nan = _mm256_or_pd(nan, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+            acc = want_max ? _mm256_max_pd(acc, v) : _mm256_min_pd(acc, v);
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, acc);
+        has_nan = _mm256_movemask_pd(nan) != 0;
+        best = lanes[0];
+        for (int lane = 1; lane < 4; lane++) {
+            best = want_max ? (lanes[lane] > best ? lanes[lane] : best) : (lanes[lane] < best ? lanes[lane] : best);
+        }
+    }
+#elif defined(MS_SIMD_SSE2)
+    if (n >= 2) {
+        __m128d acc = _mm_loadu_pd(in);
+        __m128d nan = _mm_cmpunord_pd(acc, acc);
+        for (i = 2; i + 2 <= n; i += 2) {
+            __m128d v = _mm_loadu_pd(in + i);
+            nan = _mm_or_pd(nan, _mm_cmpunord_pd(v, v));
+            acc = want_max ? _mm_max_pd(acc, v) : _mm_min_pd(acc, v);
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, acc);
+        has_nan = _mm_movemask_pd(nan) != 0;
+        best = want_max ? (lanes[1] > lanes[0] ? lanes[1] : lanes[0]) : (lanes[1] < lanes[0] ? lanes[1] : lanes[0]);
+    }
+#elif defined(MS_SIMD_NEON)
+    if (n >= 2) {
+        // FMIN/FMAX already propagate NaN
+        float64x2_t acc = vld1q_f64(in);
+        for (i = 2; i + 2 <= n; i += 2) {
+            float64x2_t v = vld1q_f64(in + i);
+            acc = want_max ? vmaxq_f64(acc, v) : vminq_f64(acc, v);
+        }
+        best = want_max ? vmaxvq_f64(acc) : vminvq_f64(acc);
+        has_nan = isnan(best);
+    }
+#endif
+    for (; i < n; i++) {
+        double v = in[i];
+        if (isnan(v)) {
+            has_nan = 1;
+        } else if (want_max ? v > best : v < best) {
+            best = v;
+        }
+    }
+    return has_nan || isnan(best) ? NAN : best;
+}
+
+#endif // MICROSCRIPT_SIMD_H
@@ -0,0 +1,312 @@
+/**
+ * MicroScript — The programming language
+ * Copyright (c) 2025-2026 Cyril John Magayaga
+ *
+ * Reductions and statistics over double[] for NativeMath. Built into the
+ * math library together with microscript_math.c.
+ *
+ * Arrays are split into fixed-size blocks. Each block is summed pairwise
+ * down to short SIMD leaves, and the block results are combined pairwise
+ * again, so the rounding error grows with log(n) instead of n. Block
+ * boundaries do not depend on the thread count, so results are identical
+ * with or without OpenMP. Large arrays spread their blocks over OpenMP
+ * threads when the library is compiled with it.
+ */
+#include <jni.h>
+#include <math.h>
+#include <stdlib.h>
+#include "microscript_jni.h"
+#include "microscript_simd.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define MS_BLOCK_SIZE 4096
+#define MS_PAIRWISE_LEAF 128
+#define MS_PARALLEL_THRESHOLD (1 << 16)
+#define MS_STACK_BLOCKS 64
+
+typedef struct {
+    const double *a;
+    const double *b;
+    double shift;
+} ms_reduce_args;
+
+typedef double (*ms_leaf_fn)(const ms_reduce_args *args, size_t start, size_t n);
+
+static double ms_leaf_sum(const ms_reduce_args *args, size_t start, size_t n) {
+    return ms_simd_sum(args->a + start, n);
+}
+
+static double ms_leaf_dot(const ms_reduce_args *args, size_t start, size_t n) {
+    return ms_simd_dot(args->a + start, args->b + start, n);
+}
+
+static double ms_leaf_squared_deviation(const ms_reduce_args *args, size_t start, size_t n) {
+    return ms_simd_sum_squared_deviation(args->a + start, args->shift, n);
+}
+
+static double ms_pairwise(const ms_reduce_args *args, ms_leaf_fn leaf, size_t start, size_t n) {
+    if (n <= MS_PAIRWISE_LEAF) {
+        return leaf(args, start, n);
+    }
+    // Split on a multiple of 8 so both halves keep whole vectors
+    size_t half = (n / 2) & ~(size_t)7;
+    return ms_pairwise(args, leaf, start, half) + ms_pairwise(args, leaf, start + half, n - half);
+}
+
+static double ms_pairwise_values(const double *values, size_t n) {
+    if (n <= 8) {
+        double total = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            total += values[i];
+        }
+        return total;
+    }
+    size_t half = n / 2;
+    return ms_pairwise_values(values, half) + ms_pairwise_values(values + half, n - half);
+}
+
+static double ms_reduce(const ms_reduce_args *args, ms_leaf_fn leaf, size_t n) {
+    size_t blocks = (n + MS_BLOCK_SIZE - 1) / MS_BLOCK_SIZE;
+    if (blocks <= 1) {
+        return ms_pairwise(args, leaf, 0, n);
+    }
+
+    double stack[MS_STACK_BLOCKS];
+    double *partials = blocks <= MS_STACK_BLOCKS ? stack : (double*)malloc(blocks * sizeof(double));
+    if (partials == NULL) {
+        return ms_pairwise(args, leaf, 0, n);
+    }
+
+    long count = (long)blocks;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static) if (n >= MS_PARALLEL_THRESHOLD)
+#endif
+    for (long block = 0; block < count; block++) {
+        size_t start = (size_t)block * MS_BLOCK_SIZE;
+        size_t length = n - start < MS_BLOCK_SIZE ? n - start : MS_BLOCK_SIZE;
+        partials[block] = ms_pairwise(args, leaf, start, length);
+    }
+
+    double total = ms_pairwise_values(partials, blocks);
+    if (partials != stack) {
+        free(partials);
+    }
+    return total;
+}
+
+static double ms_extreme(const double *in, size_t n, int want_max) {
+    if (n == 0) {
+        return NAN;
+    }
+
+    size_t blocks = (n + MS_BLOCK_SIZE - 1) / MS_BLOCK_SIZE;
+    if (blocks <= 1 || n < MS_PARALLEL_THRESHOLD) {
+        return ms_simd_extreme(in, n, want_max);
+    }
+
+    double *partials = (double*)malloc(blocks * sizeof(double));
+    if (partials == NULL) {
+        return ms_simd_extreme(in, n, want_max);
+    }
+
+    long count = (long)blocks;
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (long block = 0; block < count; block++) {
+        size_t start = (size_t)block * MS_BLOCK_SIZE;
+        size_t length = n - start < MS_BLOCK_SIZE ? n - start : MS_BLOCK_SIZE;
+        partials[block] = ms_simd_extreme(in + start, length, want_max);
+    }
+
+    double best = ms_simd_extreme(partials, blocks, want_max);
+    free(partials);
+    return best;
+}
+
+static double ms_sum(const double *in, size_t n) {
+    ms_reduce_args args = { in, NULL, 0.0 };
+    return ms_reduce(&args, ms_leaf_sum, n);
+}
+
+// Sum
+JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_sumArray
+  (JNIEnv *env, jclass cls, jdoubleArray values) {
+    if (!ms_require(env, values, "values")) {
+        return NAN;
+    }
+    jsize length = (*env)->GetArrayLength(env, values);
+    double *in = (double*)(*env)->GetPrimitiveArrayCritical(env, values, NULL);
+    if (in == NULL) {
+        return NAN;
+    }
+
+    double result = ms_sum(in, (size_t)length);
+    (*env)->ReleasePrimitiveArrayCritical(env, values, in, JNI_ABORT);
+    return result;
+}
+
+// Arithmetic mean; NaN for an empty array
+JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_meanArray
+  (JNIEnv *env, jclass cls, jdoubleArray values) {
+    if (!ms_require(env, values, "values")) {
+        return NAN;
+    }
+    jsize length = (*env)->GetArrayLength(env, values);
+    if (length == 0) {
+        return NAN;
+    }
+    double *in = (double*)(*env)->GetPrimitiveArrayCritical(env, values, NULL);
+    if (in == NULL) {
+        return NAN;
+    }
+
+    double result = ms_sum(in, (size_t)length) / (double)length;
+    (*env)->ReleasePrimitiveArrayCritical(env, values, in, JNI_ABORT);
+    return result;
+}
+
+// Variance in two passes: the population variance, or the sample variance
+// (n - 1 denominator) when sample is true
+JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_varianceArray
+  (JNIEnv *env, jclass cls, jdoubleArray values, jboolean sample) {
+    if (!ms_require(env, values, "values")) {
+        return NAN;
+    }
+    jsize length = (*env)->GetArrayLength(env, values);
+    jsize denominator = sample ? length - 1 : length;
+    if (length == 0 || denominator <= 0) {
+        return NAN;
+    }
+    double *in = (double*)(*env)->GetPrimitiveArrayCritical(env, values, NULL);
+    if (in == NULL) {
+        return NAN;
+    }
+
+    size_t n = (size_t)length;
+    ms_reduce_args args = { in, NULL, ms_sum(in, n) / (double)n };
+    double result = ms_reduce(&args, ms_leaf_squared_deviation, n) / (double)denominator;
+    (*env)->ReleasePrimitiveArrayCritical(env, values, in, JNI_ABORT);
+    return result;
+}
+
+static jdouble ms_extreme_array(JNIEnv *env, jdoubleArray values, int want_max) {
+    if (!ms_require(env, values, "values")) {
+        return NAN;
+    }
+    jsize length = (*env)->GetArrayLength(env, values);
+    double *in = (double*)(*env)->GetPrimitiveArrayCritical(env, values, NULL);
+    if (in == NULL) {
+        return NAN;
+    }
+
+    double result = ms_extreme(in, (size_t)length, want_max);
+    (*env)->ReleasePrimitiveArrayCritical(env, values, in, JNI_ABORT);
+    return result;
+}
+
+// Minimum and maximum; NaN for an empty array or one containing NaN
+JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_minArray
+  (JNIEnv *env, jclass cls, jdoubleArray values) {
+    return ms_extreme_array(env, values, 0);
+}
+
+JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_maxArray
+  (JNIEnv *env, jclass cls, jdoubleArray values) {
+    return ms_extreme_array(env, values, 1);
+}
+
+// Dot product of two arrays of the same length; NaN if the lengths differ
+JNIEXPORT jdouble JNICALL Java_com_magayaga_microscript_NativeMath_dotArray
+  (JNIEnv *env, jclass cls, jdoubleArray a, jdoubleArray b) {
+    if (!ms_require(env, a, "a") || !ms_require(env, b, "b")) {
+        return NAN;
+    }
+    jsize length = (*env)->GetArrayLength(env, a);
+    if ((*env)->GetArrayLength(env, b) != length) {
+        return NAN;
+    }
+
+    double result = NAN;
+    double *va = (double*)(*env)->GetPrimitiveArrayCritical(env, a, NULL);
+    double *vb = va != NULL ? (double*)(*env)->GetPrimitiveArrayCritical(env, b, NULL) : NULL;
+    if (vb != NULL) {
+        ms_reduce_args args = { va, vb, 0.0 };
+        result = ms_reduce(&args, ms_leaf_dot, (size_t)length);
+        (*env)->ReleasePrimitiveArrayCritical(env, b, vb, JNI_ABORT);
+    }
+    if (va != NULL) {
+        (*env)->ReleasePrimitiveArrayCritical(env, a, va, JNI_ABORT);
+    }
+    return result;
+}
+
+// Inclusive prefix sum. Large arrays scan in two parallel passes: block
+// totals first, then each block again starting from the total before it.
+JNIEXPORT jdoubleArray JNICALL Java_com_magayaga_microscript_NativeMath_prefixSumArray
+  (JNIEnv *env, jclass cls, jdoubleArray values) {
+    if (!ms_require(env, values, "values")) {
+        return NULL;
+    }
+    jsize length = (*env)->GetArrayLength(env, values);
+    jdoubleArray result = (*env)->NewDoubleArray(env, length);
+    if (result == NULL || length == 0) {
+        return result;
+    }
+
+    size_t n = (size_t)length;
+    size_t blocks = (n + MS_BLOCK_SIZE - 1) / MS_BLOCK_SIZE;
+    double *offsets = n >= MS_PARALLEL_THRESHOLD ? (double*)malloc(blocks * sizeof(double)) : NULL;
+
+    double *in = (double*)(*env)->GetPrimitiveArrayCritical(env, values, NULL);
+    double *out = in != NULL ? (double*)(*env)->GetPrimitiveArrayCritical(env, result, NULL) : NULL;
+    if (out != NULL && offsets != NULL) {
+        long count = (long)blocks;
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (long block = 0; block < count; block++) {
+            size_t start = (size_t)block * MS_BLOCK_SIZE;
+            size_t end = start + MS_BLOCK_SIZE < n ? start + MS_BLOCK_SIZE : n;
+            offsets[block] = ms_pairwise_values(in + start, end - start);
+        }
+
+        double running = 0.0;
+        for (size_t block = 0; block < blocks; block++) {
+            double total = offsets[block];
+            offsets[block] = running;
+            running += total;
+        }
+
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (long block = 0; block < count; block++) {
+            size_t start = (size_t)block * MS_BLOCK_SIZE;
+            size_t end = start + MS_BLOCK_SIZE < n ? start + MS_BLOCK_SIZE : n;
+            double acc = offsets[block];
+            for (size_t i = start; i < end; i++) {
+                acc += in[i];
+                out[i] = acc;
+            }
+        }
+    } else if (out != NULL) {
+        double acc = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            acc += in[i];
+            out[i] = acc;
+        }
+    }
+
+    if (out != NULL) {
+        (*env)->ReleasePrimitiveArrayCritical(env, result, out, 0);
+    }
+    if (in != NULL) {
+        (*env)->ReleasePrimitiveArrayCritical(env, values, in, JNI_ABORT);
+    }
+    free(offsets);
+    return result;
+}